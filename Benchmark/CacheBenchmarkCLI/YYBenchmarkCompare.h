@@ -0,0 +1,85 @@
+//
+//  YYBenchmarkCompare.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The change of one metric of one measurement, from the baseline to the current run.
+ */
+@interface YYBenchmarkChange : NSObject
+@property (nonatomic, copy) NSString *identifier;   ///< the record's identifier, "suite/scenario/dataset/engine"
+@property (nonatomic, copy) NSString *metric;       ///< "time_ms", "ops_per_sec"...
+@property (nonatomic) BOOL higherIsBetter;
+@property (nonatomic) NSUInteger baselineCount;     ///< samples (repeated runs) of the baseline
+@property (nonatomic) NSUInteger currentCount;      ///< samples of the current run
+@property (nonatomic) double baselineMean;
+@property (nonatomic) double currentMean;
+@property (nonatomic) double change;                ///< (current - baseline) / baseline
+@property (nonatomic) double changeLow;             ///< the confidence interval of `change`
+@property (nonatomic) double changeHigh;
+@property (nonatomic) double pValue;                ///< Welch's t-test, 1 if there are not enough samples
+@property (nonatomic) BOOL significant;             ///< pValue < alpha
+@property (nonatomic) BOOL regression;              ///< significant, and worse by more than the threshold
+@property (nonatomic) BOOL improvement;             ///< significant, and better by more than the threshold
+
+- (NSDictionary *)dictionaryValue;
+@end
+
+
+/**
+ Compares the records of a run with a baseline (the JSON of an earlier run on the
+ same machine class), to find the regressions.
+
+ @discussion The records with the same identifier are the samples of a measurement,
+ so run both with `--repeat N` (N >= 3). For each measurement and metric, it tests
+ the difference of the means with Welch's t-test, and computes the confidence
+ interval of the relative change. A change is a regression if it's significant
+ (p < `alpha`) and worse than the baseline by more than `threshold`.
+ A measurement with fewer than 2 samples on either side is reported, but it's never
+ significant.
+ */
+@interface YYBenchmarkComparison : NSObject
+
+/** The relative change to fail at, default is 0.05 (5%). */
+@property (nonatomic) double threshold;
+
+/** The significance level, default is 0.05 (95% confidence). */
+@property (nonatomic) double alpha;
+
+/**
+ The metrics to compare, "time_ms" or the names in the records' metrics. Default is
+ nil, which compares "ops_per_sec" if a record has it, otherwise "time_ms".
+ */
+@property (nullable, nonatomic, copy) NSArray<NSString *> *metrics;
+
+/** The identifiers in the baseline but not in the current run, after `compare`. */
+@property (nonatomic, readonly) NSArray<NSString *> *missingIdentifiers;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+
+/**
+ @param baseline The JSON object of the baseline, in the format of `YYBenchmarkReport`.
+ @param current  The JSON object of the current run.
+ */
+- (instancetype)initWithBaseline:(NSDictionary *)baseline current:(NSDictionary *)current NS_DESIGNATED_INITIALIZER;
+
+/** Reads a JSON written by `YYBenchmarkReport`, returns nil if it's not one. */
++ (nullable NSDictionary *)reportObjectAtPath:(NSString *)path error:(NSError **)error;
+
+/** Whether a larger value of the metric is better, such as "ops_per_sec" and "hit_ratio". */
++ (BOOL)isHigherBetterMetric:(NSString *)metric;
+
+/** Compares the measurements in both, ordered as the baseline. */
+- (NSArray<YYBenchmarkChange *> *)compare;
+
+@end
+
+NS_ASSUME_NONNULL_END
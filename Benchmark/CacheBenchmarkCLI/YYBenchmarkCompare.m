@@ -0,0 +1,244 @@
+//
+//  YYBenchmarkCompare.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYBenchmarkCompare.h"
+#import <math.h>
+
+/// The continued fraction of the incomplete beta function (Numerical Recipes, betacf).
+static double _YYBetaContinuedFraction(double a, double b, double x) {
+    const double eps = 3e-14, tiny = 1e-300;
+    double qab = a + b, qap = a + 1, qam = a - 1;
+    double c = 1, d = 1 - qab * x / qap;
+    if (fabs(d) < tiny) d = tiny;
+    d = 1 / d;
+    double h = d;
+    for (int m = 1; m <= 300; m++) {
+        int m2 = 2 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1 + aa * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1 + aa / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1 / d;
+        h *= d * c;
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1 + aa * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1 + aa / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1 / d;
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1) < eps) break;
+    }
+    return h;
+}
+
+/// The regularized incomplete beta function I_x(a, b).
+static double _YYIncompleteBeta(double a, double b, double x) {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x));
+    if (x < (a + 1) / (a + b + 2)) return front * _YYBetaContinuedFraction(a, b, x) / a;
+    return 1 - front * _YYBetaContinuedFraction(b, a, 1 - x) / b;
+}
+
+/// Two-tailed p-value of Student's t distribution.
+static double _YYStudentTPValue(double t, double df) {
+    return _YYIncompleteBeta(df / 2, 0.5, df / (df + t * t));
+}
+
+/// The t with a two-tailed p-value of alpha, by bisection.
+static double _YYStudentTCritical(double alpha, double df) {
+    double low = 0, high = 1e4;
+    for (int i = 0; i < 100; i++) {
+        double mid = (low + high) / 2;
+        if (_YYStudentTPValue(mid, df) > alpha) low = mid;
+        else high = mid;
+    }
+    return high;
+}
+
+/// Mean and sample variance.
+static void _YYSampleStatistics(NSArray<NSNumber *> *samples, double *mean, double *variance) {
+    double sum = 0;
+    for (NSNumber *sample in samples) sum += sample.doubleValue;
+    double m = samples.count ? sum / samples.count : 0;
+    double squares = 0;
+    for (NSNumber *sample in samples) squares += (sample.doubleValue - m) * (sample.doubleValue - m);
+    *mean = m;
+    *variance = samples.count > 1 ? squares / (samples.count - 1) : 0;
+}
+
+/// The value of a metric in a record object, nil if it does not have it.
+static NSNumber *_YYRecordMetric(NSDictionary *record, NSString *metric) {
+    if ([metric isEqualToString:@"time_ms"]) return record[@"time_ms"];
+    id value = [record[@"metrics"] isKindOfClass:[NSDictionary class]] ? record[@"metrics"][metric] : nil;
+    return [value isKindOfClass:[NSNumber class]] ? value : nil;
+}
+
+static NSString *_YYRecordIdentifier(NSDictionary *record) {
+    return [NSString stringWithFormat:@"%@/%@/%@/%@", record[@"suite"], record[@"scenario"], record[@"dataset"], record[@"engine"]];
+}
+
+
+@implementation YYBenchmarkChange
+
+- (NSDictionary *)dictionaryValue {
+    return @{@"identifier" : _identifier ?: @"",
+             @"metric" : _metric ?: @"",
+             @"baseline_count" : @(_baselineCount),
+             @"current_count" : @(_currentCount),
+             @"baseline_mean" : @(_baselineMean),
+             @"current_mean" : @(_currentMean),
+             @"change" : @(_change),
+             @"change_low" : @(_changeLow),
+             @"change_high" : @(_changeHigh),
+             @"p_value" : @(_pValue),
+             @"significant" : @(_significant),
+             @"regression" : @(_regression),
+             @"improvement" : @(_improvement)};
+}
+
+@end
+
+
+@implementation YYBenchmarkComparison {
+    NSDictionary *_baseline;
+    NSDictionary *_current;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYBenchmarkComparison init error" reason:@"Use 'initWithBaseline:current:' instead." userInfo:nil];
+    return [self initWithBaseline:@{} current:@{}];
+}
+
+- (instancetype)initWithBaseline:(NSDictionary *)baseline current:(NSDictionary *)current {
+    self = [super init];
+    _baseline = baseline;
+    _current = current;
+    _threshold = 0.05;
+    _alpha = 0.05;
+    _missingIdentifiers = @[];
+    return self;
+}
+
++ (NSDictionary *)reportObjectAtPath:(NSString *)path error:(NSError **)error {
+    NSData *data = [NSData dataWithContentsOfFile:path options:0 error:error];
+    if (!data) return nil;
+    id object = [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+    if (![object isKindOfClass:[NSDictionary class]] || ![object[@"records"] isKindOfClass:[NSArray class]]) {
+        if (error && object) *error = [NSError errorWithDomain:@"YYBenchmark" code:-1 userInfo:@{NSLocalizedDescriptionKey : @"not a benchmark report"}];
+        return nil;
+    }
+    return object;
+}
+
++ (BOOL)isHigherBetterMetric:(NSString *)metric {
+    return [metric hasSuffix:@"per_sec"] || [metric hasSuffix:@"hit_ratio"];
+}
+
+#pragma mark - private
+
+/// identifier -> records, and the identifiers in order.
++ (NSDictionary<NSString *, NSMutableArray *> *)_groupRecords:(NSArray *)records order:(NSMutableArray *)order {
+    NSMutableDictionary *groups = [NSMutableDictionary new];
+    for (NSDictionary *record in records) {
+        if (![record isKindOfClass:[NSDictionary class]]) continue;
+        NSString *identifier = _YYRecordIdentifier(record);
+        NSMutableArray *group = groups[identifier];
+        if (!group) {
+            group = [NSMutableArray new];
+            groups[identifier] = group;
+            [order addObject:identifier];
+        }
+        [group addObject:record];
+    }
+    return groups;
+}
+
+- (YYBenchmarkChange *)_changeOfMetric:(NSString *)metric identifier:(NSString *)identifier baseline:(NSArray *)baselineRecords current:(NSArray *)currentRecords {
+    NSMutableArray *baselineSamples = [NSMutableArray new], *currentSamples = [NSMutableArray new];
+    for (NSDictionary *record in baselineRecords) {
+        NSNumber *value = _YYRecordMetric(record, metric);
+        if (value) [baselineSamples addObject:value];
+    }
+    for (NSDictionary *record in currentRecords) {
+        NSNumber *value = _YYRecordMetric(record, metric);
+        if (value) [currentSamples addObject:value];
+    }
+    if (baselineSamples.count == 0 || currentSamples.count == 0) return nil;
+
+    YYBenchmarkChange *change = [YYBenchmarkChange new];
+    change.identifier = identifier;
+    change.metric = metric;
+    change.higherIsBetter = [self.class isHigherBetterMetric:metric];
+    change.baselineCount = baselineSamples.count;
+    change.currentCount = currentSamples.count;
+    double m1, v1, m2, v2;
+    _YYSampleStatistics(baselineSamples, &m1, &v1);
+    _YYSampleStatistics(currentSamples, &m2, &v2);
+    change.baselineMean = m1;
+    change.currentMean = m2;
+    change.pValue = 1;
+    if (m1 == 0) return change; // no relative change
+
+    double diff = m2 - m1;
+    change.change = change.changeLow = change.changeHigh = diff / fabs(m1);
+    if (baselineSamples.count < 2 || currentSamples.count < 2) return change;
+
+    // Welch's t-test, the variances may differ between the runs
+    double n1 = baselineSamples.count, n2 = currentSamples.count;
+    double e1 = v1 / n1, e2 = v2 / n2;
+    double se = sqrt(e1 + e2);
+    if (se == 0) {
+        change.pValue = diff == 0 ? 1 : 0; // deterministic, such as a hit ratio
+    } else {
+        double df = (e1 + e2) * (e1 + e2) / (e1 * e1 / (n1 - 1) + e2 * e2 / (n2 - 1));
+        change.pValue = _YYStudentTPValue(diff / se, df);
+        double margin = _YYStudentTCritical(_alpha, df) * se;
+        change.changeLow = (diff - margin) / fabs(m1);
+        change.changeHigh = (diff + margin) / fabs(m1);
+    }
+    change.significant = change.pValue < _alpha;
+    double worse = change.higherIsBetter ? -change.change : change.change;
+    change.regression = change.significant && worse > _threshold;
+    change.improvement = change.significant && -worse > _threshold;
+    return change;
+}
+
+#pragma mark - public
+
+- (NSArray<YYBenchmarkChange *> *)compare {
+    NSMutableArray *order = [NSMutableArray new];
+    NSDictionary *baselineGroups = [self.class _groupRecords:_baseline[@"records"] order:order];
+    NSDictionary *currentGroups = [self.class _groupRecords:_current[@"records"] order:[NSMutableArray new]];
+
+    NSMutableArray *changes = [NSMutableArray new];
+    NSMutableArray *missing = [NSMutableArray new];
+    for (NSString *identifier in order) {
+        NSArray *baselineRecords = baselineGroups[identifier];
+        NSArray *currentRecords = currentGroups[identifier];
+        if (!currentRecords) {
+            [missing addObject:identifier];
+            continue;
+        }
+        NSArray *metrics = _metrics;
+        if (!metrics) {
+            metrics = _YYRecordMetric(baselineRecords.firstObject, @"ops_per_sec") ? @[@"ops_per_sec"] : @[@"time_ms"];
+        }
+        for (NSString *metric in metrics) {
+            YYBenchmarkChange *change = [self _changeOfMetric:metric identifier:identifier baseline:baselineRecords current:currentRecords];
+            if (change) [changes addObject:change];
+        }
+    }
+    _missingIdentifiers = missing;
+    return changes;
+}
+
+@end
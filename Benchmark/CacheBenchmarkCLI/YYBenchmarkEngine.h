@@ -0,0 +1,59 @@
+//
+//  YYBenchmarkEngine.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A cache under benchmark, so all scenarios drive the caches in the same way.
+
+ @discussion The engines are the ones of `Benchmark.m` which build without UIKit.
+ PINCache and the spin lock dictionary are Apple only, `NSDict+Lock` uses a
+ pthread mutex instead.
+ */
+@interface YYBenchmarkEngine : NSObject
+
+/** The name printed in report, such as "YYMemoryCache". */
+@property (nonatomic, readonly) NSString *name;
+
+/** The cache object, such as the `YYMemoryCache` instance. */
+@property (nonatomic, readonly) id cache;
+
+/** Whether the engine can be used from multiple threads. */
+@property (nonatomic, readonly, getter=isThreadSafe) BOOL threadSafe;
+
+- (void)setObject:(id)object forKey:(id)key;
+- (nullable id)objectForKey:(id)key;
+- (void)removeObjectForKey:(id)key;
+- (void)removeAllObjects;
+
+/** NSDictionary, NSDict+Lock, YYMemoryCache, NSCache, new instances. */
++ (NSArray<YYBenchmarkEngine *> *)memoryEngines;
+
+/**
+ YYKVFile, YYKVSQLite, YYDiskCache, opened in the sub directories of the path.
+
+ @param path    The base directory, the engines reuse the data written at the same path.
+ @param archive YES to archive the values with NSKeyedArchiver (keys should be strings),
+                NO to store NSData as is.
+ */
++ (NSArray<YYBenchmarkEngine *> *)diskEnginesWithPath:(NSString *)path archive:(BOOL)archive;
+
+/** The names of all engines. */
++ (NSArray<NSString *> *)engineNames;
+
+/**
+ A new engine with the name, such as "YYMemoryCache", or nil if no such engine.
+ The disk engines are opened in the sub directory of the path, see `diskEnginesWithPath:archive:`.
+ */
++ (nullable YYBenchmarkEngine *)engineWithName:(NSString *)name path:(NSString *)path archive:(BOOL)archive;
+
+@end
+
+NS_ASSUME_NONNULL_END
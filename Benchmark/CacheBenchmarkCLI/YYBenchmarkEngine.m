@@ -0,0 +1,231 @@
+//
+//  YYBenchmarkEngine.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYBenchmarkEngine.h"
+#import "YYMemoryCache.h"
+#import "YYDiskCache.h"
+#import "YYKVStorage.h"
+#import <pthread.h>
+
+@interface YYBenchmarkEngine ()
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, strong) id cache;
+@property (nonatomic, getter=isThreadSafe) BOOL threadSafe;
+@end
+
+@interface _YYBenchmarkDictionaryEngine : YYBenchmarkEngine
+@end
+
+@implementation _YYBenchmarkDictionaryEngine {
+    NSMutableDictionary *_dic;
+}
+- (instancetype)init {
+    self = [super init];
+    _dic = [NSMutableDictionary new];
+    self.name = @"NSDictionary";
+    self.cache = _dic;
+    return self;
+}
+- (void)setObject:(id)object forKey:(id)key { [_dic setObject:object forKey:key]; }
+- (id)objectForKey:(id)key { return [_dic objectForKey:key]; }
+- (void)removeObjectForKey:(id)key { [_dic removeObjectForKey:key]; }
+- (void)removeAllObjects { [_dic removeAllObjects]; }
+@end
+
+
+@interface _YYBenchmarkLockedDictionaryEngine : YYBenchmarkEngine
+@end
+
+@implementation _YYBenchmarkLockedDictionaryEngine {
+    NSMutableDictionary *_dic;
+    pthread_mutex_t _lock;
+}
+- (instancetype)init {
+    self = [super init];
+    _dic = [NSMutableDictionary new];
+    pthread_mutex_init(&_lock, NULL);
+    self.name = @"NSDict+Lock";
+    self.threadSafe = YES;
+    self.cache = _dic;
+    return self;
+}
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+- (void)setObject:(id)object forKey:(id)key {
+    pthread_mutex_lock(&_lock);
+    [_dic setObject:object forKey:key];
+    pthread_mutex_unlock(&_lock);
+}
+- (id)objectForKey:(id)key {
+    pthread_mutex_lock(&_lock);
+    id object = [_dic objectForKey:key];
+    pthread_mutex_unlock(&_lock);
+    return object;
+}
+- (void)removeObjectForKey:(id)key {
+    pthread_mutex_lock(&_lock);
+    [_dic removeObjectForKey:key];
+    pthread_mutex_unlock(&_lock);
+}
+- (void)removeAllObjects {
+    pthread_mutex_lock(&_lock);
+    [_dic removeAllObjects];
+    pthread_mutex_unlock(&_lock);
+}
+@end
+
+
+@interface _YYBenchmarkNSCacheEngine : YYBenchmarkEngine
+@end
+
+@implementation _YYBenchmarkNSCacheEngine {
+    NSCache *_ns;
+}
+- (instancetype)init {
+    self = [super init];
+    _ns = [NSCache new];
+    self.name = @"NSCache";
+    self.threadSafe = YES;
+    self.cache = _ns;
+    return self;
+}
+- (void)setObject:(id)object forKey:(id)key { [_ns setObject:object forKey:key]; }
+- (id)objectForKey:(id)key { return [_ns objectForKey:key]; }
+- (void)removeObjectForKey:(id)key { [_ns removeObjectForKey:key]; }
+- (void)removeAllObjects { [_ns removeAllObjects]; }
+@end
+
+
+@interface _YYBenchmarkMemoryCacheEngine : YYBenchmarkEngine
+@end
+
+@implementation _YYBenchmarkMemoryCacheEngine {
+    YYMemoryCache *_yy;
+}
+- (instancetype)init {
+    self = [super init];
+    _yy = [YYMemoryCache new];
+    self.name = @"YYMemoryCache";
+    self.threadSafe = YES;
+    self.cache = _yy;
+    return self;
+}
+- (void)setObject:(id)object forKey:(id)key { [_yy setObject:object forKey:key]; }
+- (id)objectForKey:(id)key { return [_yy objectForKey:key]; }
+- (void)removeObjectForKey:(id)key { [_yy removeObjectForKey:key]; }
+- (void)removeAllObjects { [_yy removeAllObjects]; }
+@end
+
+
+@interface _YYBenchmarkKVStorageEngine : YYBenchmarkEngine
+@end
+
+@implementation _YYBenchmarkKVStorageEngine {
+    YYKVStorage *_kv;
+    BOOL _archive;
+    BOOL _useFile;
+}
+- (instancetype)initWithPath:(NSString *)path type:(YYKVStorageType)type archive:(BOOL)archive {
+    self = [super init];
+    _kv = [[YYKVStorage alloc] initWithPath:path type:type];
+    if (!_kv) return nil;
+    _archive = archive;
+    _useFile = type == YYKVStorageTypeFile;
+    self.name = _useFile ? @"YYKVFile" : @"YYKVSQLite";
+    self.cache = _kv;
+    return self;
+}
+- (void)setObject:(id)object forKey:(id)key {
+    NSData *value = _archive ? [NSKeyedArchiver archivedDataWithRootObject:object] : object;
+    [_kv saveItemWithKey:key value:value filename:(_useFile ? key : nil) extendedData:nil];
+}
+- (id)objectForKey:(id)key {
+    NSData *value = [_kv getItemValueForKey:key];
+    if (!value) return nil;
+    return _archive ? [NSKeyedUnarchiver unarchiveObjectWithData:value] : value;
+}
+- (void)removeObjectForKey:(id)key { [_kv removeItemForKey:key]; }
+- (void)removeAllObjects { [_kv removeAllItems]; }
+@end
+
+
+@interface _YYBenchmarkDiskCacheEngine : YYBenchmarkEngine
+@end
+
+@implementation _YYBenchmarkDiskCacheEngine {
+    YYDiskCache *_yy;
+}
+- (instancetype)initWithPath:(NSString *)path archive:(BOOL)archive {
+    self = [super init];
+    _yy = [[YYDiskCache alloc] initWithPath:path];
+    if (!_yy) return nil;
+    if (!archive) {
+        _yy.customArchiveBlock = ^(id object) {return (NSData *)object;};
+        _yy.customUnarchiveBlock = ^(NSData *data) {return (id)data;};
+    }
+    self.name = @"YYDiskCache";
+    self.threadSafe = YES;
+    self.cache = _yy;
+    return self;
+}
+- (void)setObject:(id)object forKey:(id)key { [_yy setObject:object forKey:key]; }
+- (id)objectForKey:(id)key { return [_yy objectForKey:key]; }
+- (void)removeObjectForKey:(id)key { [_yy removeObjectForKey:key]; }
+- (void)removeAllObjects { [_yy removeAllObjects]; }
+@end
+
+
+@implementation YYBenchmarkEngine
+
+- (void)setObject:(id)object forKey:(id)key {}
+- (id)objectForKey:(id)key { return nil; }
+- (void)removeObjectForKey:(id)key {}
+- (void)removeAllObjects {}
+
++ (NSArray *)memoryEngines {
+    return @[[_YYBenchmarkDictionaryEngine new],
+             [_YYBenchmarkLockedDictionaryEngine new],
+             [_YYBenchmarkMemoryCacheEngine new],
+             [_YYBenchmarkNSCacheEngine new]];
+}
+
++ (NSArray *)diskEnginesWithPath:(NSString *)path archive:(BOOL)archive {
+    NSMutableArray *engines = [NSMutableArray new];
+    YYBenchmarkEngine *engine;
+    engine = [[_YYBenchmarkKVStorageEngine alloc] initWithPath:[path stringByAppendingPathComponent:@"yykvFile"] type:YYKVStorageTypeFile archive:archive];
+    if (engine) [engines addObject:engine];
+    engine = [[_YYBenchmarkKVStorageEngine alloc] initWithPath:[path stringByAppendingPathComponent:@"yykvSQLite"] type:YYKVStorageTypeSQLite archive:archive];
+    if (engine) [engines addObject:engine];
+    engine = [[_YYBenchmarkDiskCacheEngine alloc] initWithPath:[path stringByAppendingPathComponent:@"yy"] archive:archive];
+    if (engine) [engines addObject:engine];
+    return engines;
+}
+
++ (NSArray *)engineNames {
+    return @[@"NSDictionary", @"NSDict+Lock", @"YYMemoryCache", @"NSCache", @"YYKVFile", @"YYKVSQLite", @"YYDiskCache"];
+}
+
++ (YYBenchmarkEngine *)engineWithName:(NSString *)name path:(NSString *)path archive:(BOOL)archive {
+    if ([name isEqualToString:@"NSDictionary"]) return [_YYBenchmarkDictionaryEngine new];
+    if ([name isEqualToString:@"NSDict+Lock"]) return [_YYBenchmarkLockedDictionaryEngine new];
+    if ([name isEqualToString:@"NSCache"]) return [_YYBenchmarkNSCacheEngine new];
+    if ([name isEqualToString:@"YYMemoryCache"]) return [_YYBenchmarkMemoryCacheEngine new];
+    if ([name isEqualToString:@"YYKVFile"]) {
+        return [[_YYBenchmarkKVStorageEngine alloc] initWithPath:[path stringByAppendingPathComponent:@"yykvFile"] type:YYKVStorageTypeFile archive:archive];
+    }
+    if ([name isEqualToString:@"YYKVSQLite"]) {
+        return [[_YYBenchmarkKVStorageEngine alloc] initWithPath:[path stringByAppendingPathComponent:@"yykvSQLite"] type:YYKVStorageTypeSQLite archive:archive];
+    }
+    if ([name isEqualToString:@"YYDiskCache"]) {
+        return [[_YYBenchmarkDiskCacheEngine alloc] initWithPath:[path stringByAppendingPathComponent:@"yy"] archive:archive];
+    }
+    return nil;
+}
+
+@end
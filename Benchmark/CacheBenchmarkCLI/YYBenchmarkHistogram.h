@@ -0,0 +1,39 @@
+//
+//  YYBenchmarkHistogram.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A log-linear histogram of integer values (such as nanoseconds), with 64 sub
+ buckets for each power of 2, so the relative error of a percentile is less
+ than 1/64. The memory is fixed, it can record any number of values.
+
+ @discussion It's not thread safe, use one histogram for each thread and merge them.
+ */
+@interface YYBenchmarkHistogram : NSObject
+
+@property (nonatomic, readonly) uint64_t count;
+@property (nonatomic, readonly) uint64_t min;
+@property (nonatomic, readonly) uint64_t max;
+@property (nonatomic, readonly) double mean;
+
+- (void)recordValue:(uint64_t)value;
+
+/** Adds the values of another histogram to the receiver. */
+- (void)addHistogram:(YYBenchmarkHistogram *)histogram;
+
+/** The value at the percentile (0-100), such as 99.9; 0 if empty. */
+- (uint64_t)valueAtPercentile:(double)percentile;
+
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,94 @@
+//
+//  YYBenchmarkHistogram.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYBenchmarkHistogram.h"
+
+#define kSubBucketBits 6
+#define kSubBucketCount (1 << kSubBucketBits) ///< 64
+#define kBucketCount (kSubBucketCount + (64 - kSubBucketBits) * kSubBucketCount)
+
+static inline int _YYHistogramIndex(uint64_t value) {
+    if (value < kSubBucketCount) return (int)value;
+    int k = 63 - __builtin_clzll(value); // >= kSubBucketBits
+    int sub = (int)(value >> (k - kSubBucketBits)) - kSubBucketCount;
+    return kSubBucketCount + (k - kSubBucketBits) * kSubBucketCount + sub;
+}
+
+/// The middle value of the bucket.
+static inline uint64_t _YYHistogramValue(int index) {
+    if (index < kSubBucketCount) return index;
+    int k = (index - kSubBucketCount) / kSubBucketCount + kSubBucketBits;
+    int sub = (index - kSubBucketCount) % kSubBucketCount;
+    uint64_t lower = (uint64_t)(kSubBucketCount + sub) << (k - kSubBucketBits);
+    uint64_t width = 1ULL << (k - kSubBucketBits);
+    return lower + width / 2;
+}
+
+@implementation YYBenchmarkHistogram {
+    uint64_t _counts[kBucketCount];
+    double _sum;
+}
+
+- (instancetype)init {
+    self = [super init];
+    [self reset];
+    return self;
+}
+
+- (void)reset {
+    memset(_counts, 0, sizeof(_counts));
+    _count = 0;
+    _min = UINT64_MAX;
+    _max = 0;
+    _sum = 0;
+}
+
+- (uint64_t)min {
+    return _count ? _min : 0;
+}
+
+- (double)mean {
+    return _count ? _sum / _count : 0;
+}
+
+- (void)recordValue:(uint64_t)value {
+    _counts[_YYHistogramIndex(value)]++;
+    _count++;
+    _sum += value;
+    if (value < _min) _min = value;
+    if (value > _max) _max = value;
+}
+
+- (void)addHistogram:(YYBenchmarkHistogram *)histogram {
+    if (!histogram || histogram->_count == 0) return;
+    for (int i = 0; i < kBucketCount; i++) {
+        _counts[i] += histogram->_counts[i];
+    }
+    _count += histogram->_count;
+    _sum += histogram->_sum;
+    if (histogram->_min < _min) _min = histogram->_min;
+    if (histogram->_max > _max) _max = histogram->_max;
+}
+
+- (uint64_t)valueAtPercentile:(double)percentile {
+    if (_count == 0) return 0;
+    if (percentile >= 100) return _max;
+    uint64_t target = (uint64_t)ceil(percentile / 100.0 * _count);
+    if (target == 0) target = 1;
+    uint64_t total = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        total += _counts[i];
+        if (total >= target) {
+            uint64_t value = _YYHistogramValue(i);
+            return MIN(MAX(value, _min), _max);
+        }
+    }
+    return _max;
+}
+
+@end
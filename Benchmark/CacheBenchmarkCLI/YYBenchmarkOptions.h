@@ -0,0 +1,43 @@
+//
+//  YYBenchmarkOptions.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The command line: `yycache-bench [command] [--name value | --flag]...`.
+ */
+@interface YYBenchmarkOptions : NSObject
+
+/** The first argument if it's not an option, or nil. */
+@property (nullable, nonatomic, readonly) NSString *command;
+
+/** The arguments which are not options, except the command. */
+@property (nonatomic, readonly) NSArray<NSString *> *arguments;
+
+- (instancetype)initWithArguments:(NSArray<NSString *> *)arguments; ///< without the executable
+
+- (BOOL)hasOption:(NSString *)name; ///< name without "--"
+- (nullable NSString *)stringForOption:(NSString *)name;
+- (NSString *)stringForOption:(NSString *)name defaultValue:(NSString *)value;
+- (long long)integerForOption:(NSString *)name defaultValue:(long long)value;
+- (double)doubleForOption:(NSString *)name defaultValue:(double)value;
+
+/** A comma separated list, such as "--threads 1,2,4,8". */
+- (NSArray<NSString *> *)listForOption:(NSString *)name defaultValue:(NSArray<NSString *> *)value;
+
+/**
+ A byte size, with an optional unit: "100", "100B", "20KB", "10MB", "1GB".
+ Returns -1 if the string is not a size.
+ */
++ (long long)byteSizeFromString:(NSString *)string;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,91 @@
+//
+//  YYBenchmarkOptions.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYBenchmarkOptions.h"
+
+@implementation YYBenchmarkOptions {
+    NSMutableDictionary *_options; ///< name -> value, flags are @""
+}
+
+- (instancetype)initWithArguments:(NSArray *)arguments {
+    self = [super init];
+    _options = [NSMutableDictionary new];
+    NSMutableArray *positional = [NSMutableArray new];
+    for (NSUInteger i = 0; i < arguments.count; i++) {
+        NSString *arg = arguments[i];
+        if ([arg hasPrefix:@"--"] && arg.length > 2) {
+            NSString *name = [arg substringFromIndex:2];
+            NSRange eq = [name rangeOfString:@"="];
+            if (eq.location != NSNotFound) { // --name=value
+                _options[[name substringToIndex:eq.location]] = [name substringFromIndex:eq.location + 1];
+            } else if (i + 1 < arguments.count && ![arguments[i + 1] hasPrefix:@"--"]) { // --name value
+                _options[name] = arguments[++i];
+            } else { // --flag
+                _options[name] = @"";
+            }
+        } else {
+            [positional addObject:arg];
+        }
+    }
+    if (positional.count) {
+        _command = positional.firstObject;
+        [positional removeObjectAtIndex:0];
+    }
+    _arguments = positional;
+    return self;
+}
+
+- (BOOL)hasOption:(NSString *)name {
+    return _options[name] != nil;
+}
+
+- (NSString *)stringForOption:(NSString *)name {
+    NSString *value = _options[name];
+    return value.length ? value : nil;
+}
+
+- (NSString *)stringForOption:(NSString *)name defaultValue:(NSString *)value {
+    return [self stringForOption:name] ?: value;
+}
+
+- (long long)integerForOption:(NSString *)name defaultValue:(long long)value {
+    NSString *string = [self stringForOption:name];
+    return string ? string.longLongValue : value;
+}
+
+- (double)doubleForOption:(NSString *)name defaultValue:(double)value {
+    NSString *string = [self stringForOption:name];
+    return string ? string.doubleValue : value;
+}
+
+- (NSArray *)listForOption:(NSString *)name defaultValue:(NSArray *)value {
+    NSString *string = [self stringForOption:name];
+    if (!string) return value;
+    NSMutableArray *list = [NSMutableArray new];
+    for (NSString *item in [string componentsSeparatedByString:@","]) {
+        NSString *trimmed = [item stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        if (trimmed.length) [list addObject:trimmed];
+    }
+    return list;
+}
+
++ (long long)byteSizeFromString:(NSString *)string {
+    NSScanner *scanner = [NSScanner scannerWithString:string.uppercaseString];
+    double number = 0;
+    if (![scanner scanDouble:&number] || number < 0) return -1;
+    NSString *unit = [[string.uppercaseString substringFromIndex:scanner.scanLocation] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    NSDictionary *units = @{@"" : @1, @"B" : @1,
+                            @"K" : @1024, @"KB" : @1024,
+                            @"M" : @(1024 * 1024), @"MB" : @(1024 * 1024),
+                            @"G" : @(1024 * 1024 * 1024), @"GB" : @(1024 * 1024 * 1024)};
+    NSNumber *scale = units[unit];
+    if (!scale) return -1;
+    return (long long)(number * scale.doubleValue);
+}
+
+@end
@@ -0,0 +1,94 @@
+//
+//  YYBenchmarkReport.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ One measurement, such as "memory / write / NSData(4B) / YYMemoryCache".
+ */
+@interface YYBenchmarkRecord : NSObject
+@property (nonatomic, copy) NSString *suite;    ///< "memory", "disk"
+@property (nonatomic, copy) NSString *scenario; ///< "write", "replace", "read"...
+@property (nonatomic, copy) NSString *dataset;  ///< the kind of values, "NSNumber", "NSData(100KB)"...
+@property (nonatomic, copy) NSString *engine;   ///< "YYMemoryCache", "YYKVSQLite"...
+@property (nonatomic) NSUInteger count;         ///< operations
+@property (nonatomic) double time;              ///< total time in milliseconds
+@property (nullable, nonatomic, copy) NSDictionary<NSString *, NSNumber *> *metrics; ///< extra numbers
+@property (nonatomic) NSUInteger run;           ///< index of the repeated run, the records of a measurement are its samples
+
+/// "suite/scenario/dataset/engine", identifies the same measurement in different runs.
+@property (nonatomic, readonly) NSString *identifier;
+
+- (NSDictionary *)dictionaryValue;
+@end
+
+
+/**
+ Collects the records of a run, prints them as they come (in the format of
+ `Benchmark.m`), and writes them as JSON at the end.
+ */
+@interface YYBenchmarkReport : NSObject
+
+/** The stream to print the progress, default is stdout, NULL to keep quiet. */
+@property (nonatomic, nullable) FILE *log;
+
+/** A name for the machine class, such as "c5.xlarge", stored in the JSON. */
+@property (nullable, nonatomic, copy) NSString *label;
+
+@property (nonatomic, readonly) NSArray<YYBenchmarkRecord *> *records;
+
+/** Index of the current run with `--repeat`, it's stamped on the records added. */
+@property (nonatomic) NSUInteger run;
+
+/** The latency metrics of the cache (`[YYCacheMetrics snapshot]`), stored in the JSON if not nil. */
+@property (nullable, nonatomic, copy) NSDictionary *cacheMetrics;
+
+/** The changes from the baseline (`YYBenchmarkChange.dictionaryValue`), stored in the JSON if not nil. */
+@property (nullable, nonatomic, copy) NSArray<NSDictionary *> *comparison;
+
+/** Prints a section header, such as "Memory cache set 200000 key-value pairs". */
+- (void)beginSection:(NSString *)title;
+
+/** Adds a record and prints it. */
+- (void)addRecord:(YYBenchmarkRecord *)record;
+
+/** Adds a record and prints the line instead of the time. */
+- (void)addRecord:(YYBenchmarkRecord *)record line:(nullable NSString *)line;
+
+/** Prints a line of progress. */
+- (void)log:(NSString *)format, ... NS_FORMAT_FUNCTION(1,2);
+
+/** Adds a record with the time measured, and prints it. */
+- (YYBenchmarkRecord *)addRecordWithSuite:(NSString *)suite
+                                 scenario:(NSString *)scenario
+                                  dataset:(NSString *)dataset
+                                   engine:(NSString *)engine
+                                    count:(NSUInteger)count
+                                     time:(double)time;
+
+/** Host, OS, CPU, memory, SQLite version and date of the run. */
++ (NSDictionary *)environment;
+
+/** {"environment": {...}, "label": ..., "records": [...], "cache_metrics": {...}, "comparison": [...]}. */
+- (NSDictionary *)dictionaryValue;
+
+/** Writes the JSON to a file, or to stdout if the path is "-". */
+- (BOOL)writeJSONToPath:(NSString *)path error:(NSError **)error;
+
+/**
+ Writes the records as CSV to a file, or to stdout if the path is "-". The columns are
+ label, run, suite, scenario, dataset, engine, count, time_ms and the metrics of all records
+ in name order, a metric is empty for the records without it.
+ */
+- (BOOL)writeCSVToPath:(NSString *)path error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
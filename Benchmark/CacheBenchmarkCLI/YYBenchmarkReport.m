@@ -0,0 +1,193 @@
+//
+//  YYBenchmarkReport.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYBenchmarkReport.h"
+#import <unistd.h>
+
+#if __has_include(<sqlite3.h>)
+#import <sqlite3.h>
+#else
+#import "sqlite3.h"
+#endif
+
+@implementation YYBenchmarkRecord
+
+- (NSString *)identifier {
+    return [NSString stringWithFormat:@"%@/%@/%@/%@", _suite, _scenario, _dataset, _engine];
+}
+
+- (NSDictionary *)dictionaryValue {
+    NSMutableDictionary *dic = [NSMutableDictionary new];
+    dic[@"suite"] = _suite ?: @"";
+    dic[@"scenario"] = _scenario ?: @"";
+    dic[@"dataset"] = _dataset ?: @"";
+    dic[@"engine"] = _engine ?: @"";
+    dic[@"run"] = @(_run);
+    dic[@"count"] = @(_count);
+    dic[@"time_ms"] = @(_time);
+    if (_metrics.count) dic[@"metrics"] = _metrics;
+    return dic;
+}
+
+@end
+
+
+/// Quotes a CSV field if it has a comma, a quote or a line break.
+static NSString *_YYBenchmarkCSVField(NSString *field) {
+    if ([field rangeOfCharacterFromSet:[NSCharacterSet characterSetWithCharactersInString:@",\"\r\n"]].location == NSNotFound) return field;
+    return [NSString stringWithFormat:@"\"%@\"", [field stringByReplacingOccurrencesOfString:@"\"" withString:@"\"\""]];
+}
+
+
+@implementation YYBenchmarkReport {
+    NSMutableArray *_records;
+}
+
+- (instancetype)init {
+    self = [super init];
+    _records = [NSMutableArray new];
+    _log = stdout;
+    return self;
+}
+
+- (NSArray *)records {
+    return _records.copy;
+}
+
+- (void)beginSection:(NSString *)title {
+    if (!_log) return;
+    fprintf(_log, "\n===========================\n");
+    fprintf(_log, "%s\n", title.UTF8String);
+    fflush(_log);
+}
+
+- (void)addRecord:(YYBenchmarkRecord *)record {
+    [self addRecord:record line:nil];
+}
+
+- (void)addRecord:(YYBenchmarkRecord *)record line:(NSString *)line {
+    if (!record) return;
+    record.run = _run;
+    [_records addObject:record];
+    if (!_log) return;
+    if (line) {
+        fprintf(_log, "%s\n", line.UTF8String);
+    } else {
+        NSString *name = [record.engine stringByAppendingString:@":"];
+        fprintf(_log, "%-15s %8.2f\n", name.UTF8String, record.time);
+    }
+    fflush(_log);
+}
+
+- (void)log:(NSString *)format, ... {
+    if (!_log) return;
+    va_list args;
+    va_start(args, format);
+    NSString *line = [[NSString alloc] initWithFormat:format arguments:args];
+    va_end(args);
+    fprintf(_log, "%s\n", line.UTF8String);
+    fflush(_log);
+}
+
+- (YYBenchmarkRecord *)addRecordWithSuite:(NSString *)suite
+                                 scenario:(NSString *)scenario
+                                  dataset:(NSString *)dataset
+                                   engine:(NSString *)engine
+                                    count:(NSUInteger)count
+                                     time:(double)time {
+    YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+    record.suite = suite;
+    record.scenario = scenario;
+    record.dataset = dataset;
+    record.engine = engine;
+    record.count = count;
+    record.time = time;
+    [self addRecord:record];
+    return record;
+}
+
++ (NSDictionary *)environment {
+    NSProcessInfo *info = [NSProcessInfo processInfo];
+    char host[256] = {0};
+    gethostname(host, sizeof(host) - 1);
+    NSDateFormatter *formatter = [NSDateFormatter new];
+    formatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    formatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ssZZZZZ";
+    return @{@"host" : @(host),
+             @"os" : info.operatingSystemVersionString ?: @"",
+             @"cpu_count" : @(info.activeProcessorCount),
+             @"physical_memory" : @(info.physicalMemory),
+             @"sqlite" : @(sqlite3_libversion()),
+             @"date" : [formatter stringFromDate:[NSDate date]]};
+}
+
+- (NSDictionary *)dictionaryValue {
+    NSMutableArray *records = [NSMutableArray new];
+    for (YYBenchmarkRecord *record in _records) {
+        [records addObject:record.dictionaryValue];
+    }
+    NSMutableDictionary *dic = [NSMutableDictionary new];
+    dic[@"environment"] = [self.class environment];
+    if (_label) dic[@"label"] = _label;
+    dic[@"records"] = records;
+    if (_cacheMetrics) dic[@"cache_metrics"] = _cacheMetrics;
+    if (_comparison) dic[@"comparison"] = _comparison;
+    return dic;
+}
+
+- (BOOL)writeJSONToPath:(NSString *)path error:(NSError **)error {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:self.dictionaryValue options:NSJSONWritingPrettyPrinted error:error];
+    if (!data) return NO;
+    if ([path isEqualToString:@"-"]) {
+        fwrite(data.bytes, 1, data.length, stdout);
+        fputc('\n', stdout);
+        fflush(stdout);
+        return YES;
+    }
+    return [data writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+- (BOOL)writeCSVToPath:(NSString *)path error:(NSError **)error {
+    NSMutableSet *metricNames = [NSMutableSet new];
+    for (YYBenchmarkRecord *record in _records) {
+        [metricNames addObjectsFromArray:record.metrics.allKeys];
+    }
+    NSArray *names = [metricNames.allObjects sortedArrayUsingSelector:@selector(compare:)];
+
+    NSMutableString *csv = [NSMutableString new];
+    NSMutableArray *header = @[@"label", @"run", @"suite", @"scenario", @"dataset", @"engine", @"count", @"time_ms"].mutableCopy;
+    [header addObjectsFromArray:names];
+    [csv appendString:[header componentsJoinedByString:@","]];
+    [csv appendString:@"\n"];
+    for (YYBenchmarkRecord *record in _records) {
+        NSMutableArray *fields = [NSMutableArray new];
+        [fields addObject:_YYBenchmarkCSVField(_label ?: @"")];
+        [fields addObject:@(record.run).description];
+        for (NSString *field in @[record.suite ?: @"", record.scenario ?: @"", record.dataset ?: @"", record.engine ?: @""]) {
+            [fields addObject:_YYBenchmarkCSVField(field)];
+        }
+        [fields addObject:@(record.count).description];
+        [fields addObject:@(record.time).description];
+        for (NSString *name in names) {
+            NSNumber *value = record.metrics[name];
+            [fields addObject:value ? value.description : @""];
+        }
+        [csv appendString:[fields componentsJoinedByString:@","]];
+        [csv appendString:@"\n"];
+    }
+
+    NSData *data = [csv dataUsingEncoding:NSUTF8StringEncoding];
+    if ([path isEqualToString:@"-"]) {
+        fwrite(data.bytes, 1, data.length, stdout);
+        fflush(stdout);
+        return YES;
+    }
+    return [data writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+@end
@@ -0,0 +1,102 @@
+//
+//  YYBenchmarkUtil.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <time.h>
+#import <unistd.h>
+#if __APPLE__
+#import <mach/mach.h>
+#import <malloc/malloc.h>
+#else
+#import <malloc.h>
+#endif
+
+/// Monotonic time in seconds, same as CACurrentMediaTime().
+static inline double YYBenchmarkNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// Monotonic time in nanoseconds, for the latency of one operation.
+static inline uint64_t YYBenchmarkNowNanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ A seeded random generator (xorshift64*), so a run can be repeated exactly.
+ arc4random is not seedable, and not available in every libc.
+ */
+typedef struct {
+    uint64_t state;
+} YYBenchmarkRandom;
+
+static inline YYBenchmarkRandom YYBenchmarkRandomMake(uint64_t seed) {
+    YYBenchmarkRandom random = {seed ? seed : 0x9E3779B97F4A7C15ULL};
+    return random;
+}
+
+static inline uint64_t YYBenchmarkRandomNext(YYBenchmarkRandom *random) {
+    uint64_t x = random->state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    random->state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/// A random number in [0, bound).
+static inline uint32_t YYBenchmarkRandomUniform(YYBenchmarkRandom *random, uint32_t bound) {
+    return (uint32_t)(((YYBenchmarkRandomNext(random) >> 32) * bound) >> 32);
+}
+
+/// A random number in [0, 1).
+static inline double YYBenchmarkRandomDouble(YYBenchmarkRandom *random) {
+    return (YYBenchmarkRandomNext(random) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/// Fisher-Yates shuffle.
+static inline void YYBenchmarkShuffle(NSMutableArray *array, YYBenchmarkRandom *random) {
+    for (NSUInteger i = array.count; i > 1; i--) {
+        [array exchangeObjectAtIndex:(i - 1) withObjectAtIndex:YYBenchmarkRandomUniform(random, (uint32_t)i)];
+    }
+}
+
+/// Resident set size of the process in bytes, 0 if unknown.
+static inline uint64_t YYBenchmarkResidentBytes(void) {
+#if __APPLE__
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) return 0;
+    return info.resident_size;
+#else
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long long size = 0, resident = 0;
+    int matched = fscanf(file, "%llu %llu", &size, &resident);
+    fclose(file);
+    return matched == 2 ? resident * (uint64_t)sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+/// Bytes in use by malloc (all zones on Darwin, glibc's arenas and mmap chunks on Linux).
+static inline uint64_t YYBenchmarkAllocatedBytes(void) {
+#if __APPLE__
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats.size_in_use;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (uint64_t)info.uordblks + (uint64_t)info.hblkhd;
+#else
+    struct mallinfo info = mallinfo(); // the int counters wrap at 2GB
+    return (uint64_t)(unsigned int)info.uordblks + (uint64_t)(unsigned int)info.hblkhd;
+#endif
+}
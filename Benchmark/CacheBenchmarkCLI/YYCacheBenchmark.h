@@ -0,0 +1,49 @@
+//
+//  YYCacheBenchmark.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class YYBenchmarkReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The scenarios of `Benchmark.m` without UIKit: write, replace, read, read again,
+ random read and read none exist, for the memory caches and the disk caches.
+
+ @discussion Each disk scenario opens the storages again, as the app benchmark
+ does in separate launches, so the time includes opening the database. The page
+ cache of the OS is warm after the first read, see the disk matrix for cold reads.
+ */
+@interface YYCacheBenchmark : NSObject
+
+/** The number of memory cache key-value pairs. Default is 200000. */
+@property (nonatomic) NSUInteger memoryCount;
+
+/** The number of disk cache key-value pairs. Default is 1000. */
+@property (nonatomic) NSUInteger diskCount;
+
+/** The size of the large disk values in bytes. Default is 100KB. */
+@property (nonatomic) NSUInteger largeValueSize;
+
+/** The directory to write the disk caches, it's removed before the disk benchmark. */
+@property (nonatomic, copy) NSString *path;
+
+/** The seed of the random orders. */
+@property (nonatomic) uint64_t seed;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithReport:(YYBenchmarkReport *)report NS_DESIGNATED_INITIALIZER;
+
+- (void)runMemoryBenchmark;
+- (void)runDiskBenchmark;
+
+@end
+
+NS_ASSUME_NONNULL_END
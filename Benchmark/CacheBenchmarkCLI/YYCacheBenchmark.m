@@ -0,0 +1,199 @@
+//
+//  YYCacheBenchmark.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYCacheBenchmark.h"
+#import "YYBenchmarkReport.h"
+#import "YYBenchmarkEngine.h"
+#import "YYBenchmarkUtil.h"
+
+@implementation YYCacheBenchmark {
+    YYBenchmarkReport *_report;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYCacheBenchmark init error" reason:@"Use 'initWithReport:' instead." userInfo:nil];
+    return [self initWithReport:[YYBenchmarkReport new]];
+}
+
+- (instancetype)initWithReport:(YYBenchmarkReport *)report {
+    self = [super init];
+    _report = report;
+    _memoryCount = 200000;
+    _diskCount = 1000;
+    _largeValueSize = 100 * 1024;
+    _path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YYCacheBenchmark"];
+    _seed = 1;
+    return self;
+}
+
+#pragma mark - private
+
+/// Sets the values if there's values, otherwise gets the keys, for each engine.
+- (void)_runSuite:(NSString *)suite
+         scenario:(NSString *)scenario
+          dataset:(NSString *)dataset
+          engines:(NSArray *)engines
+             keys:(NSArray *)keys
+           values:(NSArray *)values
+        expectHit:(BOOL)expectHit {
+    NSUInteger count = keys.count;
+    for (YYBenchmarkEngine *engine in engines) {
+        NSUInteger misses = 0;
+        double begin, end;
+        begin = YYBenchmarkNow();
+        @autoreleasepool {
+            if (values) {
+                for (NSUInteger i = 0; i < count; i++) {
+                    [engine setObject:values[i] forKey:keys[i]];
+                }
+            } else {
+                for (NSUInteger i = 0; i < count; i++) {
+                    if (![engine objectForKey:keys[i]]) misses++;
+                }
+            }
+        }
+        end = YYBenchmarkNow();
+        YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+        record.suite = suite;
+        record.scenario = scenario;
+        record.dataset = dataset;
+        record.engine = engine.name;
+        record.count = count;
+        record.time = (end - begin) * 1000;
+        if (!values) record.metrics = @{@"misses" : @(misses)};
+        [_report addRecord:record];
+        if (expectHit && misses > 0) {
+            fprintf(stderr, "error! %s missed %lu keys in %s\n", engine.name.UTF8String, (unsigned long)misses, scenario.UTF8String);
+        }
+    }
+}
+
+#pragma mark - memory
+
+- (void)runMemoryBenchmark {
+    NSArray *engines = [YYBenchmarkEngine memoryEngines];
+    NSString *suite = @"memory";
+    NSString *dataset = @"NSData(4B)";
+    YYBenchmarkRandom random = YYBenchmarkRandomMake(_seed);
+
+    NSUInteger count = _memoryCount;
+    NSMutableArray *keys = [NSMutableArray new];
+    NSMutableArray *values = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; i++) {
+        int v = (int)i;
+        [keys addObject:@(i)]; // avoid string compare
+        [values addObject:[NSData dataWithBytes:&v length:sizeof(int)]];
+    }
+    NSMutableArray *randomKeys = keys.mutableCopy;
+    YYBenchmarkShuffle(randomKeys, &random);
+    NSMutableArray *noneExistKeys = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; i++) {
+        [noneExistKeys addObject:@(i + count)];
+    }
+    YYBenchmarkShuffle(noneExistKeys, &random);
+
+    [_report beginSection:[NSString stringWithFormat:@"Memory cache set %lu key-value pairs", (unsigned long)count]];
+    [self _runSuite:suite scenario:@"write" dataset:dataset engines:engines keys:keys values:values expectHit:NO];
+
+    [_report beginSection:[NSString stringWithFormat:@"Memory cache replace %lu key-value pairs", (unsigned long)count]];
+    [self _runSuite:suite scenario:@"replace" dataset:dataset engines:engines keys:keys values:values expectHit:NO];
+
+    [_report beginSection:[NSString stringWithFormat:@"Memory cache get %lu key-value pairs", (unsigned long)count]];
+    [self _runSuite:suite scenario:@"read" dataset:dataset engines:engines keys:keys values:nil expectHit:YES];
+
+    [_report beginSection:[NSString stringWithFormat:@"Memory cache get %lu key-value pairs again", (unsigned long)count]];
+    [self _runSuite:suite scenario:@"read-again" dataset:dataset engines:engines keys:keys values:nil expectHit:YES];
+
+    [_report beginSection:[NSString stringWithFormat:@"Memory cache get %lu key-value pairs randomly", (unsigned long)count]];
+    [self _runSuite:suite scenario:@"random-read" dataset:dataset engines:engines keys:randomKeys values:nil expectHit:YES];
+
+    [_report beginSection:[NSString stringWithFormat:@"Memory cache get %lu key-value pairs none exist", (unsigned long)count]];
+    [self _runSuite:suite scenario:@"read-none-exist" dataset:dataset engines:engines keys:noneExistKeys values:nil expectHit:NO];
+}
+
+#pragma mark - disk
+
+/// Opens the engines again for each scenario, as the app benchmark does in separate launches.
+- (void)_runDiskScenario:(NSString *)scenario
+                   title:(NSString *)title
+                 dataset:(NSString *)dataset
+                    path:(NSString *)path
+                 archive:(BOOL)archive
+                    keys:(NSArray *)keys
+                  values:(NSArray *)values
+               expectHit:(BOOL)expectHit {
+    [_report beginSection:title];
+    @autoreleasepool {
+        NSArray *engines = [YYBenchmarkEngine diskEnginesWithPath:path archive:archive];
+        [self _runSuite:@"disk" scenario:scenario dataset:dataset engines:engines keys:keys values:values expectHit:expectHit];
+    }
+}
+
+- (void)_runDiskBenchmarkWithDataset:(NSString *)dataset
+                                path:(NSString *)path
+                             archive:(BOOL)archive
+                              values:(NSArray *)values {
+    YYBenchmarkRandom random = YYBenchmarkRandomMake(_seed);
+    NSUInteger count = values.count;
+    NSMutableArray *keys = [NSMutableArray new];
+    NSMutableArray *noneExistKeys = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; i++) {
+        [keys addObject:@(i).description];
+        [noneExistKeys addObject:@(i + count).description];
+    }
+    NSMutableArray *randomKeys = keys.mutableCopy;
+    YYBenchmarkShuffle(randomKeys, &random);
+    YYBenchmarkShuffle(noneExistKeys, &random);
+
+    NSString *pairs = [NSString stringWithFormat:@"%lu key-value pairs", (unsigned long)count];
+    NSString *value = [NSString stringWithFormat:@"(value is %@)", dataset];
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    [self _runDiskScenario:@"write" title:[NSString stringWithFormat:@"Disk cache set %@ %@", pairs, value]
+                   dataset:dataset path:path archive:archive keys:keys values:values expectHit:NO];
+    [self _runDiskScenario:@"replace" title:[NSString stringWithFormat:@"Disk cache replace %@ %@", pairs, value]
+                   dataset:dataset path:path archive:archive keys:keys values:values expectHit:NO];
+    [self _runDiskScenario:@"read" title:[NSString stringWithFormat:@"Disk cache get %@ %@", pairs, value]
+                   dataset:dataset path:path archive:archive keys:keys values:nil expectHit:YES];
+    [self _runDiskScenario:@"read-again" title:[NSString stringWithFormat:@"Disk cache get %@ again (with file-in-memory cache) %@", pairs, value]
+                   dataset:dataset path:path archive:archive keys:keys values:nil expectHit:YES];
+    [self _runDiskScenario:@"random-read" title:[NSString stringWithFormat:@"Disk cache get %@ randomly %@", pairs, value]
+                   dataset:dataset path:path archive:archive keys:randomKeys values:nil expectHit:YES];
+    [self _runDiskScenario:@"read-none-exist" title:[NSString stringWithFormat:@"Disk cache get %@ none exist %@", pairs, value]
+                   dataset:dataset path:path archive:archive keys:noneExistKeys values:nil expectHit:NO];
+}
+
+- (void)runDiskBenchmark {
+    NSUInteger count = _diskCount;
+
+    NSMutableArray *smallValues = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; i++) {
+        [smallValues addObject:@(i)];
+    }
+    [self _runDiskBenchmarkWithDataset:@"NSNumber"
+                                  path:[_path stringByAppendingPathComponent:@"FileCacheBenchmarkSmall"]
+                               archive:YES
+                                values:smallValues];
+
+    NSMutableData *dataValue = [NSMutableData dataWithLength:_largeValueSize];
+    uint8_t *bytes = dataValue.mutableBytes;
+    for (NSUInteger i = 0; i < _largeValueSize; i++) {
+        bytes[i] = (uint8_t)i;
+    }
+    NSMutableArray *largeValues = [NSMutableArray new];
+    for (NSUInteger i = 0; i < count; i++) {
+        [largeValues addObject:dataValue];
+    }
+    NSString *dataset = [NSString stringWithFormat:@"NSData(%luKB)", (unsigned long)(_largeValueSize / 1024)];
+    [self _runDiskBenchmarkWithDataset:dataset
+                                  path:[_path stringByAppendingPathComponent:@"FileCacheBenchmarkLarge"]
+                               archive:NO
+                                values:largeValues];
+}
+
+@end
@@ -0,0 +1,71 @@
+//
+//  YYContentionBenchmark.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class YYBenchmarkReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Multi-threaded benchmark of the thread safe caches: for each engine and each
+ read/write/remove mix, it runs 1 to N threads on the same cache for `duration`
+ seconds, with uniformly random keys.
+
+ @discussion It reports the throughput, the p50/p99/p999 latency and the lock wait
+ of each thread count. The lock wait is the mean latency above the one of a single
+ thread, so it includes the time waiting for the lock, and the time waiting for a
+ CPU when there are more threads than cores. The single thread run is always added.
+ With `lockProfiling`, it also reports the measured contention of the lock of
+ YYMemoryCache and YYDiskCache: the rate of contended acquisitions, the mean wait
+ per acquisition and the hold time of each operation.
+ */
+@interface YYContentionBenchmark : NSObject
+
+/** Thread counts to sweep. Default is 1, 2, 4, 8, 16, 32, 64. */
+@property (nonatomic, copy) NSArray<NSNumber *> *threadCounts;
+
+/** Percentages of "read:write:remove", such as "90:10:0". Default is 90:10:0, 50:50:0, 70:20:10. */
+@property (nonatomic, copy) NSArray<NSString *> *mixes;
+
+/** Names of the engines. Default is NSDict+Lock, YYMemoryCache, YYDiskCache. */
+@property (nonatomic, copy) NSArray<NSString *> *engineNames;
+
+/** Seconds of each run. Default is 1. */
+@property (nonatomic) NSTimeInterval duration;
+
+/** The number of keys, all written before the runs. Default is 10000. */
+@property (nonatomic) NSUInteger keyCount;
+
+/** The size of the values in bytes. Default is 100. */
+@property (nonatomic) NSUInteger valueSize;
+
+/**
+ Whether to enable `lockProfilingEnabled` of the caches in the runs. Default is NO,
+ as it adds a little cost to each access.
+ */
+@property (nonatomic) BOOL lockProfiling;
+
+/** The directory to write the disk caches. */
+@property (nonatomic, copy) NSString *path;
+
+@property (nonatomic) uint64_t seed;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithReport:(YYBenchmarkReport *)report NS_DESIGNATED_INITIALIZER;
+
+/** Parses "read:write:remove", returns NO if it's not 3 numbers with a sum of 100. */
++ (BOOL)parseMix:(NSString *)mix read:(int *)read write:(int *)write remove:(int *)remove;
+
+/** Runs the sweep, returns NO if the options are invalid. */
+- (BOOL)run;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,328 @@
+//
+//  YYContentionBenchmark.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYContentionBenchmark.h"
+#import "YYBenchmarkReport.h"
+#import "YYBenchmarkEngine.h"
+#import "YYBenchmarkHistogram.h"
+#import "YYBenchmarkUtil.h"
+#import "YYMemoryCache.h"
+#import "YYCacheLockProfile.h"
+#import <stdatomic.h>
+#import <sched.h>
+
+/// Shared by the workers of a run.
+typedef struct {
+    atomic_int ready;
+    atomic_bool start;
+    atomic_bool stop;
+} _YYContentionSignal;
+
+/**
+ One thread of a run.
+ Typically, you should not use this class directly.
+ */
+@interface _YYContentionWorker : NSObject {
+    @package
+    YYBenchmarkEngine *_engine;
+    NSArray *_keys;
+    NSData *_value;
+    int _read;  ///< percent
+    int _write; ///< percent
+    YYBenchmarkRandom _random;
+    _YYContentionSignal *_signal;
+    dispatch_group_t _group;
+    YYBenchmarkHistogram *_readLatency;   ///< ns
+    YYBenchmarkHistogram *_writeLatency;  ///< ns
+    YYBenchmarkHistogram *_removeLatency; ///< ns
+}
+- (void)run;
+@end
+
+@implementation _YYContentionWorker
+
+- (instancetype)init {
+    self = [super init];
+    _readLatency = [YYBenchmarkHistogram new];
+    _writeLatency = [YYBenchmarkHistogram new];
+    _removeLatency = [YYBenchmarkHistogram new];
+    return self;
+}
+
+- (void)run {
+    YYBenchmarkEngine *engine = _engine;
+    NSArray *keys = _keys;
+    NSData *value = _value;
+    uint32_t keyCount = (uint32_t)keys.count;
+    int readWrite = _read + _write;
+
+    atomic_fetch_add(&_signal->ready, 1);
+    while (!atomic_load(&_signal->start)) sched_yield();
+
+    while (!atomic_load_explicit(&_signal->stop, memory_order_relaxed)) {
+        @autoreleasepool {
+            for (int batch = 0; batch < 64; batch++) {
+                int op = (int)YYBenchmarkRandomUniform(&_random, 100);
+                id key = keys[YYBenchmarkRandomUniform(&_random, keyCount)];
+                uint64_t begin, end;
+                if (op < _read) {
+                    begin = YYBenchmarkNowNanoseconds();
+                    [engine objectForKey:key];
+                    end = YYBenchmarkNowNanoseconds();
+                    [_readLatency recordValue:end - begin];
+                } else if (op < readWrite) {
+                    begin = YYBenchmarkNowNanoseconds();
+                    [engine setObject:value forKey:key];
+                    end = YYBenchmarkNowNanoseconds();
+                    [_writeLatency recordValue:end - begin];
+                } else {
+                    begin = YYBenchmarkNowNanoseconds();
+                    [engine removeObjectForKey:key];
+                    end = YYBenchmarkNowNanoseconds();
+                    [_removeLatency recordValue:end - begin];
+                }
+                if (atomic_load_explicit(&_signal->stop, memory_order_relaxed)) break;
+            }
+        }
+    }
+    dispatch_group_leave(_group);
+}
+
+@end
+
+
+@implementation YYContentionBenchmark {
+    YYBenchmarkReport *_report;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYContentionBenchmark init error" reason:@"Use 'initWithReport:' instead." userInfo:nil];
+    return [self initWithReport:[YYBenchmarkReport new]];
+}
+
+- (instancetype)initWithReport:(YYBenchmarkReport *)report {
+    self = [super init];
+    _report = report;
+    _threadCounts = @[@1, @2, @4, @8, @16, @32, @64];
+    _mixes = @[@"90:10:0", @"50:50:0", @"70:20:10"];
+    _engineNames = @[@"NSDict+Lock", @"YYMemoryCache", @"YYDiskCache"];
+    _duration = 1;
+    _keyCount = 10000;
+    _valueSize = 100;
+    _path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YYCacheBenchmark"];
+    _seed = 1;
+    return self;
+}
+
++ (BOOL)parseMix:(NSString *)mix read:(int *)read write:(int *)write remove:(int *)remove {
+    NSArray *parts = [mix componentsSeparatedByString:@":"];
+    if (parts.count != 3) return NO;
+    int r = [parts[0] intValue], w = [parts[1] intValue], d = [parts[2] intValue];
+    if (r < 0 || w < 0 || d < 0 || r + w + d != 100) return NO;
+    if (read) *read = r;
+    if (write) *write = w;
+    if (remove) *remove = d;
+    return YES;
+}
+
+#pragma mark - private
+
+/// Runs the threads on the engine, returns the merged latency histograms in [read, write, remove].
+- (NSArray *)_runEngine:(YYBenchmarkEngine *)engine
+                   keys:(NSArray *)keys
+                  value:(NSData *)value
+                   read:(int)read
+                  write:(int)write
+                threads:(NSUInteger)threadCount
+                elapsed:(double *)elapsed {
+    _YYContentionSignal signal;
+    atomic_init(&signal.ready, 0);
+    atomic_init(&signal.start, false);
+    atomic_init(&signal.stop, false);
+    dispatch_group_t group = dispatch_group_create();
+
+    NSMutableArray *workers = [NSMutableArray new];
+    for (NSUInteger i = 0; i < threadCount; i++) {
+        _YYContentionWorker *worker = [_YYContentionWorker new];
+        worker->_engine = engine;
+        worker->_keys = keys;
+        worker->_value = value;
+        worker->_read = read;
+        worker->_write = write;
+        worker->_random = YYBenchmarkRandomMake(_seed * 1000003 + i + 1);
+        worker->_signal = &signal;
+        worker->_group = group;
+        [workers addObject:worker];
+        dispatch_group_enter(group);
+        NSThread *thread = [[NSThread alloc] initWithTarget:worker selector:@selector(run) object:nil];
+        [thread start];
+    }
+    while (atomic_load(&signal.ready) < (int)threadCount) sched_yield();
+
+    double begin = YYBenchmarkNow();
+    atomic_store(&signal.start, true);
+    [NSThread sleepForTimeInterval:_duration];
+    atomic_store(&signal.stop, true);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    *elapsed = YYBenchmarkNow() - begin;
+
+    YYBenchmarkHistogram *readLatency = [YYBenchmarkHistogram new];
+    YYBenchmarkHistogram *writeLatency = [YYBenchmarkHistogram new];
+    YYBenchmarkHistogram *removeLatency = [YYBenchmarkHistogram new];
+    for (_YYContentionWorker *worker in workers) {
+        [readLatency addHistogram:worker->_readLatency];
+        [writeLatency addHistogram:worker->_writeLatency];
+        [removeLatency addHistogram:worker->_removeLatency];
+    }
+    return @[readLatency, writeLatency, removeLatency];
+}
+
+- (void)_runEngineName:(NSString *)name mix:(NSString *)mix threadCounts:(NSArray *)threadCounts {
+    int read = 0, write = 0, remove = 0;
+    [self.class parseMix:mix read:&read write:&write remove:&remove];
+
+    NSString *path = [_path stringByAppendingPathComponent:@"Contention"];
+    path = [path stringByAppendingPathComponent:[NSString stringWithFormat:@"%@-%d-%d-%d", name, read, write, remove]];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    YYBenchmarkEngine *engine = [YYBenchmarkEngine engineWithName:name path:path archive:NO];
+    if (!engine.isThreadSafe) {
+        fprintf(stderr, "skip %s: not thread safe\n", name.UTF8String);
+        return;
+    }
+
+    NSMutableArray *keys = [NSMutableArray new];
+    for (NSUInteger i = 0; i < _keyCount; i++) {
+        [keys addObject:[NSString stringWithFormat:@"key-%lu", (unsigned long)i]];
+    }
+    NSMutableData *value = [NSMutableData dataWithLength:_valueSize];
+    uint8_t *bytes = value.mutableBytes;
+    for (NSUInteger i = 0; i < _valueSize; i++) bytes[i] = (uint8_t)i;
+    NSString *dataset = [NSString stringWithFormat:@"NSData(%luB)", (unsigned long)_valueSize];
+
+    [_report beginSection:[NSString stringWithFormat:@"%@ contention, read %d%% write %d%% remove %d%%, %lu keys, %@, %.1fs each",
+                           name, read, write, remove, (unsigned long)_keyCount, dataset, _duration]];
+
+    double baseMean = 0; // ns, mean latency of a single thread
+    for (NSNumber *threads in threadCounts) {
+        @autoreleasepool {
+            for (id key in keys) [engine setObject:value forKey:key]; // refill what's removed
+
+            id cache = engine.cache;
+            BOOL profiled = _lockProfiling && [cache respondsToSelector:@selector(lockStats)];
+            if (profiled) [cache setLockProfilingEnabled:YES]; // resets the stats
+
+            double elapsed = 0;
+            NSArray *latencies = [self _runEngine:engine keys:keys value:value read:read write:write
+                                          threads:threads.unsignedIntegerValue elapsed:&elapsed];
+            YYCacheLockStats *lockStats = nil;
+            if (profiled) {
+                lockStats = [cache lockStats];
+                [cache setLockProfilingEnabled:NO];
+            }
+            YYBenchmarkHistogram *all = [YYBenchmarkHistogram new];
+            for (YYBenchmarkHistogram *latency in latencies) [all addHistogram:latency];
+            if (all.count == 0 || elapsed <= 0) continue;
+            if (threads.unsignedIntegerValue == 1) baseMean = all.mean;
+
+            double throughput = all.count / elapsed;
+            double p50 = [all valueAtPercentile:50] / 1000.0;
+            double p99 = [all valueAtPercentile:99] / 1000.0;
+            double p999 = [all valueAtPercentile:99.9] / 1000.0;
+            double wait = MAX(all.mean - baseMean, 0) / 1000.0; // us per operation
+            double totalWait = wait * all.count / 1000.0;       // ms of all threads
+
+            NSMutableDictionary *metrics = [NSMutableDictionary new];
+            metrics[@"threads"] = threads;
+            metrics[@"ops_per_sec"] = @(throughput);
+            metrics[@"mean_us"] = @(all.mean / 1000.0);
+            metrics[@"p50_us"] = @(p50);
+            metrics[@"p99_us"] = @(p99);
+            metrics[@"p999_us"] = @(p999);
+            metrics[@"max_us"] = @(all.max / 1000.0);
+            metrics[@"lock_wait_us"] = @(wait);
+            metrics[@"lock_wait_total_ms"] = @(totalWait);
+            if (lockStats.acquisitions > 0) {
+                metrics[@"lock_acquisitions"] = @(lockStats.acquisitions);
+                metrics[@"lock_contention_rate"] = @(lockStats.contentionRate);
+                metrics[@"lock_wait_measured_us"] = @(lockStats.totalWaitTime * 1e6 / lockStats.acquisitions);
+                metrics[@"lock_hold_max_us"] = @(lockStats.maxHoldTime * 1e6);
+                for (NSUInteger op = 0; op < YYCacheLockOperationCount; op++) {
+                    YYCacheLockStats *opStats = [lockStats statsForOperation:op];
+                    if (opStats.totalHoldTime <= 0) continue;
+                    NSString *opName = [YYCacheLockStats nameForOperation:op];
+                    metrics[[NSString stringWithFormat:@"lock_%@_hold_ms", opName]] = @(opStats.totalHoldTime * 1e3);
+                    metrics[[NSString stringWithFormat:@"lock_%@_hold_max_us", opName]] = @(opStats.maxHoldTime * 1e6);
+                }
+            }
+            NSArray *opNames = @[@"read", @"write", @"remove"];
+            for (NSUInteger i = 0; i < latencies.count; i++) {
+                YYBenchmarkHistogram *latency = latencies[i];
+                if (latency.count == 0) continue;
+                metrics[[opNames[i] stringByAppendingString:@"_ops"]] = @(latency.count);
+                metrics[[opNames[i] stringByAppendingString:@"_p99_us"]] = @([latency valueAtPercentile:99] / 1000.0);
+            }
+
+            YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+            record.suite = @"contention";
+            record.scenario = [NSString stringWithFormat:@"mix-%@/threads-%@", mix, threads];
+            record.dataset = dataset;
+            record.engine = name;
+            record.count = (NSUInteger)all.count;
+            record.time = elapsed * 1000;
+            record.metrics = metrics;
+            NSString *line = [NSString stringWithFormat:@"%3lu threads: %11.0f ops/s  p50 %8.2f  p99 %8.2f  p999 %9.2f us  wait %8.2f us/op",
+                              threads.unsignedLongValue, throughput, p50, p99, p999, wait];
+            if (lockStats.acquisitions > 0) {
+                line = [line stringByAppendingFormat:@"  contended %5.1f%%  hold max %8.2f us",
+                        lockStats.contentionRate * 100, lockStats.maxHoldTime * 1e6];
+            }
+            [_report addRecord:record line:line];
+        }
+    }
+    [engine removeAllObjects];
+}
+
+#pragma mark - public
+
+- (BOOL)run {
+    for (NSString *mix in _mixes) {
+        if (![self.class parseMix:mix read:NULL write:NULL remove:NULL]) {
+            fprintf(stderr, "invalid mix: %s, should be read:write:remove with a sum of 100\n", mix.UTF8String);
+            return NO;
+        }
+    }
+    NSMutableOrderedSet *threadCounts = [NSMutableOrderedSet orderedSetWithObject:@1]; // the base of lock wait
+    for (NSNumber *threads in _threadCounts) {
+        if (threads.integerValue <= 0) {
+            fprintf(stderr, "invalid thread count: %s\n", threads.description.UTF8String);
+            return NO;
+        }
+        [threadCounts addObject:@(threads.unsignedIntegerValue)];
+    }
+    if (_keyCount == 0 || _duration <= 0) {
+        fprintf(stderr, "invalid key count or duration\n");
+        return NO;
+    }
+
+    for (NSString *name in _engineNames) {
+        if (![[YYBenchmarkEngine engineNames] containsObject:name]) {
+            fprintf(stderr, "unknown engine: %s\n", name.UTF8String);
+            return NO;
+        }
+    }
+    for (NSString *name in _engineNames) {
+        for (NSString *mix in _mixes) {
+            @autoreleasepool {
+                [self _runEngineName:name mix:mix threadCounts:threadCounts.array];
+            }
+        }
+    }
+    return YES;
+}
+
+@end
@@ -0,0 +1,97 @@
+//
+//  YYDiskMatrixBenchmark.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class YYBenchmarkReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The disk storage matrix: value size × inline threshold × journal mode × synchronous
+ × mmap size, with reads in a warm and a cold page cache. It measures YYKVStorage
+ directly, the way YYDiskCache stores a value (in sqlite if its length is not larger
+ than the inline threshold), to tune the defaults for a platform with data.
+
+ @discussion For each cell, it writes `count` values (`cellBytes / valueSize`, within
+ `minCount` and `maxCount`) to a new storage, then reads them in random order:
+
+     write      the writes, and the size of the database and the files after them.
+     read-warm  the reads after reading all once.
+     read-cold  the reads after the storage is closed, and the pages of its files are
+                dropped from the OS page cache (posix_fadvise on Linux, purge on Darwin,
+                which requires root), then opened again. "evicted" is 0 if the pages can
+                not be dropped, then the reads are warm.
+
+ The records' engine is "threshold/journal/synchronous/mmap", such as
+ "inline-20KB/wal/normal/mmap-0", and the settings are in the metrics as numbers too,
+ so the JSON or CSV can be pivoted by any of them.
+ */
+@interface YYDiskMatrixBenchmark : NSObject
+
+/** Value sizes in bytes. Default is 100B, 1KB, 10KB, 100KB, 1MB, 10MB. */
+@property (nonatomic, copy) NSArray<NSNumber *> *valueSizes;
+
+/**
+ Inline thresholds in bytes, 0 stores all values in files (YYKVStorageTypeFile), and
+ NSUIntegerMax stores all in sqlite (YYKVStorageTypeSQLite).
+ Default is 0, 4KB, 20KB (YYDiskCache's default), 100KB, NSUIntegerMax.
+ */
+@property (nonatomic, copy) NSArray<NSNumber *> *inlineThresholds;
+
+/** Values of `pragma journal_mode`. Default is wal (YYKVStorage's default), delete. */
+@property (nonatomic, copy) NSArray<NSString *> *journalModes;
+
+/** Values of `pragma synchronous`. Default is normal (YYKVStorage's default), full. */
+@property (nonatomic, copy) NSArray<NSString *> *synchronousModes;
+
+/** Values of `pragma mmap_size` in bytes. Default is 0 (YYKVStorage's default), 256MB. */
+@property (nonatomic, copy) NSArray<NSNumber *> *mmapSizes;
+
+/** Measure the reads in a warm page cache. Default is YES. */
+@property (nonatomic) BOOL warmCache;
+
+/** Measure the reads in a cold page cache. Default is YES. */
+@property (nonatomic) BOOL coldCache;
+
+/** The bytes to write in each cell. Default is 16MB. */
+@property (nonatomic) NSUInteger cellBytes;
+
+/** The bounds of the values in each cell. Default is 5 and 2000. */
+@property (nonatomic) NSUInteger minCount;
+@property (nonatomic) NSUInteger maxCount;
+
+/** The directory of the storages, it's removed after each cell. */
+@property (nonatomic, copy) NSString *path;
+
+/** The seed of the values and the read orders. */
+@property (nonatomic) uint64_t seed;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithReport:(YYBenchmarkReport *)report NS_DESIGNATED_INITIALIZER;
+
+/** "file", "sqlite" or "inline-20KB". */
++ (NSString *)nameForInlineThreshold:(NSUInteger)threshold;
+
+/** Parses "file", "sqlite" or a byte size, returns NO if it's none of them. */
++ (BOOL)parseInlineThreshold:(NSString *)string threshold:(NSUInteger *)threshold;
+
+/**
+ Drops the pages of the files in the directory (recursively) from the OS page cache.
+ The files should be closed. Returns NO if it's not supported or fails on a file.
+ On Darwin, it drops the whole page cache with purge(8), and returns NO if not root.
+ */
++ (BOOL)evictPageCacheAtPath:(NSString *)path;
+
+/** Runs the matrix, returns NO if the options are invalid. */
+- (BOOL)run;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,360 @@
+//
+//  YYDiskMatrixBenchmark.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYDiskMatrixBenchmark.h"
+#import "YYBenchmarkReport.h"
+#import "YYBenchmarkOptions.h"
+#import "YYBenchmarkHistogram.h"
+#import "YYBenchmarkUtil.h"
+#import "YYKVStorage.h"
+#import <fcntl.h>
+#import <spawn.h>
+#import <unistd.h>
+#import <sys/wait.h>
+
+extern char **environ;
+
+/// "100B", "20KB", "10MB".
+static NSString *_YYDiskMatrixSizeName(unsigned long long size) {
+    if (size >= 1024 * 1024 && size % (1024 * 1024) == 0) return [NSString stringWithFormat:@"%lluMB", size / (1024 * 1024)];
+    if (size >= 1024 && size % 1024 == 0) return [NSString stringWithFormat:@"%lluKB", size / 1024];
+    return [NSString stringWithFormat:@"%lluB", size];
+}
+
+/// 0 off, 1 normal, 2 full, 3 extra, as sqlite numbers them.
+static int _YYDiskMatrixSynchronousLevel(NSString *mode) {
+    NSArray *levels = @[@"off", @"normal", @"full", @"extra"];
+    NSUInteger index = [levels indexOfObject:mode.lowercaseString];
+    return index == NSNotFound ? mode.intValue : (int)index;
+}
+
+/// Writes back the file, and drops its pages where the OS can do it for one file.
+static BOOL _YYDiskMatrixEvictFile(NSString *path) {
+    int fd = open(path.fileSystemRepresentation, O_RDONLY);
+    if (fd < 0) return NO;
+    fsync(fd);
+#if defined(POSIX_FADV_DONTNEED)
+    BOOL suc = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+#else
+    BOOL suc = YES; // written back only, see _YYDiskMatrixPurge()
+#endif
+    close(fd);
+    return suc;
+}
+
+#if !defined(POSIX_FADV_DONTNEED)
+/// Darwin can not drop the cached pages of one file: msync(MS_INVALIDATE) keeps the
+/// pages of a clean file, and F_NOCACHE only affects the later reads of its own fd.
+/// purge(8) drops the whole page cache, but it requires root.
+static BOOL _YYDiskMatrixPurge() {
+    if (geteuid() != 0) return NO;
+    pid_t pid;
+    char *argv[] = {"purge", NULL};
+    if (posix_spawn(&pid, "/usr/sbin/purge", NULL, NULL, argv, environ) != 0) return NO;
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid) return NO;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+#endif
+
+/// The sum of the file sizes in the directory, recursively.
+static unsigned long long _YYDiskMatrixDirectorySize(NSString *path) {
+    unsigned long long size = 0;
+    NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager] enumeratorAtPath:path];
+    for (NSString *name in enumerator) {
+        NSDictionary *attributes = enumerator.fileAttributes;
+        if ([attributes[NSFileType] isEqualToString:NSFileTypeRegular]) size += [attributes[NSFileSize] unsignedLongLongValue];
+    }
+    return size;
+}
+
+static unsigned long long _YYDiskMatrixFileSize(NSString *path) {
+    return [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil][NSFileSize] unsignedLongLongValue];
+}
+
+
+@implementation YYDiskMatrixBenchmark {
+    YYBenchmarkReport *_report;
+    BOOL _evictionWarned;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYDiskMatrixBenchmark init error" reason:@"Use 'initWithReport:' instead." userInfo:nil];
+    return [self initWithReport:[YYBenchmarkReport new]];
+}
+
+- (instancetype)initWithReport:(YYBenchmarkReport *)report {
+    self = [super init];
+    _report = report;
+    _valueSizes = @[@100, @1024, @(10 * 1024), @(100 * 1024), @(1024 * 1024), @(10 * 1024 * 1024)];
+    _inlineThresholds = @[@0, @(4 * 1024), @(20 * 1024), @(100 * 1024), @(NSUIntegerMax)];
+    _journalModes = @[@"wal", @"delete"];
+    _synchronousModes = @[@"normal", @"full"];
+    _mmapSizes = @[@0, @(256 * 1024 * 1024)];
+    _warmCache = YES;
+    _coldCache = YES;
+    _cellBytes = 16 * 1024 * 1024;
+    _minCount = 5;
+    _maxCount = 2000;
+    _path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YYCacheBenchmark"];
+    _seed = 1;
+    return self;
+}
+
++ (NSString *)nameForInlineThreshold:(NSUInteger)threshold {
+    if (threshold == 0) return @"file";
+    if (threshold == NSUIntegerMax) return @"sqlite";
+    return [@"inline-" stringByAppendingString:_YYDiskMatrixSizeName(threshold)];
+}
+
++ (BOOL)parseInlineThreshold:(NSString *)string threshold:(NSUInteger *)threshold {
+    NSUInteger value;
+    if ([string isEqualToString:@"file"]) {
+        value = 0;
+    } else if ([string isEqualToString:@"sqlite"]) {
+        value = NSUIntegerMax;
+    } else {
+        long long size = [YYBenchmarkOptions byteSizeFromString:string];
+        if (size < 0) return NO;
+        value = (NSUInteger)size;
+    }
+    if (threshold) *threshold = value;
+    return YES;
+}
+
++ (BOOL)evictPageCacheAtPath:(NSString *)path {
+    BOOL suc = YES;
+    NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager] enumeratorAtPath:path];
+    for (NSString *name in enumerator) {
+        if (![enumerator.fileAttributes[NSFileType] isEqualToString:NSFileTypeRegular]) continue;
+        if (!_YYDiskMatrixEvictFile([path stringByAppendingPathComponent:name])) suc = NO;
+    }
+#if !defined(POSIX_FADV_DONTNEED)
+    if (suc) suc = _YYDiskMatrixPurge();
+#endif
+    return suc;
+}
+
+#pragma mark - private
+
+- (YYKVStorage *)_openStorageAtPath:(NSString *)path
+                          threshold:(NSUInteger)threshold
+                            journal:(NSString *)journal
+                        synchronous:(NSString *)synchronous
+                               mmap:(NSUInteger)mmap {
+    YYKVStorageType type = YYKVStorageTypeMixed;
+    if (threshold == 0) type = YYKVStorageTypeFile;
+    else if (threshold == NSUIntegerMax) type = YYKVStorageTypeSQLite;
+    YYKVStorage *kv = [[YYKVStorage alloc] initWithPath:path type:type];
+    if (![kv setPragma:@"journal_mode" value:journal] ||
+        ![kv setPragma:@"synchronous" value:synchronous] ||
+        ![kv setPragma:@"mmap_size" value:@(mmap).description]) {
+        return nil;
+    }
+    return kv;
+}
+
+- (void)_addRecordWithScenario:(NSString *)scenario
+                       dataset:(NSString *)dataset
+                        engine:(NSString *)engine
+                       latency:(YYBenchmarkHistogram *)latency
+                       elapsed:(double)elapsed
+                     valueSize:(NSUInteger)valueSize
+                      settings:(NSDictionary *)settings
+                       metrics:(NSDictionary *)extra {
+    NSUInteger count = (NSUInteger)latency.count;
+    double throughput = elapsed > 0 ? count / elapsed : 0;
+    double bandwidth = throughput * valueSize / (1024 * 1024);
+    double p50 = [latency valueAtPercentile:50] / 1000.0;
+    double p99 = [latency valueAtPercentile:99] / 1000.0;
+
+    NSMutableDictionary *metrics = settings.mutableCopy;
+    metrics[@"ops_per_sec"] = @(throughput);
+    metrics[@"mb_per_sec"] = @(bandwidth);
+    metrics[@"mean_us"] = @(latency.mean / 1000.0);
+    metrics[@"p50_us"] = @(p50);
+    metrics[@"p99_us"] = @(p99);
+    metrics[@"max_us"] = @(latency.max / 1000.0);
+    [metrics addEntriesFromDictionary:extra];
+
+    YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+    record.suite = @"matrix";
+    record.scenario = scenario;
+    record.dataset = dataset;
+    record.engine = engine;
+    record.count = count;
+    record.time = elapsed * 1000;
+    record.metrics = metrics;
+    NSString *line = [NSString stringWithFormat:@"%-10s %-36s %10.0f ops/s %9.2f MB/s  p50 %9.2f  p99 %10.2f us",
+                      scenario.UTF8String, engine.UTF8String, throughput, bandwidth, p50, p99];
+    [_report addRecord:record line:line];
+}
+
+- (void)_runValueSize:(NSUInteger)valueSize
+            threshold:(NSUInteger)threshold
+              journal:(NSString *)journal
+          synchronous:(NSString *)synchronous
+                 mmap:(NSUInteger)mmap
+                value:(NSData *)value
+                 keys:(NSArray *)keys
+           randomKeys:(NSArray *)randomKeys {
+    NSString *thresholdName = [self.class nameForInlineThreshold:threshold];
+    NSString *engine = [NSString stringWithFormat:@"%@/%@/%@/mmap-%@", thresholdName, journal, synchronous, _YYDiskMatrixSizeName(mmap)];
+    NSString *dataset = [NSString stringWithFormat:@"NSData(%@)", _YYDiskMatrixSizeName(valueSize)];
+    NSString *path = [[_path stringByAppendingPathComponent:@"Matrix"] stringByAppendingPathComponent:[engine stringByReplacingOccurrencesOfString:@"/" withString:@"-"]];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+
+    NSDictionary *settings = @{@"value_size" : @(valueSize),
+                               @"inline_threshold" : @(threshold),
+                               @"inline" : @(threshold != 0 && valueSize <= threshold),
+                               @"journal_wal" : @([journal.lowercaseString isEqualToString:@"wal"]),
+                               @"synchronous_level" : @(_YYDiskMatrixSynchronousLevel(synchronous)),
+                               @"mmap_size" : @(mmap)};
+    BOOL inlined = [settings[@"inline"] boolValue];
+
+    YYKVStorage *kv = [self _openStorageAtPath:path threshold:threshold journal:journal synchronous:synchronous mmap:mmap];
+    if (!kv) {
+        fprintf(stderr, "skip %s: fail to open the storage or set the pragmas\n", engine.UTF8String);
+        return;
+    }
+    kv.errorLogsEnabled = NO;
+
+    // write
+    YYBenchmarkHistogram *latency = [YYBenchmarkHistogram new];
+    double begin = YYBenchmarkNow();
+    for (NSString *key in keys) {
+        @autoreleasepool {
+            uint64_t start = YYBenchmarkNowNanoseconds();
+            [kv saveItemWithKey:key value:value filename:(inlined ? nil : key) extendedData:nil];
+            [latency recordValue:YYBenchmarkNowNanoseconds() - start];
+        }
+    }
+    double elapsed = YYBenchmarkNow() - begin;
+    NSString *dbPath = [path stringByAppendingPathComponent:@"manifest.sqlite"];
+    unsigned long long dbBytes = _YYDiskMatrixFileSize(dbPath) + _YYDiskMatrixFileSize([dbPath stringByAppendingString:@"-wal"]);
+    unsigned long long fileBytes = _YYDiskMatrixDirectorySize([path stringByAppendingPathComponent:@"data"]);
+    [self _addRecordWithScenario:@"write" dataset:dataset engine:engine latency:latency elapsed:elapsed valueSize:valueSize settings:settings
+                         metrics:@{@"db_bytes" : @(dbBytes), @"file_bytes" : @(fileBytes)}];
+
+    // read in warm page cache
+    if (_warmCache) {
+        for (NSString *key in randomKeys) {
+            @autoreleasepool {
+                [kv getItemValueForKey:key];
+            }
+        }
+        [latency reset];
+        begin = YYBenchmarkNow();
+        for (NSString *key in randomKeys) {
+            @autoreleasepool {
+                uint64_t start = YYBenchmarkNowNanoseconds();
+                [kv getItemValueForKey:key];
+                [latency recordValue:YYBenchmarkNowNanoseconds() - start];
+            }
+        }
+        elapsed = YYBenchmarkNow() - begin;
+        [self _addRecordWithScenario:@"read-warm" dataset:dataset engine:engine latency:latency elapsed:elapsed valueSize:valueSize settings:settings metrics:nil];
+    }
+
+    // read in cold page cache, the storage is opened again so sqlite's own cache is cold too
+    if (_coldCache) {
+        @autoreleasepool {
+            kv = nil;
+        }
+        BOOL evicted = [self.class evictPageCacheAtPath:path];
+        if (!evicted && !_evictionWarned) {
+            _evictionWarned = YES;
+            fprintf(stderr, "warning: the page cache can not be dropped (purge requires root on Darwin), "
+                            "the read-cold records with \"evicted\" 0 are warm\n");
+        }
+        double openBegin = YYBenchmarkNow();
+        kv = [self _openStorageAtPath:path threshold:threshold journal:journal synchronous:synchronous mmap:mmap];
+        double openTime = YYBenchmarkNow() - openBegin;
+        if (kv) {
+            kv.errorLogsEnabled = NO;
+            [latency reset];
+            begin = YYBenchmarkNow();
+            for (NSString *key in randomKeys) {
+                @autoreleasepool {
+                    uint64_t start = YYBenchmarkNowNanoseconds();
+                    [kv getItemValueForKey:key];
+                    [latency recordValue:YYBenchmarkNowNanoseconds() - start];
+                }
+            }
+            elapsed = YYBenchmarkNow() - begin;
+            [self _addRecordWithScenario:@"read-cold" dataset:dataset engine:engine latency:latency elapsed:elapsed valueSize:valueSize settings:settings
+                                 metrics:@{@"evicted" : @(evicted), @"open_ms" : @(openTime * 1000)}];
+        }
+    }
+
+    @autoreleasepool {
+        kv = nil;
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+#pragma mark - public
+
+- (BOOL)run {
+    if (_valueSizes.count == 0 || _inlineThresholds.count == 0 || _journalModes.count == 0 ||
+        _synchronousModes.count == 0 || _mmapSizes.count == 0) {
+        fprintf(stderr, "empty matrix\n");
+        return NO;
+    }
+    for (NSNumber *size in _valueSizes) {
+        if (size.unsignedIntegerValue == 0 || size.unsignedIntegerValue >= INT_MAX) {
+            fprintf(stderr, "invalid value size: %s\n", size.description.UTF8String);
+            return NO;
+        }
+    }
+    if (_minCount == 0 || _maxCount < _minCount) {
+        fprintf(stderr, "invalid count bounds: %lu-%lu\n", (unsigned long)_minCount, (unsigned long)_maxCount);
+        return NO;
+    }
+
+    for (NSNumber *size in _valueSizes) {
+        @autoreleasepool {
+            NSUInteger valueSize = size.unsignedIntegerValue;
+            NSUInteger count = MIN(MAX(_cellBytes / valueSize, _minCount), _maxCount);
+            YYBenchmarkRandom random = YYBenchmarkRandomMake(_seed);
+            NSMutableData *value = [NSMutableData dataWithLength:valueSize];
+            uint8_t *bytes = value.mutableBytes;
+            for (NSUInteger i = 0; i < valueSize; i++) bytes[i] = (uint8_t)YYBenchmarkRandomNext(&random); // not compressible
+            NSMutableArray *keys = [NSMutableArray new];
+            for (NSUInteger i = 0; i < count; i++) {
+                [keys addObject:[NSString stringWithFormat:@"matrix-%lu", (unsigned long)i]];
+            }
+            NSMutableArray *randomKeys = keys.mutableCopy;
+            YYBenchmarkShuffle(randomKeys, &random);
+
+            [_report beginSection:[NSString stringWithFormat:@"Disk matrix, %lu values of %@",
+                                   (unsigned long)count, _YYDiskMatrixSizeName(valueSize)]];
+            for (NSNumber *threshold in _inlineThresholds) {
+                for (NSString *journal in _journalModes) {
+                    for (NSString *synchronous in _synchronousModes) {
+                        for (NSNumber *mmap in _mmapSizes) {
+                            @autoreleasepool {
+                                [self _runValueSize:valueSize
+                                          threshold:threshold.unsignedIntegerValue
+                                            journal:journal
+                                        synchronous:synchronous
+                                               mmap:mmap.unsignedIntegerValue
+                                              value:value
+                                               keys:keys
+                                         randomKeys:randomKeys];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return YES;
+}
+
+@end
@@ -0,0 +1,62 @@
+//
+//  YYMemoryOverheadBenchmark.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class YYBenchmarkReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The bytes each entry costs in a cache, besides its key and value: the node object,
+ the dictionary slot and so on for the memory caches, and the row and the file
+ system blocks for YYKVStorage.
+
+ @discussion Memory: the keys are created first and all entries share one value,
+ then the growth of the malloc bytes in use and of the RSS after writing `count`
+ entries is divided by `count`. "key_bytes_per_entry" is the size of a key, for
+ reference, and "leftover_bytes_per_entry" is what's still allocated after the cache
+ is emptied and released (which should be about 0). The RSS is coarser (pages, and
+ the allocator keeps freed pages), it's meaningful for large counts.
+
+ Disk: `count` values of each size are written to a new YYKVStorage in sqlite (the
+ values inline) and in files. After it's closed (the WAL checkpointed), the bytes of
+ the database and the files, in logical size and in allocated blocks, minus those of
+ an empty storage, are divided by `count`. "overhead_bytes_per_entry" is the
+ allocated bytes per entry minus the value size.
+ */
+@interface YYMemoryOverheadBenchmark : NSObject
+
+/** Entries of the memory caches. Default is 1000, 10000, 100000, 1000000. */
+@property (nonatomic, copy) NSArray<NSNumber *> *memoryCounts;
+
+/** Names of the memory engines. Default is NSDictionary, NSDict+Lock, YYMemoryCache, NSCache. */
+@property (nonatomic, copy) NSArray<NSString *> *engineNames;
+
+/** Entries of the storages. Default is 1000, 10000. */
+@property (nonatomic, copy) NSArray<NSNumber *> *diskCounts;
+
+/** Value sizes of the storages in bytes. Default is 100B, 1KB, 10KB. */
+@property (nonatomic, copy) NSArray<NSNumber *> *diskValueSizes;
+
+/** The directory of the storages, it's removed after each run. */
+@property (nonatomic, copy) NSString *path;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithReport:(YYBenchmarkReport *)report NS_DESIGNATED_INITIALIZER;
+
+/** Runs the memory engines, returns NO if the options are invalid. */
+- (BOOL)runMemoryBenchmark;
+
+/** Runs the storages, returns NO if the options are invalid. */
+- (BOOL)runDiskBenchmark;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,233 @@
+//
+//  YYMemoryOverheadBenchmark.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYMemoryOverheadBenchmark.h"
+#import "YYBenchmarkReport.h"
+#import "YYBenchmarkEngine.h"
+#import "YYBenchmarkUtil.h"
+#import "YYKVStorage.h"
+#import <sys/stat.h>
+
+/// Logical and allocated bytes of the regular files in the directory, recursively.
+static void _YYOverheadDiskUsage(NSString *path, uint64_t *logical, uint64_t *allocated) {
+    uint64_t logicalSum = 0, allocatedSum = 0;
+    NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager] enumeratorAtPath:path];
+    for (NSString *name in enumerator) {
+        struct stat st;
+        if (lstat([path stringByAppendingPathComponent:name].fileSystemRepresentation, &st) != 0) continue;
+        if (!S_ISREG(st.st_mode)) continue;
+        logicalSum += (uint64_t)st.st_size;
+        allocatedSum += (uint64_t)st.st_blocks * 512;
+    }
+    *logical = logicalSum;
+    *allocated = allocatedSum;
+}
+
+/// Waits for the release queue (the low priority global queue of YYMemoryCache) to free
+/// what the caches released asynchronously. A round trip through the queue runs after the
+/// blocks queued before it started, and a release may queue another one (a trim hops
+/// through the cache's own queue first), so it's repeated until two round trips change
+/// nothing.
+static void _YYOverheadSettle(void) {
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0);
+    uint64_t allocated = YYBenchmarkAllocatedBytes();
+    for (int i = 0, stable = 0; i < 100 && stable < 2; i++) {
+        dispatch_sync(queue, ^{});
+        uint64_t now = YYBenchmarkAllocatedBytes();
+        stable = now == allocated ? stable + 1 : 0;
+        allocated = now;
+    }
+}
+
+
+@implementation YYMemoryOverheadBenchmark {
+    YYBenchmarkReport *_report;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYMemoryOverheadBenchmark init error" reason:@"Use 'initWithReport:' instead." userInfo:nil];
+    return [self initWithReport:[YYBenchmarkReport new]];
+}
+
+- (instancetype)initWithReport:(YYBenchmarkReport *)report {
+    self = [super init];
+    _report = report;
+    _memoryCounts = @[@1000, @10000, @100000, @1000000];
+    _engineNames = @[@"NSDictionary", @"NSDict+Lock", @"YYMemoryCache", @"NSCache"];
+    _diskCounts = @[@1000, @10000];
+    _diskValueSizes = @[@100, @1024, @(10 * 1024)];
+    _path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YYCacheBenchmark"];
+    return self;
+}
+
+#pragma mark - memory
+
+- (void)_runEngineName:(NSString *)name count:(NSUInteger)count value:(NSData *)value {
+    int64_t allocBase = (int64_t)YYBenchmarkAllocatedBytes();
+    NSMutableArray *keys = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [keys addObject:[NSString stringWithFormat:@"key-%lu", (unsigned long)i]];
+    }
+    int64_t keyBytes = (int64_t)YYBenchmarkAllocatedBytes() - allocBase;
+
+    YYBenchmarkEngine *engine = [YYBenchmarkEngine engineWithName:name path:_path archive:NO];
+    _YYOverheadSettle();
+    int64_t allocBefore = (int64_t)YYBenchmarkAllocatedBytes();
+    int64_t rssBefore = (int64_t)YYBenchmarkResidentBytes();
+    double begin = YYBenchmarkNow();
+    for (NSString *key in keys) {
+        [engine setObject:value forKey:key];
+    }
+    double time = (YYBenchmarkNow() - begin) * 1000;
+    _YYOverheadSettle();
+    int64_t allocBytes = (int64_t)YYBenchmarkAllocatedBytes() - allocBefore;
+    int64_t rssBytes = (int64_t)YYBenchmarkResidentBytes() - rssBefore;
+
+    @autoreleasepool {
+        [engine removeAllObjects];
+        engine = nil;
+    }
+    _YYOverheadSettle();
+    int64_t leftoverBytes = (int64_t)YYBenchmarkAllocatedBytes() - allocBefore;
+
+    double perEntry = (double)allocBytes / count;
+    double rssPerEntry = (double)rssBytes / count;
+    YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+    record.suite = @"overhead";
+    record.scenario = @"memory";
+    record.dataset = [NSString stringWithFormat:@"%lu entries", (unsigned long)count];
+    record.engine = name;
+    record.count = count;
+    record.time = time;
+    record.metrics = @{@"alloc_bytes_per_entry" : @(perEntry),
+                       @"rss_bytes_per_entry" : @(rssPerEntry),
+                       @"key_bytes_per_entry" : @((double)keyBytes / count),
+                       @"leftover_bytes_per_entry" : @((double)leftoverBytes / count)};
+    NSString *line = [NSString stringWithFormat:@"%-15s %8lu entries: %8.1f B/entry allocated  %8.1f B/entry RSS  (key %.1f B, leftover %.1f B)",
+                      [name stringByAppendingString:@":"].UTF8String, (unsigned long)count, perEntry, rssPerEntry,
+                      (double)keyBytes / count, (double)leftoverBytes / count];
+    [_report addRecord:record line:line];
+}
+
+- (BOOL)runMemoryBenchmark {
+    NSMutableSet *memoryNames = [NSMutableSet new];
+    for (YYBenchmarkEngine *engine in [YYBenchmarkEngine memoryEngines]) {
+        [memoryNames addObject:engine.name];
+    }
+    for (NSString *name in _engineNames) {
+        if (![memoryNames containsObject:name]) {
+            fprintf(stderr, "unknown memory engine: %s\n", name.UTF8String);
+            return NO;
+        }
+    }
+    NSData *value = [NSData dataWithBytes:"0123456789abcdef" length:16]; // shared by all entries
+
+    for (NSNumber *count in _memoryCounts) {
+        if (count.unsignedIntegerValue == 0) continue;
+        [_report beginSection:[NSString stringWithFormat:@"Memory overhead of %@ entries (besides the keys and the shared value)", count]];
+        for (NSString *name in _engineNames) {
+            @autoreleasepool {
+                [self _runEngineName:name count:count.unsignedIntegerValue value:value];
+            }
+        }
+    }
+    return YES;
+}
+
+#pragma mark - disk
+
+/// Writes the items and closes the storage, returns the logical and allocated bytes of the storage.
+- (BOOL)_writeStorageAtPath:(NSString *)path
+                       type:(YYKVStorageType)type
+                      count:(NSUInteger)count
+                      value:(NSData *)value
+                    logical:(uint64_t *)logical
+                  allocated:(uint64_t *)allocated
+                       time:(double *)time {
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    @autoreleasepool {
+        YYKVStorage *kv = [[YYKVStorage alloc] initWithPath:path type:type];
+        if (!kv) return NO;
+        double begin = YYBenchmarkNow();
+        for (NSUInteger i = 0; i < count; i++) {
+            @autoreleasepool {
+                NSString *key = [NSString stringWithFormat:@"key-%lu", (unsigned long)i];
+                // YYDiskCache names a file with the 32 characters of the key's md5
+                NSString *filename = type == YYKVStorageTypeFile ? [NSString stringWithFormat:@"%032lx", (unsigned long)i] : nil;
+                [kv saveItemWithKey:key value:value filename:filename extendedData:nil];
+            }
+        }
+        if (time) *time = (YYBenchmarkNow() - begin) * 1000;
+        kv = nil; // close and checkpoint
+    }
+    _YYOverheadDiskUsage(path, logical, allocated);
+    return YES;
+}
+
+- (BOOL)runDiskBenchmark {
+    for (NSNumber *size in _diskValueSizes) {
+        if (size.unsignedIntegerValue == 0 || size.unsignedIntegerValue >= INT_MAX) {
+            fprintf(stderr, "invalid value size: %s\n", size.description.UTF8String);
+            return NO;
+        }
+    }
+    NSArray *types = @[@(YYKVStorageTypeSQLite), @(YYKVStorageTypeFile)];
+    NSArray *typeNames = @[@"YYKVSQLite", @"YYKVFile"];
+    NSString *root = [_path stringByAppendingPathComponent:@"Overhead"];
+
+    for (NSNumber *size in _diskValueSizes) {
+        NSMutableData *value = [NSMutableData dataWithLength:size.unsignedIntegerValue];
+        NSString *dataset = [NSString stringWithFormat:@"NSData(%@B)", size];
+        for (NSNumber *count in _diskCounts) {
+            NSUInteger n = count.unsignedIntegerValue;
+            if (n == 0) continue;
+            [_report beginSection:[NSString stringWithFormat:@"Disk overhead of %lu entries, value is %@", (unsigned long)n, dataset]];
+            for (NSUInteger t = 0; t < types.count; t++) {
+                @autoreleasepool {
+                    YYKVStorageType type = [types[t] unsignedIntegerValue];
+                    NSString *path = [root stringByAppendingPathComponent:typeNames[t]];
+                    uint64_t emptyLogical = 0, emptyAllocated = 0, logical = 0, allocated = 0;
+                    double time = 0;
+                    if (![self _writeStorageAtPath:path type:type count:0 value:value logical:&emptyLogical allocated:&emptyAllocated time:NULL] ||
+                        ![self _writeStorageAtPath:path type:type count:n value:value logical:&logical allocated:&allocated time:&time]) {
+                        fprintf(stderr, "skip %s: fail to open the storage\n", [typeNames[t] UTF8String]);
+                        continue;
+                    }
+                    uint64_t dbLogical = 0, dbAllocated = 0, fileLogical = 0, fileAllocated = 0;
+                    _YYOverheadDiskUsage([path stringByAppendingPathComponent:@"data"], &fileLogical, &fileAllocated);
+                    dbLogical = logical - fileLogical;
+                    dbAllocated = allocated - fileAllocated;
+                    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+
+                    double logicalPerEntry = (double)((int64_t)logical - (int64_t)emptyLogical) / n;
+                    double allocatedPerEntry = (double)((int64_t)allocated - (int64_t)emptyAllocated) / n;
+                    double overhead = allocatedPerEntry - size.doubleValue;
+                    YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+                    record.suite = @"overhead";
+                    record.scenario = @"disk";
+                    record.dataset = [NSString stringWithFormat:@"%@ x %lu", dataset, (unsigned long)n];
+                    record.engine = typeNames[t];
+                    record.count = n;
+                    record.time = time;
+                    record.metrics = @{@"bytes_per_entry" : @(logicalPerEntry),
+                                       @"allocated_bytes_per_entry" : @(allocatedPerEntry),
+                                       @"overhead_bytes_per_entry" : @(overhead),
+                                       @"db_bytes_per_entry" : @((double)((int64_t)dbLogical - (int64_t)emptyLogical) / n),
+                                       @"db_allocated_bytes_per_entry" : @((double)((int64_t)dbAllocated - (int64_t)emptyAllocated) / n),
+                                       @"file_allocated_bytes_per_entry" : @((double)fileAllocated / n)};
+                    NSString *line = [NSString stringWithFormat:@"%-15s %9.1f B/entry  %9.1f B/entry allocated  overhead %9.1f B/entry",
+                                      [typeNames[t] stringByAppendingString:@":"].UTF8String, logicalPerEntry, allocatedPerEntry, overhead];
+                    [_report addRecord:record line:line];
+                }
+            }
+        }
+    }
+    return YES;
+}
+
+@end
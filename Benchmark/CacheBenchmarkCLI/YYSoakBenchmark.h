@@ -0,0 +1,99 @@
+//
+//  YYSoakBenchmark.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class YYBenchmarkReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A long run of a mixed workload against a YYCache with limits, to find the slow
+ leaks and the unbounded growth which the short benchmarks miss: a WAL which is not
+ checkpointed, a trash which is never emptied, orphan files in `data/`, a backlog of
+ the release queue.
+
+ @discussion `threadCount` threads read, write and remove random keys for `duration`
+ seconds, the values are NSData of log-uniform random sizes. Every `sampleInterval`
+ seconds it records the RSS, the files and bytes in `data/` and `trash/`, the bytes
+ of `manifest.sqlite` and its WAL, and the totals of the memory and disk caches.
+
+ After `warmup`, a sample is flagged if:
+ - the memory or disk totals are above the limits by more than `tolerance`, or
+ - there are more files in `data/` than items in the disk cache (orphans), or
+ - the trash is not empty, or
+ - the WAL or the RSS is above `maxWALBytes` or `maxResidentBytes`,
+ in two samples in a row, as the caches trim and empty the trash asynchronously.
+ At the end, the growth per hour of the RSS, the files and the database in the
+ samples after `warmup` (a least squares fit) is flagged if it's above the limit.
+ */
+@interface YYSoakBenchmark : NSObject
+
+/** Seconds of the run. Default is 3600. */
+@property (nonatomic) NSTimeInterval duration;
+
+/** Seconds between the samples. Default is 60. */
+@property (nonatomic) NSTimeInterval sampleInterval;
+
+/** Seconds before the checks, when the caches fill up. Default is 0, a quarter of `duration`. */
+@property (nonatomic) NSTimeInterval warmup;
+
+/** Worker threads. Default is 4. */
+@property (nonatomic) NSUInteger threadCount;
+
+/** Percentages of "read:write:remove". Default is 70:25:5. */
+@property (nonatomic, copy) NSString *mix;
+
+/** The number of keys. Default is 50000, more than `diskCountLimit` to keep the eviction busy. */
+@property (nonatomic) NSUInteger keyCount;
+
+/** The range of the value sizes in bytes. Default is 100B to 100KB. */
+@property (nonatomic) NSUInteger minValueSize;
+@property (nonatomic) NSUInteger maxValueSize;
+
+/** Limits of the caches. Default is 5000 objects in memory, 20000 objects and 512MB on disk. */
+@property (nonatomic) NSUInteger memoryCountLimit;
+@property (nonatomic) NSUInteger diskCountLimit;
+@property (nonatomic) NSUInteger diskCostLimit;
+
+/** The relative overshoot of the limits to flag. Default is 0.25. */
+@property (nonatomic) double tolerance;
+
+/** Flag the WAL above this size. Default is 64MB. */
+@property (nonatomic) uint64_t maxWALBytes;
+
+/** Flag the RSS above this size, 0 for no limit. Default is 0. */
+@property (nonatomic) uint64_t maxResidentBytes;
+
+/** Flag the RSS growing faster than this, in bytes per hour. Default is 16MB. */
+@property (nonatomic) double maxResidentGrowth;
+
+/** Flag the files in `data/` growing faster than this, per hour. Default is 2% of `diskCountLimit`. */
+@property (nonatomic) double maxFileGrowth;
+
+/** Flag `manifest.sqlite` and the WAL growing faster than this, in bytes per hour. Default is 16MB. */
+@property (nonatomic) double maxDatabaseGrowth;
+
+/** The directory of the cache, it's removed before the run. */
+@property (nonatomic, copy) NSString *path;
+
+@property (nonatomic) uint64_t seed;
+
+/** The problems found by the last run, such as "sample 12: 305 orphan files in data/". */
+@property (nonatomic, readonly) NSArray<NSString *> *flags;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithReport:(YYBenchmarkReport *)report NS_DESIGNATED_INITIALIZER;
+
+/** Runs the workload, returns NO if the options are invalid. Check `flags` after it. */
+- (BOOL)run;
+
+@end
+
+NS_ASSUME_NONNULL_END
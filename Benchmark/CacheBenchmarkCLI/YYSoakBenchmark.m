@@ -0,0 +1,397 @@
+//
+//  YYSoakBenchmark.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYSoakBenchmark.h"
+#import "YYBenchmarkReport.h"
+#import "YYBenchmarkUtil.h"
+#import "YYContentionBenchmark.h"
+#import "YYCache.h"
+#import <stdatomic.h>
+#import <sys/stat.h>
+#import <math.h>
+
+/// Regular files and their bytes in the directory, recursively.
+static void _YYSoakDirectoryUsage(NSString *path, uint64_t *files, uint64_t *bytes) {
+    uint64_t fileCount = 0, byteCount = 0;
+    NSDirectoryEnumerator *enumerator = [[NSFileManager defaultManager] enumeratorAtPath:path];
+    for (NSString *name in enumerator) {
+        struct stat st;
+        if (lstat([path stringByAppendingPathComponent:name].fileSystemRepresentation, &st) != 0) continue;
+        if (!S_ISREG(st.st_mode)) continue;
+        fileCount++;
+        byteCount += (uint64_t)st.st_size;
+    }
+    *files = fileCount;
+    *bytes = byteCount;
+}
+
+static uint64_t _YYSoakFileSize(NSString *path) {
+    struct stat st;
+    if (stat(path.fileSystemRepresentation, &st) != 0) return 0;
+    return (uint64_t)st.st_size;
+}
+
+/// Least squares slope of the values over the times.
+static double _YYSoakSlope(NSArray<NSNumber *> *times, NSArray<NSNumber *> *values) {
+    NSUInteger n = MIN(times.count, values.count);
+    if (n < 2) return 0;
+    double meanTime = 0, meanValue = 0;
+    for (NSUInteger i = 0; i < n; i++) {
+        meanTime += times[i].doubleValue;
+        meanValue += values[i].doubleValue;
+    }
+    meanTime /= n;
+    meanValue /= n;
+    double covariance = 0, variance = 0;
+    for (NSUInteger i = 0; i < n; i++) {
+        double dt = times[i].doubleValue - meanTime;
+        covariance += dt * (values[i].doubleValue - meanValue);
+        variance += dt * dt;
+    }
+    return variance > 0 ? covariance / variance : 0;
+}
+
+/**
+ One thread of the workload.
+ Typically, you should not use this class directly.
+ */
+@interface _YYSoakWorker : NSObject {
+    @package
+    YYCache *_cache;
+    NSArray *_keys;
+    NSData *_buffer; ///< the values are copied from it
+    NSUInteger _minValueSize;
+    NSUInteger _maxValueSize;
+    int _read;  ///< percent
+    int _write; ///< percent
+    YYBenchmarkRandom _random;
+    atomic_bool *_stop;
+    atomic_ullong _operations;
+    dispatch_group_t _group;
+}
+- (void)run;
+@end
+
+@implementation _YYSoakWorker
+
+- (void)run {
+    uint32_t keyCount = (uint32_t)_keys.count;
+    double logMin = log((double)_minValueSize), logMax = log((double)_maxValueSize);
+    int readWrite = _read + _write;
+    while (!atomic_load_explicit(_stop, memory_order_relaxed)) {
+        @autoreleasepool {
+            for (int batch = 0; batch < 64; batch++) {
+                int op = (int)YYBenchmarkRandomUniform(&_random, 100);
+                NSString *key = _keys[YYBenchmarkRandomUniform(&_random, keyCount)];
+                if (op < _read) {
+                    [_cache objectForKey:key];
+                } else if (op < readWrite) {
+                    NSUInteger size = (NSUInteger)exp(logMin + YYBenchmarkRandomDouble(&_random) * (logMax - logMin));
+                    size = MIN(MAX(size, _minValueSize), _maxValueSize);
+                    [_cache setObject:[_buffer subdataWithRange:NSMakeRange(0, size)] forKey:key];
+                } else {
+                    [_cache removeObjectForKey:key];
+                }
+            }
+            atomic_fetch_add_explicit(&_operations, 64, memory_order_relaxed);
+        }
+    }
+    dispatch_group_leave(_group);
+}
+
+@end
+
+
+@implementation YYSoakBenchmark {
+    YYBenchmarkReport *_report;
+    NSMutableArray *_flags;
+    NSMutableSet *_previousProblems; ///< the checks failed in the last sample
+    NSMutableSet *_flaggedProblems;  ///< flagged once each
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYSoakBenchmark init error" reason:@"Use 'initWithReport:' instead." userInfo:nil];
+    return [self initWithReport:[YYBenchmarkReport new]];
+}
+
+- (instancetype)initWithReport:(YYBenchmarkReport *)report {
+    self = [super init];
+    _report = report;
+    _duration = 3600;
+    _sampleInterval = 60;
+    _warmup = 0;
+    _threadCount = 4;
+    _mix = @"70:25:5";
+    _keyCount = 50000;
+    _minValueSize = 100;
+    _maxValueSize = 100 * 1024;
+    _memoryCountLimit = 5000;
+    _diskCountLimit = 20000;
+    _diskCostLimit = 512 * 1024 * 1024;
+    _tolerance = 0.25;
+    _maxWALBytes = 64 * 1024 * 1024;
+    _maxResidentBytes = 0;
+    _maxResidentGrowth = 16 * 1024 * 1024;
+    _maxFileGrowth = 0;
+    _maxDatabaseGrowth = 16 * 1024 * 1024;
+    _path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YYCacheBenchmark"];
+    _seed = 1;
+    _flags = [NSMutableArray new];
+    return self;
+}
+
+- (NSArray *)flags {
+    return _flags.copy;
+}
+
+#pragma mark - private
+
+/// Flags the problem if it was also found in the previous sample.
+- (void)_foundProblem:(NSString *)name sample:(NSUInteger)index description:(NSString *)description {
+    if ([_previousProblems containsObject:name] && ![_flaggedProblems containsObject:name]) {
+        [_flaggedProblems addObject:name];
+        NSString *flag = [NSString stringWithFormat:@"sample %lu: %@", (unsigned long)index, description];
+        [_flags addObject:flag];
+        [_report log:@"FLAG %@", flag];
+    }
+}
+
+- (NSDictionary *)_sampleCache:(YYCache *)cache {
+    NSString *path = cache.diskCache.path;
+    uint64_t dataFiles = 0, dataBytes = 0, trashFiles = 0, trashBytes = 0;
+    _YYSoakDirectoryUsage([path stringByAppendingPathComponent:@"data"], &dataFiles, &dataBytes);
+    _YYSoakDirectoryUsage([path stringByAppendingPathComponent:@"trash"], &trashFiles, &trashBytes);
+    uint64_t dbBytes = _YYSoakFileSize([path stringByAppendingPathComponent:@"manifest.sqlite"]);
+    uint64_t walBytes = _YYSoakFileSize([path stringByAppendingPathComponent:@"manifest.sqlite-wal"]);
+    return @{@"rss_bytes" : @(YYBenchmarkResidentBytes()),
+             @"data_files" : @(dataFiles),
+             @"data_bytes" : @(dataBytes),
+             @"trash_files" : @(trashFiles),
+             @"trash_bytes" : @(trashBytes),
+             @"db_bytes" : @(dbBytes),
+             @"wal_bytes" : @(walBytes),
+             @"memory_count" : @(cache.memoryCache.totalCount),
+             @"disk_count" : @(cache.diskCache.totalCount),
+             @"disk_cost" : @(cache.diskCache.totalCost)};
+}
+
+- (void)_checkSample:(NSDictionary *)sample index:(NSUInteger)index {
+    NSMutableSet *found = [NSMutableSet new];
+    void (^check)(NSString *, BOOL, NSString *) = ^(NSString *name, BOOL failed, NSString *description) {
+        if (!failed) return;
+        [found addObject:name];
+        [self _foundProblem:name sample:index description:description];
+    };
+    double over = 1 + _tolerance;
+    unsigned long long memoryCount = [sample[@"memory_count"] unsignedLongLongValue];
+    unsigned long long diskCount = [sample[@"disk_count"] unsignedLongLongValue];
+    unsigned long long diskCost = [sample[@"disk_cost"] unsignedLongLongValue];
+    unsigned long long dataFiles = [sample[@"data_files"] unsignedLongLongValue];
+    unsigned long long trashFiles = [sample[@"trash_files"] unsignedLongLongValue];
+    unsigned long long walBytes = [sample[@"wal_bytes"] unsignedLongLongValue];
+    unsigned long long rssBytes = [sample[@"rss_bytes"] unsignedLongLongValue];
+
+    check(@"memory_count", memoryCount > _memoryCountLimit * over,
+          [NSString stringWithFormat:@"memory cache has %llu objects, the limit is %lu", memoryCount, (unsigned long)_memoryCountLimit]);
+    check(@"disk_count", diskCount > _diskCountLimit * over,
+          [NSString stringWithFormat:@"disk cache has %llu objects, the limit is %lu", diskCount, (unsigned long)_diskCountLimit]);
+    check(@"disk_cost", diskCost > _diskCostLimit * over,
+          [NSString stringWithFormat:@"disk cache has %llu bytes, the limit is %lu", diskCost, (unsigned long)_diskCostLimit]);
+    // every file belongs to an item, the workers may be between the file and the row
+    check(@"orphans", dataFiles > diskCount + _threadCount,
+          [NSString stringWithFormat:@"%llu orphan files in data/", dataFiles - diskCount]);
+    check(@"trash", trashFiles > 0,
+          [NSString stringWithFormat:@"%llu files left in trash/", trashFiles]);
+    check(@"wal", walBytes > _maxWALBytes,
+          [NSString stringWithFormat:@"WAL is %llu bytes, the limit is %llu", walBytes, (unsigned long long)_maxWALBytes]);
+    check(@"rss", _maxResidentBytes > 0 && rssBytes > _maxResidentBytes,
+          [NSString stringWithFormat:@"RSS is %llu bytes, the limit is %llu", rssBytes, (unsigned long long)_maxResidentBytes]);
+    _previousProblems = found;
+}
+
+- (void)_addSample:(NSDictionary *)sample index:(NSUInteger)index elapsed:(double)elapsed operations:(uint64_t)operations rate:(double)rate {
+    NSMutableDictionary *metrics = sample.mutableCopy;
+    metrics[@"elapsed_sec"] = @(elapsed);
+    metrics[@"ops_per_sec"] = @(rate);
+    YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+    record.suite = @"soak";
+    record.scenario = [NSString stringWithFormat:@"sample-%04lu", (unsigned long)index];
+    record.dataset = [NSString stringWithFormat:@"mix-%@", _mix];
+    record.engine = @"YYCache";
+    record.count = (NSUInteger)operations;
+    record.time = elapsed * 1000;
+    record.metrics = metrics;
+    NSString *line = [NSString stringWithFormat:@"%8.0fs %10.0f ops/s  rss %7.1fMB  data %7llu files %8.1fMB  db %7.1fMB  wal %6.1fMB  trash %5llu  memory %6llu  disk %7llu",
+                      elapsed, rate, [sample[@"rss_bytes"] doubleValue] / 1048576, [sample[@"data_files"] unsignedLongLongValue],
+                      [sample[@"data_bytes"] doubleValue] / 1048576, [sample[@"db_bytes"] doubleValue] / 1048576,
+                      [sample[@"wal_bytes"] doubleValue] / 1048576, [sample[@"trash_files"] unsignedLongLongValue],
+                      [sample[@"memory_count"] unsignedLongLongValue], [sample[@"disk_count"] unsignedLongLongValue]];
+    [_report addRecord:record line:line];
+}
+
+/// Fits the growth per hour of the samples after the warmup, and flags the fast ones.
+- (void)_checkGrowthOfSamples:(NSArray<NSDictionary *> *)samples times:(NSArray<NSNumber *> *)times totalOperations:(uint64_t)operations elapsed:(double)elapsed {
+    NSMutableArray *hours = [NSMutableArray new];
+    NSMutableArray *rss = [NSMutableArray new], *files = [NSMutableArray new], *db = [NSMutableArray new];
+    for (NSUInteger i = 0; i < samples.count; i++) {
+        [hours addObject:@(times[i].doubleValue / 3600)];
+        [rss addObject:samples[i][@"rss_bytes"]];
+        [files addObject:samples[i][@"data_files"]];
+        [db addObject:@([samples[i][@"db_bytes"] doubleValue] + [samples[i][@"wal_bytes"] doubleValue])];
+    }
+    double rssGrowth = _YYSoakSlope(hours, rss);
+    double fileGrowth = _YYSoakSlope(hours, files);
+    double dbGrowth = _YYSoakSlope(hours, db);
+    double maxFileGrowth = _maxFileGrowth > 0 ? _maxFileGrowth : _diskCountLimit * 0.02;
+
+    [_report beginSection:[NSString stringWithFormat:@"Soak growth per hour after the warmup, %lu samples", (unsigned long)samples.count]];
+    if (samples.count < 3) {
+        [_report log:@"not enough samples after the warmup to fit the growth"];
+    } else {
+        NSArray *growths = @[@[@"RSS", @(rssGrowth), @(_maxResidentGrowth)],
+                             @[@"data/ files", @(fileGrowth), @(maxFileGrowth)],
+                             @[@"database bytes", @(dbGrowth), @(_maxDatabaseGrowth)]];
+        for (NSArray *growth in growths) {
+            double value = [growth[1] doubleValue], limit = [growth[2] doubleValue];
+            [_report log:@"%-15s %+14.0f  (limit %.0f)", [growth[0] UTF8String], value, limit];
+            if (value > limit) {
+                NSString *flag = [NSString stringWithFormat:@"%@ grows %.0f per hour, the limit is %.0f", growth[0], value, limit];
+                [_flags addObject:flag];
+                [_report log:@"FLAG %@", flag];
+            }
+        }
+    }
+
+    YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+    record.suite = @"soak";
+    record.scenario = @"summary";
+    record.dataset = [NSString stringWithFormat:@"mix-%@", _mix];
+    record.engine = @"YYCache";
+    record.count = (NSUInteger)operations;
+    record.time = elapsed * 1000;
+    record.metrics = @{@"ops_per_sec" : @(elapsed > 0 ? operations / elapsed : 0),
+                       @"rss_growth_per_hour" : @(rssGrowth),
+                       @"data_files_growth_per_hour" : @(fileGrowth),
+                       @"db_growth_per_hour" : @(dbGrowth),
+                       @"flags" : @(_flags.count)};
+    [_report addRecord:record line:[NSString stringWithFormat:@"%lu flags", (unsigned long)_flags.count]];
+}
+
+#pragma mark - public
+
+- (BOOL)run {
+    int read = 0, write = 0, remove = 0;
+    if (![YYContentionBenchmark parseMix:_mix read:&read write:&write remove:&remove]) {
+        fprintf(stderr, "invalid mix: %s, should be read:write:remove with a sum of 100\n", _mix.UTF8String);
+        return NO;
+    }
+    if (_duration <= 0 || _sampleInterval <= 0 || _threadCount == 0 || _keyCount == 0 ||
+        _minValueSize == 0 || _maxValueSize < _minValueSize) {
+        fprintf(stderr, "invalid duration, sample interval, thread count, key count or value sizes\n");
+        return NO;
+    }
+    NSTimeInterval warmup = _warmup > 0 ? _warmup : _duration / 4;
+
+    NSString *path = [_path stringByAppendingPathComponent:@"Soak"];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    YYCache *cache = [[YYCache alloc] initWithPath:path];
+    if (!cache) {
+        fprintf(stderr, "fail to open the cache at %s\n", path.UTF8String);
+        return NO;
+    }
+    cache.memoryCache.countLimit = _memoryCountLimit;
+    cache.diskCache.countLimit = _diskCountLimit;
+    cache.diskCache.costLimit = _diskCostLimit;
+
+    NSMutableArray *keys = [NSMutableArray arrayWithCapacity:_keyCount];
+    for (NSUInteger i = 0; i < _keyCount; i++) {
+        [keys addObject:[NSString stringWithFormat:@"key-%lu", (unsigned long)i]];
+    }
+    NSMutableData *buffer = [NSMutableData dataWithLength:_maxValueSize];
+    YYBenchmarkRandom random = YYBenchmarkRandomMake(_seed);
+    uint8_t *bytes = buffer.mutableBytes;
+    for (NSUInteger i = 0; i < _maxValueSize; i++) bytes[i] = (uint8_t)YYBenchmarkRandomNext(&random);
+
+    [_flags removeAllObjects];
+    _previousProblems = [NSMutableSet new];
+    _flaggedProblems = [NSMutableSet new];
+    [_report beginSection:[NSString stringWithFormat:@"Soak %.0fs, %lu threads, read %d%% write %d%% remove %d%%, %lu keys, %lu-%luB, "
+                           @"limits memory %lu, disk %lu / %luMB, warmup %.0fs",
+                           _duration, (unsigned long)_threadCount, read, write, remove, (unsigned long)_keyCount,
+                           (unsigned long)_minValueSize, (unsigned long)_maxValueSize, (unsigned long)_memoryCountLimit,
+                           (unsigned long)_diskCountLimit, (unsigned long)(_diskCostLimit >> 20), warmup]];
+
+    atomic_bool stop;
+    atomic_init(&stop, false);
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *workers = [NSMutableArray new];
+    for (NSUInteger i = 0; i < _threadCount; i++) {
+        _YYSoakWorker *worker = [_YYSoakWorker new];
+        worker->_cache = cache;
+        worker->_keys = keys;
+        worker->_buffer = buffer;
+        worker->_minValueSize = _minValueSize;
+        worker->_maxValueSize = _maxValueSize;
+        worker->_read = read;
+        worker->_write = write;
+        worker->_random = YYBenchmarkRandomMake(_seed * 1000003 + i + 1);
+        worker->_stop = &stop;
+        atomic_init(&worker->_operations, 0);
+        worker->_group = group;
+        [workers addObject:worker];
+        dispatch_group_enter(group);
+        NSThread *thread = [[NSThread alloc] initWithTarget:worker selector:@selector(run) object:nil];
+        [thread start];
+    }
+
+    double begin = YYBenchmarkNow();
+    double lastTime = 0;
+    uint64_t lastOperations = 0;
+    NSUInteger index = 0;
+    NSMutableArray *steadySamples = [NSMutableArray new], *steadyTimes = [NSMutableArray new];
+    while (YES) {
+        double elapsed = YYBenchmarkNow() - begin;
+        if (elapsed >= _duration) break;
+        [NSThread sleepForTimeInterval:MIN(_sampleInterval * (index + 1) - elapsed, _duration - elapsed)];
+        @autoreleasepool {
+            elapsed = YYBenchmarkNow() - begin;
+            uint64_t operations = 0;
+            for (_YYSoakWorker *worker in workers) {
+                operations += atomic_load_explicit(&worker->_operations, memory_order_relaxed);
+            }
+            double rate = elapsed > lastTime ? (operations - lastOperations) / (elapsed - lastTime) : 0;
+            lastTime = elapsed;
+            lastOperations = operations;
+            NSDictionary *sample = [self _sampleCache:cache];
+            [self _addSample:sample index:index elapsed:elapsed operations:operations rate:rate];
+            if (elapsed >= warmup) {
+                [self _checkSample:sample index:index];
+                [steadySamples addObject:sample];
+                [steadyTimes addObject:@(elapsed)];
+            }
+            index++;
+        }
+    }
+    atomic_store(&stop, true);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    double elapsed = YYBenchmarkNow() - begin;
+    uint64_t operations = 0;
+    for (_YYSoakWorker *worker in workers) {
+        operations += atomic_load_explicit(&worker->_operations, memory_order_relaxed);
+    }
+    [self _checkGrowthOfSamples:steadySamples times:steadyTimes totalOperations:operations elapsed:elapsed];
+
+    for (NSString *flag in _flags) {
+        fprintf(stderr, "soak: %s\n", flag.UTF8String);
+    }
+    cache = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    return YES;
+}
+
+@end
@@ -0,0 +1,94 @@
+//
+//  YYTrace.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// One request of a trace.
+typedef struct {
+    uint64_t key;
+    uint32_t size; ///< bytes of the value
+} YYTraceRequest;
+
+/// The format of a trace file.
+typedef NS_ENUM(NSUInteger, YYTraceFileFormat) {
+    /// ARC traces (Megiddo & Modha): "start_block block_count ignored request_number",
+    /// each line is `block_count` requests of sequential blocks.
+    YYTraceFileFormatARC = 0,
+
+    /// LIRS traces (Jiang & Zhang): one block number each line.
+    YYTraceFileFormatLIRS,
+
+    /// "key [size]" each line, the key is any string without spaces.
+    YYTraceFileFormatKeys,
+
+    /// The binary file of `YYCacheTraceRecorder`. The gets of the outermost tier in
+    /// the file are the requests, in time order; the size of a key is the largest
+    /// size of its entries (sets included).
+    YYTraceFileFormatRecorder,
+};
+
+/// How to give sizes to the requests which have no size.
+typedef struct {
+    uint32_t min; ///< bytes
+    uint32_t max; ///< bytes, the size is log-uniform in [min, max] by the hash of the key
+} YYTraceSizeModel;
+
+/**
+ A sequence of requests, in memory, so it can be replayed many times.
+ */
+@interface YYTrace : NSObject
+
+@property (nonatomic, readonly) NSString *name;
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) const YYTraceRequest *requests;
+@property (nonatomic, readonly) NSUInteger uniqueKeyCount;  ///< footprint in objects
+@property (nonatomic, readonly) uint64_t uniqueBytes;       ///< footprint in bytes
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithName:(NSString *)name requests:(NSData *)requests NS_DESIGNATED_INITIALIZER; ///< YYTraceRequest array
+
+/** Zipfian popularity over `keyCount` keys, `alpha` is usually 0.6 to 1.2. */
++ (instancetype)zipfTraceWithCount:(NSUInteger)count keyCount:(NSUInteger)keyCount alpha:(double)alpha
+                         sizeModel:(YYTraceSizeModel)sizeModel seed:(uint64_t)seed;
+
+/**
+ Zipfian requests mixed with scans: each request starts a scan of `scanLength`
+ sequential keys which are never requested again with the `scanProbability`.
+ */
++ (instancetype)scanTraceWithCount:(NSUInteger)count keyCount:(NSUInteger)keyCount alpha:(double)alpha
+                        scanLength:(NSUInteger)scanLength scanProbability:(double)scanProbability
+                         sizeModel:(YYTraceSizeModel)sizeModel seed:(uint64_t)seed;
+
+/** Requests 0, 1, ... `loopLength - 1`, 0, 1, ... which is the worst case of LRU. */
++ (instancetype)loopTraceWithCount:(NSUInteger)count loopLength:(NSUInteger)loopLength
+                         sizeModel:(YYTraceSizeModel)sizeModel;
+
+/** Uniform random requests over `keyCount` keys. */
++ (instancetype)uniformTraceWithCount:(NSUInteger)count keyCount:(NSUInteger)keyCount
+                            sizeModel:(YYTraceSizeModel)sizeModel seed:(uint64_t)seed;
+
+/**
+ Reads a trace file, at most `limit` requests (0 means all).
+ The sizes in the file are used if there are, otherwise the `sizeModel` is used.
+ */
++ (nullable instancetype)traceWithContentsOfFile:(NSString *)path format:(YYTraceFileFormat)format
+                                       sizeModel:(YYTraceSizeModel)sizeModel limit:(NSUInteger)limit
+                                           error:(NSError **)error;
+
+/** "arc", "lirs", "keys", "yytrace", returns NO if unknown. */
++ (BOOL)parseFormat:(NSString *)string format:(YYTraceFileFormat *)format;
+
+/** The size of a key in the size model. */
++ (uint32_t)sizeForKey:(uint64_t)key model:(YYTraceSizeModel)model;
+
+@end
+
+NS_ASSUME_NONNULL_END
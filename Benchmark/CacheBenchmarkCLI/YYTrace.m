@@ -0,0 +1,316 @@
+//
+//  YYTrace.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYTrace.h"
+#import "YYBenchmarkUtil.h"
+#import "YYCacheTraceRecorder.h"
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <math.h>
+
+static const uint64_t kScanKeyBase = 1ULL << 62; ///< keys of scans, never collide with the popular keys
+
+/// splitmix64, mixes the bits of a key.
+static inline uint64_t _YYTraceMix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/// FNV-1a 64 of a string key.
+static inline uint64_t _YYTraceHash(const char *str, size_t length) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static int _YYTraceCompareKey(const void *a, const void *b) {
+    uint64_t ka = ((const YYTraceRequest *)a)->key, kb = ((const YYTraceRequest *)b)->key;
+    return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+/// A recorded entry with its position in the file, to sort by time stably.
+typedef struct {
+    YYCacheTraceEntry entry;
+    uint64_t index;
+} _YYTraceRecordedEntry;
+
+static int _YYTraceCompareTime(const void *a, const void *b) {
+    const _YYTraceRecordedEntry *ea = a, *eb = b;
+    if (ea->entry.time != eb->entry.time) return ea->entry.time < eb->entry.time ? -1 : 1;
+    return ea->index < eb->index ? -1 : (ea->index > eb->index ? 1 : 0);
+}
+
+/// Returns the largest size of a key in the sizes sorted by key, 0 if not found.
+static uint32_t _YYTraceFindSize(const YYTraceRequest *sizes, NSUInteger count, uint64_t key) {
+    NSUInteger lo = 0, hi = count;
+    while (lo < hi) {
+        NSUInteger mid = (lo + hi) / 2;
+        if (sizes[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t size = 0;
+    for (NSUInteger i = lo; i < count && sizes[i].key == key; i++) size = MAX(size, sizes[i].size);
+    return size;
+}
+
+/// Cumulative distribution of Zipf ranks, sampled with binary search.
+static double *_YYTraceZipfCreateCDF(NSUInteger keyCount, double alpha) {
+    double *cdf = malloc(sizeof(double) * keyCount);
+    double sum = 0;
+    for (NSUInteger i = 0; i < keyCount; i++) {
+        sum += 1.0 / pow((double)(i + 1), alpha);
+        cdf[i] = sum;
+    }
+    for (NSUInteger i = 0; i < keyCount; i++) cdf[i] /= sum;
+    return cdf;
+}
+
+static inline uint64_t _YYTraceZipfSample(const double *cdf, NSUInteger keyCount, YYBenchmarkRandom *random) {
+    double u = YYBenchmarkRandomDouble(random);
+    NSUInteger lo = 0, hi = keyCount - 1;
+    while (lo < hi) {
+        NSUInteger mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+@implementation YYTrace {
+    NSData *_data;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYTrace init error" reason:@"Use 'initWithName:requests:' instead." userInfo:nil];
+    return [self initWithName:@"" requests:[NSData data]];
+}
+
+- (instancetype)initWithName:(NSString *)name requests:(NSData *)requests {
+    self = [super init];
+    _name = name.copy;
+    _data = requests.copy;
+    _count = _data.length / sizeof(YYTraceRequest);
+    _requests = _data.bytes;
+
+    // footprint: sort a copy by key, and count each key once (with its largest size)
+    if (_count > 0) {
+        YYTraceRequest *sorted = malloc(sizeof(YYTraceRequest) * _count);
+        memcpy(sorted, _requests, sizeof(YYTraceRequest) * _count);
+        qsort(sorted, _count, sizeof(YYTraceRequest), _YYTraceCompareKey);
+        uint32_t size = sorted[0].size;
+        for (NSUInteger i = 1; i <= _count; i++) {
+            if (i == _count || sorted[i].key != sorted[i - 1].key) {
+                _uniqueKeyCount++;
+                _uniqueBytes += size;
+                if (i < _count) size = sorted[i].size;
+            } else if (sorted[i].size > size) {
+                size = sorted[i].size;
+            }
+        }
+        free(sorted);
+    }
+    return self;
+}
+
++ (uint32_t)sizeForKey:(uint64_t)key model:(YYTraceSizeModel)model {
+    uint32_t min = MAX(model.min, 1), max = MAX(model.max, min);
+    if (min == max) return min;
+    double u = (_YYTraceMix(key) >> 11) * (1.0 / 9007199254740992.0);
+    double size = exp(log((double)min) + u * (log((double)max) - log((double)min)));
+    return (uint32_t)MIN(MAX(size, min), max);
+}
+
++ (instancetype)zipfTraceWithCount:(NSUInteger)count keyCount:(NSUInteger)keyCount alpha:(double)alpha
+                         sizeModel:(YYTraceSizeModel)sizeModel seed:(uint64_t)seed {
+    return [self scanTraceWithCount:count keyCount:keyCount alpha:alpha scanLength:0 scanProbability:0 sizeModel:sizeModel seed:seed];
+}
+
++ (instancetype)scanTraceWithCount:(NSUInteger)count keyCount:(NSUInteger)keyCount alpha:(double)alpha
+                        scanLength:(NSUInteger)scanLength scanProbability:(double)scanProbability
+                         sizeModel:(YYTraceSizeModel)sizeModel seed:(uint64_t)seed {
+    keyCount = MAX(keyCount, 1);
+    YYBenchmarkRandom random = YYBenchmarkRandomMake(seed);
+    double *cdf = _YYTraceZipfCreateCDF(keyCount, alpha);
+    NSMutableData *data = [NSMutableData dataWithLength:sizeof(YYTraceRequest) * count];
+    YYTraceRequest *requests = data.mutableBytes;
+    uint64_t scanKey = kScanKeyBase;
+    NSUInteger scanRemain = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        uint64_t key;
+        if (scanRemain == 0 && scanLength > 0 && YYBenchmarkRandomDouble(&random) < scanProbability) {
+            scanRemain = scanLength;
+        }
+        if (scanRemain > 0) {
+            key = scanKey++;
+            scanRemain--;
+        } else {
+            key = _YYTraceZipfSample(cdf, keyCount, &random);
+        }
+        requests[i].key = key;
+        requests[i].size = [self sizeForKey:key model:sizeModel];
+    }
+    free(cdf);
+    NSString *name = scanLength > 0 ? [NSString stringWithFormat:@"scan(%.2f,%lu,%g)", alpha, (unsigned long)scanLength, scanProbability]
+                                    : [NSString stringWithFormat:@"zipf(%.2f)", alpha];
+    return [[self alloc] initWithName:name requests:data];
+}
+
++ (instancetype)loopTraceWithCount:(NSUInteger)count loopLength:(NSUInteger)loopLength
+                         sizeModel:(YYTraceSizeModel)sizeModel {
+    loopLength = MAX(loopLength, 1);
+    NSMutableData *data = [NSMutableData dataWithLength:sizeof(YYTraceRequest) * count];
+    YYTraceRequest *requests = data.mutableBytes;
+    for (NSUInteger i = 0; i < count; i++) {
+        requests[i].key = i % loopLength;
+        requests[i].size = [self sizeForKey:requests[i].key model:sizeModel];
+    }
+    return [[self alloc] initWithName:[NSString stringWithFormat:@"loop(%lu)", (unsigned long)loopLength] requests:data];
+}
+
++ (instancetype)uniformTraceWithCount:(NSUInteger)count keyCount:(NSUInteger)keyCount
+                            sizeModel:(YYTraceSizeModel)sizeModel seed:(uint64_t)seed {
+    keyCount = MAX(keyCount, 1);
+    YYBenchmarkRandom random = YYBenchmarkRandomMake(seed);
+    NSMutableData *data = [NSMutableData dataWithLength:sizeof(YYTraceRequest) * count];
+    YYTraceRequest *requests = data.mutableBytes;
+    for (NSUInteger i = 0; i < count; i++) {
+        requests[i].key = YYBenchmarkRandomUniform(&random, (uint32_t)MIN(keyCount, UINT32_MAX));
+        requests[i].size = [self sizeForKey:requests[i].key model:sizeModel];
+    }
+    return [[self alloc] initWithName:@"uniform" requests:data];
+}
+
++ (BOOL)parseFormat:(NSString *)string format:(YYTraceFileFormat *)format {
+    NSDictionary *formats = @{@"arc" : @(YYTraceFileFormatARC),
+                              @"lirs" : @(YYTraceFileFormatLIRS),
+                              @"keys" : @(YYTraceFileFormatKeys),
+                              @"yytrace" : @(YYTraceFileFormatRecorder)};
+    NSNumber *value = formats[string.lowercaseString];
+    if (!value) return NO;
+    if (format) *format = value.unsignedIntegerValue;
+    return YES;
+}
+
+/// Reads a file of YYCacheTraceRecorder.
++ (instancetype)_traceWithRecorderFile:(FILE *)file name:(NSString *)name sizeModel:(YYTraceSizeModel)sizeModel
+                                 limit:(NSUInteger)limit error:(NSError **)error {
+    YYCacheTraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, YYCacheTraceFileMagic, sizeof(header.magic)) != 0 ||
+        header.version != YYCacheTraceFileVersion || header.entrySize != sizeof(YYCacheTraceEntry)) {
+        if (error) *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSFilePathErrorKey : name}];
+        return nil;
+    }
+
+    NSMutableData *entryData = [NSMutableData new];
+    YYCacheTraceEntry buffer[1024];
+    size_t read;
+    uint8_t outerTier = UINT8_MAX;
+    while ((read = fread(buffer, sizeof(YYCacheTraceEntry), 1024, file)) > 0) {
+        for (size_t i = 0; i < read; i++) {
+            _YYTraceRecordedEntry recorded = {buffer[i], entryData.length / sizeof(_YYTraceRecordedEntry)};
+            [entryData appendBytes:&recorded length:sizeof(recorded)];
+            if (buffer[i].op == YYCacheTraceOperationGet) outerTier = MIN(outerTier, buffer[i].tier);
+        }
+    }
+    _YYTraceRecordedEntry *entries = entryData.mutableBytes;
+    NSUInteger entryCount = entryData.length / sizeof(_YYTraceRecordedEntry);
+    qsort(entries, entryCount, sizeof(_YYTraceRecordedEntry), _YYTraceCompareTime);
+
+    // the largest known size of each key, from all entries
+    NSMutableData *sizeData = [NSMutableData new];
+    for (NSUInteger i = 0; i < entryCount; i++) {
+        if (entries[i].entry.size == 0) continue;
+        YYTraceRequest size = {entries[i].entry.key, entries[i].entry.size};
+        [sizeData appendBytes:&size length:sizeof(size)];
+    }
+    NSUInteger sizeCount = sizeData.length / sizeof(YYTraceRequest);
+    qsort(sizeData.mutableBytes, sizeCount, sizeof(YYTraceRequest), _YYTraceCompareKey);
+
+    NSMutableData *data = [NSMutableData new];
+    for (NSUInteger i = 0; i < entryCount; i++) {
+        YYCacheTraceEntry entry = entries[i].entry;
+        if (entry.op != YYCacheTraceOperationGet || entry.tier != outerTier) continue;
+        YYTraceRequest request = {entry.key, _YYTraceFindSize(sizeData.bytes, sizeCount, entry.key)};
+        if (request.size == 0) request.size = [self sizeForKey:request.key model:sizeModel];
+        [data appendBytes:&request length:sizeof(request)];
+        if (limit && data.length / sizeof(request) >= limit) break;
+    }
+    if (header.sampleRate < 1) name = [NSString stringWithFormat:@"%@(%g)", name, header.sampleRate];
+    return [[self alloc] initWithName:name requests:data];
+}
+
++ (instancetype)traceWithContentsOfFile:(NSString *)path format:(YYTraceFileFormat)format
+                              sizeModel:(YYTraceSizeModel)sizeModel limit:(NSUInteger)limit
+                                  error:(NSError **)error {
+    if (format == YYTraceFileFormatRecorder) {
+        FILE *file = fopen(path.fileSystemRepresentation, "rb");
+        if (!file) {
+            if (error) *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey : path}];
+            return nil;
+        }
+        YYTrace *trace = [self _traceWithRecorderFile:file name:path.lastPathComponent sizeModel:sizeModel limit:limit error:error];
+        fclose(file);
+        return trace;
+    }
+    FILE *file = fopen(path.fileSystemRepresentation, "r");
+    if (!file) {
+        if (error) *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey : path}];
+        return nil;
+    }
+    NSMutableData *data = [NSMutableData new];
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    BOOL full = NO;
+    while (!full && (length = getline(&line, &capacity, file)) > 0) {
+        YYTraceRequest request = {0, 0};
+        if (format == YYTraceFileFormatARC) {
+            unsigned long long start = 0, blocks = 0;
+            if (sscanf(line, "%llu %llu", &start, &blocks) != 2) continue;
+            for (unsigned long long i = 0; i < blocks; i++) {
+                request.key = start + i;
+                request.size = [self sizeForKey:request.key model:sizeModel];
+                [data appendBytes:&request length:sizeof(request)];
+                if (limit && data.length / sizeof(request) >= limit) {
+                    full = YES;
+                    break;
+                }
+            }
+            continue;
+        } else if (format == YYTraceFileFormatLIRS) {
+            unsigned long long block = 0;
+            if (sscanf(line, "%llu", &block) != 1) continue; // such as "*" separators
+            request.key = block;
+            request.size = [self sizeForKey:request.key model:sizeModel];
+        } else {
+            char *end = line + length;
+            while (end > line && (end[-1] == '\n' || end[-1] == '\r')) end--;
+            char *space = memchr(line, ' ', end - line);
+            if (!space) space = memchr(line, '\t', end - line);
+            size_t keyLength = space ? (size_t)(space - line) : (size_t)(end - line);
+            if (keyLength == 0) continue;
+            request.key = _YYTraceHash(line, keyLength);
+            long long size = space ? strtoll(space + 1, NULL, 10) : 0;
+            request.size = size > 0 ? (uint32_t)MIN(size, UINT32_MAX) : [self sizeForKey:request.key model:sizeModel];
+        }
+        [data appendBytes:&request length:sizeof(request)];
+        if (limit && data.length / sizeof(request) >= limit) full = YES;
+    }
+    free(line);
+    fclose(file);
+    return [[self alloc] initWithName:path.lastPathComponent requests:data];
+}
+
+@end
@@ -0,0 +1,74 @@
+//
+//  YYTraceSimulator.h
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class YYTrace, YYBenchmarkReport;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// What the capacities limit.
+typedef NS_ENUM(NSUInteger, YYTraceLimitType) {
+    YYTraceLimitTypeCount = 0, ///< `countLimit`, objects
+    YYTraceLimitTypeCost,      ///< `costLimit`, bytes
+};
+
+/**
+ Replays traces through the eviction of the caches, to choose the limits from data.
+
+ @discussion Each request is a read, and a miss writes the object (demand fill).
+ The policies are:
+
+     memory-lru  YYMemoryCache, trimmed with `trimToCount:` / `trimToCost:` after a write.
+     disk-lru    YYKVStorage (sqlite), trimmed with `removeItemsToFitCount:` /
+                 `removeItemsToFitSize:` every `trimInterval` writes, as YYDiskCache's
+                 trim does, so the storage may be a little over the capacity.
+     disk-gdsf   the same with YYKVStorageEvictionPolicyGDSF.
+
+ The storages use a virtual clock (one tick per request), see `YYKVStorage.timeBlock`.
+ It reports the hit ratio, byte hit ratio and requests per second of each policy
+ and each capacity.
+ */
+@interface YYTraceSimulator : NSObject
+
+/** Default is memory-lru, disk-lru, disk-gdsf. */
+@property (nonatomic, copy) NSArray<NSString *> *policies;
+
+/**
+ The capacities, a percentage of the trace's footprint ("5%"), a count ("1000") or a
+ byte size ("10MB") for `YYTraceLimitTypeCost`. Default is 1%, 5%, 10%, 25%, 50%.
+ */
+@property (nonatomic, copy) NSArray<NSString *> *capacities;
+
+/** Default is YYTraceLimitTypeCount. */
+@property (nonatomic) YYTraceLimitType limitType;
+
+/** The disk storages are trimmed every N writes. Default is 100. */
+@property (nonatomic) NSUInteger trimInterval;
+
+/**
+ The disk storages write `size / diskScale` bytes for each object (the cost limits are
+ scaled the same), to replay large objects faster. Default is 1.
+ */
+@property (nonatomic) NSUInteger diskScale;
+
+/** The directory of the disk storages. */
+@property (nonatomic, copy) NSString *path;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithReport:(YYBenchmarkReport *)report NS_DESIGNATED_INITIALIZER;
+
++ (NSArray<NSString *> *)policyNames;
+
+/** Replays the trace with each policy and capacity, returns NO if the options are invalid. */
+- (BOOL)runTrace:(YYTrace *)trace;
+
+@end
+
+NS_ASSUME_NONNULL_END
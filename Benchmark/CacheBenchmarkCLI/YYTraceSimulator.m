@@ -0,0 +1,218 @@
+//
+//  YYTraceSimulator.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import "YYTraceSimulator.h"
+#import "YYTrace.h"
+#import "YYBenchmarkReport.h"
+#import "YYBenchmarkOptions.h"
+#import "YYBenchmarkUtil.h"
+#import "YYMemoryCache.h"
+#import "YYKVStorage.h"
+
+/// The result of one replay.
+typedef struct {
+    uint64_t hits;
+    uint64_t hitBytes;
+    uint64_t bytes;
+    double time; ///< seconds
+} _YYTraceResult;
+
+@implementation YYTraceSimulator {
+    YYBenchmarkReport *_report;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYTraceSimulator init error" reason:@"Use 'initWithReport:' instead." userInfo:nil];
+    return [self initWithReport:[YYBenchmarkReport new]];
+}
+
+- (instancetype)initWithReport:(YYBenchmarkReport *)report {
+    self = [super init];
+    _report = report;
+    _policies = [self.class policyNames];
+    _capacities = @[@"1%", @"5%", @"10%", @"25%", @"50%"];
+    _limitType = YYTraceLimitTypeCount;
+    _trimInterval = 100;
+    _diskScale = 1;
+    _path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YYCacheBenchmark"];
+    return self;
+}
+
++ (NSArray *)policyNames {
+    return @[@"memory-lru", @"disk-lru", @"disk-gdsf"];
+}
+
+#pragma mark - private
+
+/// Returns the capacity in objects or bytes, 0 if invalid.
+- (uint64_t)_capacityWithString:(NSString *)string trace:(YYTrace *)trace {
+    uint64_t footprint = _limitType == YYTraceLimitTypeCount ? trace.uniqueKeyCount : trace.uniqueBytes;
+    if ([string hasSuffix:@"%"]) {
+        double percent = [string substringToIndex:string.length - 1].doubleValue;
+        if (percent <= 0) return 0;
+        return MAX((uint64_t)(footprint * percent / 100.0), 1);
+    }
+    if (_limitType == YYTraceLimitTypeCount) {
+        long long count = string.longLongValue;
+        return count > 0 ? (uint64_t)count : 0;
+    }
+    long long size = [YYBenchmarkOptions byteSizeFromString:string];
+    return size > 0 ? (uint64_t)size : 0;
+}
+
+- (_YYTraceResult)_replayMemory:(YYTrace *)trace capacity:(uint64_t)capacity {
+    _YYTraceResult result = {0};
+    YYMemoryCache *cache = [YYMemoryCache new];
+    cache.autoTrimInterval = 0; // trimmed by the replay
+    cache.shouldRemoveAllObjectsOnMemoryWarning = NO;
+    cache.shouldRemoveAllObjectsWhenEnteringBackground = NO;
+    id value = [NSNull null]; // the cost is the size, the object is not needed
+    BOOL byCount = _limitType == YYTraceLimitTypeCount;
+    NSUInteger limit = (NSUInteger)MIN(capacity, (uint64_t)NSUIntegerMax);
+
+    const YYTraceRequest *requests = trace.requests;
+    NSUInteger count = trace.count;
+    double begin = YYBenchmarkNow();
+    for (NSUInteger i = 0; i < count; i++) {
+        @autoreleasepool {
+            YYTraceRequest request = requests[i];
+            NSNumber *key = @(request.key);
+            result.bytes += request.size;
+            if ([cache objectForKey:key]) {
+                result.hits++;
+                result.hitBytes += request.size;
+            } else {
+                [cache setObject:value forKey:key withCost:request.size];
+                if (byCount) {
+                    if (cache.totalCount > limit) [cache trimToCount:limit];
+                } else {
+                    if (cache.totalCost > limit) [cache trimToCost:limit];
+                }
+            }
+        }
+    }
+    result.time = YYBenchmarkNow() - begin;
+    return result;
+}
+
+- (_YYTraceResult)_replayDisk:(YYTrace *)trace capacity:(uint64_t)capacity policy:(YYKVStorageEvictionPolicy)policy path:(NSString *)path {
+    _YYTraceResult result = {0};
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    YYKVStorage *kv = [[YYKVStorage alloc] initWithPath:path type:YYKVStorageTypeSQLite];
+    if (!kv) return result;
+    kv.evictionPolicy = policy;
+    __block int tick = 1;
+    kv.timeBlock = ^{ return tick; };
+
+    NSUInteger scale = MAX(_diskScale, 1);
+    BOOL byCount = _limitType == YYTraceLimitTypeCount;
+    int limit = (int)MIN(byCount ? capacity : MAX(capacity / scale, 1), (uint64_t)INT_MAX - 1);
+    uint32_t maxSize = 1;
+    for (NSUInteger i = 0; i < trace.count; i++) maxSize = MAX(maxSize, trace.requests[i].size);
+    NSMutableData *buffer = [NSMutableData dataWithLength:maxSize / scale + 1];
+
+    const YYTraceRequest *requests = trace.requests;
+    NSUInteger count = trace.count;
+    NSUInteger writes = 0;
+    NSUInteger trimInterval = MAX(_trimInterval, 1);
+    double begin = YYBenchmarkNow();
+    for (NSUInteger i = 0; i < count; i++) {
+        @autoreleasepool {
+            YYTraceRequest request = requests[i];
+            tick++;
+            NSString *key = [NSString stringWithFormat:@"%llx", (unsigned long long)request.key];
+            result.bytes += request.size;
+            if ([kv getItemValueForKey:key]) {
+                result.hits++;
+                result.hitBytes += request.size;
+            } else {
+                NSUInteger length = MAX(request.size / scale, 1);
+                NSData *value = [NSData dataWithBytesNoCopy:buffer.mutableBytes length:length freeWhenDone:NO];
+                [kv saveItemWithKey:key value:value];
+                if (++writes % trimInterval == 0) {
+                    if (byCount) [kv removeItemsToFitCount:limit];
+                    else [kv removeItemsToFitSize:limit];
+                }
+            }
+        }
+    }
+    result.time = YYBenchmarkNow() - begin;
+    kv = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    return result;
+}
+
+#pragma mark - public
+
+- (BOOL)runTrace:(YYTrace *)trace {
+    for (NSString *policy in _policies) {
+        if (![[self.class policyNames] containsObject:policy]) {
+            fprintf(stderr, "unknown policy: %s\n", policy.UTF8String);
+            return NO;
+        }
+    }
+    NSMutableArray *capacities = [NSMutableArray new];
+    for (NSString *string in _capacities) {
+        uint64_t capacity = [self _capacityWithString:string trace:trace];
+        if (capacity == 0) {
+            fprintf(stderr, "invalid capacity: %s\n", string.UTF8String);
+            return NO;
+        }
+        [capacities addObject:@(capacity)];
+    }
+    if (trace.count == 0) {
+        fprintf(stderr, "empty trace: %s\n", trace.name.UTF8String);
+        return NO;
+    }
+
+    BOOL byCount = _limitType == YYTraceLimitTypeCount;
+    [_report beginSection:[NSString stringWithFormat:@"Trace %@: %lu requests, %lu keys, %.2fMB footprint, limit by %@",
+                           trace.name, (unsigned long)trace.count, (unsigned long)trace.uniqueKeyCount,
+                           trace.uniqueBytes / 1024.0 / 1024.0, byCount ? @"count" : @"cost"]];
+
+    for (NSString *policy in _policies) {
+        for (NSUInteger i = 0; i < capacities.count; i++) {
+            @autoreleasepool {
+                uint64_t capacity = [capacities[i] unsignedLongLongValue];
+                _YYTraceResult result;
+                if ([policy isEqualToString:@"memory-lru"]) {
+                    result = [self _replayMemory:trace capacity:capacity];
+                } else {
+                    YYKVStorageEvictionPolicy evictionPolicy = [policy isEqualToString:@"disk-gdsf"] ? YYKVStorageEvictionPolicyGDSF : YYKVStorageEvictionPolicyLRU;
+                    NSString *path = [[_path stringByAppendingPathComponent:@"Trace"] stringByAppendingPathComponent:policy];
+                    result = [self _replayDisk:trace capacity:capacity policy:evictionPolicy path:path];
+                }
+
+                double hitRatio = (double)result.hits / trace.count;
+                double byteHitRatio = result.bytes ? (double)result.hitBytes / result.bytes : 0;
+                double throughput = result.time > 0 ? trace.count / result.time : 0;
+                NSString *capacityName = byCount ? [NSString stringWithFormat:@"%llu", (unsigned long long)capacity]
+                                                 : [NSString stringWithFormat:@"%.2fMB", capacity / 1024.0 / 1024.0];
+
+                YYBenchmarkRecord *record = [YYBenchmarkRecord new];
+                record.suite = @"trace";
+                record.scenario = trace.name;
+                record.dataset = [NSString stringWithFormat:@"%@-%@", byCount ? @"count" : @"cost", _capacities[i]];
+                record.engine = policy;
+                record.count = trace.count;
+                record.time = result.time * 1000;
+                record.metrics = @{@"capacity" : @(capacity),
+                                   @"hit_ratio" : @(hitRatio),
+                                   @"byte_hit_ratio" : @(byteHitRatio),
+                                   @"ops_per_sec" : @(throughput)};
+                NSString *line = [NSString stringWithFormat:@"%-11s %6s %12s  hit %6.2f%%  byte hit %6.2f%%  %11.0f ops/s",
+                                  policy.UTF8String, [_capacities[i] UTF8String], capacityName.UTF8String,
+                                  hitRatio * 100, byteHitRatio * 100, throughput];
+                [_report addRecord:record line:line];
+            }
+        }
+    }
+    return YES;
+}
+
+@end
@@ -0,0 +1,591 @@
+//
+//  main.m
+//  CacheBenchmarkCLI
+//
+//  Created by agent on 26/10/18.
+//  Copyright (C) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "YYBenchmarkOptions.h"
+#import "YYBenchmarkReport.h"
+#import "YYBenchmarkCompare.h"
+#import "YYCacheBenchmark.h"
+#import "YYContentionBenchmark.h"
+#import "YYDiskMatrixBenchmark.h"
+#import "YYMemoryOverheadBenchmark.h"
+#import "YYSoakBenchmark.h"
+#import "YYTrace.h"
+#import "YYTraceSimulator.h"
+#import "YYCacheMetrics.h"
+
+static void _YYBenchmarkPrintUsage(void) {
+    printf("usage: yycache-bench [command] [options]\n"
+           "\n"
+           "commands:\n"
+           "  run                      memory and disk scenarios of Benchmark.m (default)\n"
+           "  contention               multi-threaded throughput, latency and lock wait\n"
+           "  trace                    replay traces through the eviction, hit ratio per policy and capacity\n"
+           "  matrix                   disk storage: value size x inline threshold x pragmas x page cache\n"
+           "  overhead                 bytes per entry of the memory caches and the storages\n"
+           "  soak                     hours of a mixed workload, flags the growth of RSS, files and database\n"
+           "  compare BASELINE CURRENT compare two JSON files written with --json\n"
+           "\n"
+           "run options:\n"
+           "  --suite memory|disk|all  default: all\n"
+           "  --memory-count N         memory cache key-value pairs, default: 200000\n"
+           "  --disk-count N           disk cache key-value pairs, default: 1000\n"
+           "  --large-size SIZE        large disk value size, such as 100KB, default: 100KB\n"
+           "  --path DIR               directory of the disk caches, default: $TMPDIR/YYCacheBenchmark\n"
+           "  --seed N                 seed of the random orders, default: 1\n"
+           "\n"
+           "contention options:\n"
+           "  --threads LIST           thread counts, default: 1,2,4,8,16,32,64\n"
+           "  --mixes LIST             read:write:remove percentages, default: 90:10:0,50:50:0,70:20:10\n"
+           "  --engines LIST           default: NSDict+Lock,YYMemoryCache,YYDiskCache\n"
+           "  --duration SECONDS       time of each run, default: 1\n"
+           "  --keys N                 number of keys, default: 10000\n"
+           "  --value-size SIZE        default: 100B\n"
+           "  --lock-profile           measure the contention of the YYMemoryCache/YYDiskCache lock\n"
+           "  --path DIR, --seed N\n"
+           "\n"
+           "trace options:\n"
+           "  --traces LIST            zipf,scan,loop,uniform, default: zipf,scan,loop\n"
+           "  --trace-file FILE        replay a file instead, with --trace-format arc|lirs|keys|yytrace\n"
+           "                           (yytrace: written by YYCacheTraceRecorder)\n"
+           "  --requests N             requests of each trace (or the limit of the file), default: 200000\n"
+           "  --keys N                 keys of zipf/scan/uniform, default: 20000\n"
+           "  --alpha X                zipf skew, default: 0.99\n"
+           "  --scan-length N          keys of each scan, default: 1000\n"
+           "  --scan-probability X     probability to start a scan each request, default: 0.0005\n"
+           "  --loop-length N          keys of the loop, default: 5000\n"
+           "  --size-range MIN-MAX     object sizes if not in the trace, log-uniform, default: 100B-100KB\n"
+           "  --policies LIST          memory-lru,disk-lru,disk-gdsf (default: all)\n"
+           "  --capacities LIST        percentages of the footprint, counts or sizes, default: 1%%,5%%,10%%,25%%,50%%\n"
+           "  --limit count|cost       what the capacities limit, default: count\n"
+           "  --trim-interval N        trim the disk storage every N writes, default: 100\n"
+           "  --disk-scale N           write size/N bytes to disk, to replay faster, default: 1\n"
+           "  --path DIR, --seed N\n"
+           "\n"
+           "matrix options:\n"
+           "  --value-sizes LIST       default: 100B,1KB,10KB,100KB,1MB,10MB\n"
+           "  --inline-thresholds LIST file (all in files), sqlite (all in sqlite) or sizes,\n"
+           "                           default: file,4KB,20KB,100KB,sqlite\n"
+           "  --journal-modes LIST     default: wal,delete\n"
+           "  --synchronous LIST       default: normal,full\n"
+           "  --mmap-sizes LIST        default: 0,256MB\n"
+           "  --page-cache LIST        warm,cold, default: warm,cold\n"
+           "  --cell-size SIZE         bytes to write in each cell, default: 16MB\n"
+           "  --min-count N            default: 5\n"
+           "  --max-count N            values in each cell, default: 2000\n"
+           "  --path DIR, --seed N\n"
+           "\n"
+           "overhead options:\n"
+           "  --suite memory|disk|all  default: all\n"
+           "  --counts LIST            memory cache entries, default: 1000,10000,100000,1000000\n"
+           "  --engines LIST           default: NSDictionary,NSDict+Lock,YYMemoryCache,NSCache\n"
+           "  --disk-counts LIST       storage entries, default: 1000,10000\n"
+           "  --value-sizes LIST       storage value sizes, default: 100B,1KB,10KB\n"
+           "  --path DIR\n"
+           "\n"
+           "soak options:\n"
+           "  --duration SECONDS       default: 3600\n"
+           "  --interval SECONDS       between the samples, default: 60\n"
+           "  --warmup SECONDS         before the checks, default: a quarter of the duration\n"
+           "  --threads N              default: 4\n"
+           "  --mix R:W:D              read:write:remove percentages, default: 70:25:5\n"
+           "  --keys N                 default: 50000\n"
+           "  --size-range MIN-MAX     value sizes, log-uniform, default: 100B-100KB\n"
+           "  --memory-count-limit N   default: 5000\n"
+           "  --disk-count-limit N     default: 20000\n"
+           "  --disk-cost-limit SIZE   default: 512MB\n"
+           "  --tolerance X            overshoot of the limits to flag, default: 0.25\n"
+           "  --max-wal SIZE           default: 64MB\n"
+           "  --max-rss SIZE           default: no limit\n"
+           "  --max-rss-growth SIZE    per hour, default: 16MB\n"
+           "  --max-file-growth N      data/ files per hour, default: 2%% of the disk count limit\n"
+           "  --max-db-growth SIZE     manifest.sqlite and WAL per hour, default: 16MB\n"
+           "  --path DIR, --seed N     exit 3 if anything is flagged\n"
+           "\n"
+           "regression options (with --baseline, or the compare command):\n"
+           "  --baseline FILE          compare with the JSON of an earlier run, exit 3 on a regression,\n"
+           "                           needs --repeat 2 or more\n"
+           "  --threshold X            relative change to fail at, default: 0.05 (5%%)\n"
+           "  --significance X         p-value of a significant change, default: 0.05\n"
+           "  --metrics LIST           time_ms or record metrics, default: ops_per_sec if any, else time_ms\n"
+           "\n"
+           "common options:\n"
+           "  --json FILE              write the records as JSON, '-' for stdout\n"
+           "  --csv FILE               write the records as CSV, '-' for stdout\n"
+           "  --label NAME             machine class stored in the JSON, such as c5.xlarge\n"
+           "  --repeat N               run the command N times, the samples of the comparison, default: 1\n"
+           "  --quiet                  do not print the progress\n"
+           "  --help\n");
+}
+
+static int _YYBenchmarkRun(YYBenchmarkOptions *options, YYBenchmarkReport *report) {
+    NSString *suite = [options stringForOption:@"suite" defaultValue:@"all"];
+    if (![@[@"memory", @"disk", @"all"] containsObject:suite]) {
+        fprintf(stderr, "unknown suite: %s\n", suite.UTF8String);
+        return 2;
+    }
+    YYCacheBenchmark *benchmark = [[YYCacheBenchmark alloc] initWithReport:report];
+    benchmark.memoryCount = (NSUInteger)MAX([options integerForOption:@"memory-count" defaultValue:benchmark.memoryCount], 1);
+    benchmark.diskCount = (NSUInteger)MAX([options integerForOption:@"disk-count" defaultValue:benchmark.diskCount], 1);
+    NSString *largeSize = [options stringForOption:@"large-size"];
+    if (largeSize) {
+        long long size = [YYBenchmarkOptions byteSizeFromString:largeSize];
+        if (size <= 0) {
+            fprintf(stderr, "invalid size: %s\n", largeSize.UTF8String);
+            return 2;
+        }
+        benchmark.largeValueSize = (NSUInteger)size;
+    }
+    benchmark.path = [options stringForOption:@"path" defaultValue:benchmark.path];
+    benchmark.seed = (uint64_t)[options integerForOption:@"seed" defaultValue:(long long)benchmark.seed];
+
+    if ([suite isEqualToString:@"memory"] || [suite isEqualToString:@"all"]) {
+        @autoreleasepool {
+            [benchmark runMemoryBenchmark];
+        }
+    }
+    if ([suite isEqualToString:@"disk"] || [suite isEqualToString:@"all"]) {
+        @autoreleasepool {
+            [benchmark runDiskBenchmark];
+        }
+    }
+    return 0;
+}
+
+static int _YYBenchmarkContention(YYBenchmarkOptions *options, YYBenchmarkReport *report) {
+    YYContentionBenchmark *benchmark = [[YYContentionBenchmark alloc] initWithReport:report];
+    NSMutableArray *threadCounts = [NSMutableArray new];
+    for (NSString *threads in [options listForOption:@"threads" defaultValue:@[]]) {
+        [threadCounts addObject:@(threads.integerValue)];
+    }
+    if (threadCounts.count) benchmark.threadCounts = threadCounts;
+    benchmark.mixes = [options listForOption:@"mixes" defaultValue:benchmark.mixes];
+    benchmark.engineNames = [options listForOption:@"engines" defaultValue:benchmark.engineNames];
+    benchmark.duration = [options doubleForOption:@"duration" defaultValue:benchmark.duration];
+    benchmark.keyCount = (NSUInteger)MAX([options integerForOption:@"keys" defaultValue:benchmark.keyCount], 0);
+    NSString *valueSize = [options stringForOption:@"value-size"];
+    if (valueSize) {
+        long long size = [YYBenchmarkOptions byteSizeFromString:valueSize];
+        if (size <= 0) {
+            fprintf(stderr, "invalid size: %s\n", valueSize.UTF8String);
+            return 2;
+        }
+        benchmark.valueSize = (NSUInteger)size;
+    }
+    benchmark.lockProfiling = [options hasOption:@"lock-profile"];
+    benchmark.path = [options stringForOption:@"path" defaultValue:benchmark.path];
+    benchmark.seed = (uint64_t)[options integerForOption:@"seed" defaultValue:(long long)benchmark.seed];
+    return [benchmark run] ? 0 : 2;
+}
+
+static int _YYBenchmarkTrace(YYBenchmarkOptions *options, YYBenchmarkReport *report) {
+    YYTraceSizeModel sizeModel = {100, 100 * 1024};
+    NSString *sizeRange = [options stringForOption:@"size-range"];
+    if (sizeRange) {
+        NSArray *parts = [sizeRange componentsSeparatedByString:@"-"];
+        long long min = [YYBenchmarkOptions byteSizeFromString:parts.firstObject];
+        long long max = [YYBenchmarkOptions byteSizeFromString:parts.lastObject];
+        if (parts.count > 2 || min <= 0 || max < min || max > UINT32_MAX) {
+            fprintf(stderr, "invalid size range: %s\n", sizeRange.UTF8String);
+            return 2;
+        }
+        sizeModel.min = (uint32_t)min;
+        sizeModel.max = (uint32_t)max;
+    }
+    NSUInteger requests = (NSUInteger)MAX([options integerForOption:@"requests" defaultValue:200000], 1);
+    NSUInteger keys = (NSUInteger)MAX([options integerForOption:@"keys" defaultValue:20000], 1);
+    double alpha = [options doubleForOption:@"alpha" defaultValue:0.99];
+    uint64_t seed = (uint64_t)[options integerForOption:@"seed" defaultValue:1];
+
+    NSMutableArray *traces = [NSMutableArray new];
+    NSString *file = [options stringForOption:@"trace-file"];
+    if (file) {
+        YYTraceFileFormat format;
+        NSString *formatName = [options stringForOption:@"trace-format" defaultValue:@"keys"];
+        if (![YYTrace parseFormat:formatName format:&format]) {
+            fprintf(stderr, "unknown trace format: %s\n", formatName.UTF8String);
+            return 2;
+        }
+        NSError *error;
+        NSUInteger limit = [options hasOption:@"requests"] ? requests : 0;
+        YYTrace *trace = [YYTrace traceWithContentsOfFile:file format:format sizeModel:sizeModel limit:limit error:&error];
+        if (!trace) {
+            fprintf(stderr, "fail to read %s: %s\n", file.UTF8String, error.localizedDescription.UTF8String);
+            return 1;
+        }
+        [traces addObject:trace];
+    } else {
+        for (NSString *name in [options listForOption:@"traces" defaultValue:@[@"zipf", @"scan", @"loop"]]) {
+            YYTrace *trace = nil;
+            if ([name isEqualToString:@"zipf"]) {
+                trace = [YYTrace zipfTraceWithCount:requests keyCount:keys alpha:alpha sizeModel:sizeModel seed:seed];
+            } else if ([name isEqualToString:@"scan"]) {
+                NSUInteger scanLength = (NSUInteger)MAX([options integerForOption:@"scan-length" defaultValue:1000], 1);
+                double scanProbability = [options doubleForOption:@"scan-probability" defaultValue:0.0005];
+                trace = [YYTrace scanTraceWithCount:requests keyCount:keys alpha:alpha scanLength:scanLength
+                                    scanProbability:scanProbability sizeModel:sizeModel seed:seed];
+            } else if ([name isEqualToString:@"loop"]) {
+                NSUInteger loopLength = (NSUInteger)MAX([options integerForOption:@"loop-length" defaultValue:5000], 1);
+                trace = [YYTrace loopTraceWithCount:requests loopLength:loopLength sizeModel:sizeModel];
+            } else if ([name isEqualToString:@"uniform"]) {
+                trace = [YYTrace uniformTraceWithCount:requests keyCount:keys sizeModel:sizeModel seed:seed];
+            } else {
+                fprintf(stderr, "unknown trace: %s\n", name.UTF8String);
+                return 2;
+            }
+            [traces addObject:trace];
+        }
+    }
+
+    YYTraceSimulator *simulator = [[YYTraceSimulator alloc] initWithReport:report];
+    simulator.policies = [options listForOption:@"policies" defaultValue:simulator.policies];
+    simulator.capacities = [options listForOption:@"capacities" defaultValue:simulator.capacities];
+    NSString *limit = [options stringForOption:@"limit" defaultValue:@"count"];
+    if ([limit isEqualToString:@"count"]) {
+        simulator.limitType = YYTraceLimitTypeCount;
+    } else if ([limit isEqualToString:@"cost"]) {
+        simulator.limitType = YYTraceLimitTypeCost;
+    } else {
+        fprintf(stderr, "unknown limit: %s\n", limit.UTF8String);
+        return 2;
+    }
+    simulator.trimInterval = (NSUInteger)MAX([options integerForOption:@"trim-interval" defaultValue:simulator.trimInterval], 1);
+    simulator.diskScale = (NSUInteger)MAX([options integerForOption:@"disk-scale" defaultValue:simulator.diskScale], 1);
+    simulator.path = [options stringForOption:@"path" defaultValue:simulator.path];
+    for (YYTrace *trace in traces) {
+        @autoreleasepool {
+            if (![simulator runTrace:trace]) return 2;
+        }
+    }
+    return 0;
+}
+
+/// Parses a list of byte sizes, returns nil and prints the invalid one.
+static NSArray<NSNumber *> *_YYBenchmarkSizeList(NSArray<NSString *> *list) {
+    NSMutableArray *sizes = [NSMutableArray new];
+    for (NSString *string in list) {
+        long long size = [YYBenchmarkOptions byteSizeFromString:string];
+        if (size < 0) {
+            fprintf(stderr, "invalid size: %s\n", string.UTF8String);
+            return nil;
+        }
+        [sizes addObject:@(size)];
+    }
+    return sizes;
+}
+
+static int _YYBenchmarkMatrix(YYBenchmarkOptions *options, YYBenchmarkReport *report) {
+    YYDiskMatrixBenchmark *benchmark = [[YYDiskMatrixBenchmark alloc] initWithReport:report];
+    if ([options hasOption:@"value-sizes"]) {
+        NSArray *sizes = _YYBenchmarkSizeList([options listForOption:@"value-sizes" defaultValue:@[]]);
+        if (!sizes) return 2;
+        benchmark.valueSizes = sizes;
+    }
+    if ([options hasOption:@"inline-thresholds"]) {
+        NSMutableArray *thresholds = [NSMutableArray new];
+        for (NSString *string in [options listForOption:@"inline-thresholds" defaultValue:@[]]) {
+            NSUInteger threshold = 0;
+            if (![YYDiskMatrixBenchmark parseInlineThreshold:string threshold:&threshold]) {
+                fprintf(stderr, "invalid inline threshold: %s\n", string.UTF8String);
+                return 2;
+            }
+            [thresholds addObject:@(threshold)];
+        }
+        benchmark.inlineThresholds = thresholds;
+    }
+    benchmark.journalModes = [options listForOption:@"journal-modes" defaultValue:benchmark.journalModes];
+    benchmark.synchronousModes = [options listForOption:@"synchronous" defaultValue:benchmark.synchronousModes];
+    if ([options hasOption:@"mmap-sizes"]) {
+        NSArray *sizes = _YYBenchmarkSizeList([options listForOption:@"mmap-sizes" defaultValue:@[]]);
+        if (!sizes) return 2;
+        benchmark.mmapSizes = sizes;
+    }
+    NSArray *pageCache = [options listForOption:@"page-cache" defaultValue:@[@"warm", @"cold"]];
+    for (NSString *state in pageCache) {
+        if (![@[@"warm", @"cold"] containsObject:state]) {
+            fprintf(stderr, "unknown page cache: %s\n", state.UTF8String);
+            return 2;
+        }
+    }
+    benchmark.warmCache = [pageCache containsObject:@"warm"];
+    benchmark.coldCache = [pageCache containsObject:@"cold"];
+    NSString *cellSize = [options stringForOption:@"cell-size"];
+    if (cellSize) {
+        long long size = [YYBenchmarkOptions byteSizeFromString:cellSize];
+        if (size <= 0) {
+            fprintf(stderr, "invalid size: %s\n", cellSize.UTF8String);
+            return 2;
+        }
+        benchmark.cellBytes = (NSUInteger)size;
+    }
+    benchmark.minCount = (NSUInteger)MAX([options integerForOption:@"min-count" defaultValue:benchmark.minCount], 0);
+    benchmark.maxCount = (NSUInteger)MAX([options integerForOption:@"max-count" defaultValue:benchmark.maxCount], 0);
+    benchmark.path = [options stringForOption:@"path" defaultValue:benchmark.path];
+    benchmark.seed = (uint64_t)[options integerForOption:@"seed" defaultValue:(long long)benchmark.seed];
+    return [benchmark run] ? 0 : 2;
+}
+
+static int _YYBenchmarkOverhead(YYBenchmarkOptions *options, YYBenchmarkReport *report) {
+    NSString *suite = [options stringForOption:@"suite" defaultValue:@"all"];
+    if (![@[@"memory", @"disk", @"all"] containsObject:suite]) {
+        fprintf(stderr, "unknown suite: %s\n", suite.UTF8String);
+        return 2;
+    }
+    YYMemoryOverheadBenchmark *benchmark = [[YYMemoryOverheadBenchmark alloc] initWithReport:report];
+    if ([options hasOption:@"counts"]) {
+        NSMutableArray *counts = [NSMutableArray new];
+        for (NSString *count in [options listForOption:@"counts" defaultValue:@[]]) {
+            [counts addObject:@(MAX(count.integerValue, 0))];
+        }
+        benchmark.memoryCounts = counts;
+    }
+    benchmark.engineNames = [options listForOption:@"engines" defaultValue:benchmark.engineNames];
+    if ([options hasOption:@"disk-counts"]) {
+        NSMutableArray *counts = [NSMutableArray new];
+        for (NSString *count in [options listForOption:@"disk-counts" defaultValue:@[]]) {
+            [counts addObject:@(MAX(count.integerValue, 0))];
+        }
+        benchmark.diskCounts = counts;
+    }
+    if ([options hasOption:@"value-sizes"]) {
+        NSArray *sizes = _YYBenchmarkSizeList([options listForOption:@"value-sizes" defaultValue:@[]]);
+        if (!sizes) return 2;
+        benchmark.diskValueSizes = sizes;
+    }
+    benchmark.path = [options stringForOption:@"path" defaultValue:benchmark.path];
+
+    if ([suite isEqualToString:@"memory"] || [suite isEqualToString:@"all"]) {
+        @autoreleasepool {
+            if (![benchmark runMemoryBenchmark]) return 2;
+        }
+    }
+    if ([suite isEqualToString:@"disk"] || [suite isEqualToString:@"all"]) {
+        @autoreleasepool {
+            if (![benchmark runDiskBenchmark]) return 2;
+        }
+    }
+    return 0;
+}
+
+static int _YYBenchmarkSoak(YYBenchmarkOptions *options, YYBenchmarkReport *report) {
+    YYSoakBenchmark *benchmark = [[YYSoakBenchmark alloc] initWithReport:report];
+    benchmark.duration = [options doubleForOption:@"duration" defaultValue:benchmark.duration];
+    benchmark.sampleInterval = [options doubleForOption:@"interval" defaultValue:benchmark.sampleInterval];
+    benchmark.warmup = [options doubleForOption:@"warmup" defaultValue:benchmark.warmup];
+    benchmark.threadCount = (NSUInteger)MAX([options integerForOption:@"threads" defaultValue:benchmark.threadCount], 0);
+    benchmark.mix = [options stringForOption:@"mix" defaultValue:benchmark.mix];
+    benchmark.keyCount = (NSUInteger)MAX([options integerForOption:@"keys" defaultValue:benchmark.keyCount], 0);
+    NSString *sizeRange = [options stringForOption:@"size-range"];
+    if (sizeRange) {
+        NSArray *parts = [sizeRange componentsSeparatedByString:@"-"];
+        long long min = [YYBenchmarkOptions byteSizeFromString:parts.firstObject];
+        long long max = [YYBenchmarkOptions byteSizeFromString:parts.lastObject];
+        if (parts.count > 2 || min <= 0 || max < min) {
+            fprintf(stderr, "invalid size range: %s\n", sizeRange.UTF8String);
+            return 2;
+        }
+        benchmark.minValueSize = (NSUInteger)min;
+        benchmark.maxValueSize = (NSUInteger)max;
+    }
+    benchmark.memoryCountLimit = (NSUInteger)MAX([options integerForOption:@"memory-count-limit" defaultValue:benchmark.memoryCountLimit], 0);
+    benchmark.diskCountLimit = (NSUInteger)MAX([options integerForOption:@"disk-count-limit" defaultValue:benchmark.diskCountLimit], 0);
+    NSArray *sizeOptions = @[@"disk-cost-limit", @"max-wal", @"max-rss", @"max-rss-growth", @"max-db-growth"];
+    NSMutableDictionary *sizes = [NSMutableDictionary new];
+    for (NSString *name in sizeOptions) {
+        NSString *string = [options stringForOption:name];
+        if (!string) continue;
+        long long size = [YYBenchmarkOptions byteSizeFromString:string];
+        if (size < 0) {
+            fprintf(stderr, "invalid size: %s\n", string.UTF8String);
+            return 2;
+        }
+        sizes[name] = @(size);
+    }
+    if (sizes[@"disk-cost-limit"]) benchmark.diskCostLimit = [sizes[@"disk-cost-limit"] unsignedIntegerValue];
+    if (sizes[@"max-wal"]) benchmark.maxWALBytes = [sizes[@"max-wal"] unsignedLongLongValue];
+    if (sizes[@"max-rss"]) benchmark.maxResidentBytes = [sizes[@"max-rss"] unsignedLongLongValue];
+    if (sizes[@"max-rss-growth"]) benchmark.maxResidentGrowth = [sizes[@"max-rss-growth"] doubleValue];
+    if (sizes[@"max-db-growth"]) benchmark.maxDatabaseGrowth = [sizes[@"max-db-growth"] doubleValue];
+    benchmark.tolerance = [options doubleForOption:@"tolerance" defaultValue:benchmark.tolerance];
+    benchmark.maxFileGrowth = [options doubleForOption:@"max-file-growth" defaultValue:benchmark.maxFileGrowth];
+    benchmark.path = [options stringForOption:@"path" defaultValue:benchmark.path];
+    benchmark.seed = (uint64_t)[options integerForOption:@"seed" defaultValue:(long long)benchmark.seed];
+    if (![benchmark run]) return 2;
+    return benchmark.flags.count ? 3 : 0;
+}
+
+/// Compares the report with the baseline, prints the changes, returns whether there's a regression.
+static BOOL _YYBenchmarkCompare(YYBenchmarkOptions *options, NSDictionary *baseline, NSDictionary *current, YYBenchmarkReport *report) {
+    YYBenchmarkComparison *comparison = [[YYBenchmarkComparison alloc] initWithBaseline:baseline current:current];
+    comparison.threshold = [options doubleForOption:@"threshold" defaultValue:comparison.threshold];
+    comparison.alpha = [options doubleForOption:@"significance" defaultValue:comparison.alpha];
+    if ([options hasOption:@"metrics"]) comparison.metrics = [options listForOption:@"metrics" defaultValue:@[]];
+    NSArray *changes = [comparison compare];
+
+    [report beginSection:[NSString stringWithFormat:@"Compare with baseline (threshold %.1f%%, p < %g)",
+                          comparison.threshold * 100, comparison.alpha]];
+    NSMutableArray *objects = [NSMutableArray new];
+    NSUInteger regressions = 0, improvements = 0, untested = 0;
+    for (YYBenchmarkChange *change in changes) {
+        [objects addObject:change.dictionaryValue];
+        if (change.baselineCount < 2 || change.currentCount < 2) untested++;
+        if (change.regression) regressions++;
+        if (change.improvement) improvements++;
+        NSString *verdict = change.regression ? @"REGRESSION" : change.improvement ? @"improvement" : change.significant ? @"significant" : @"";
+        [report log:@"%-64s %-12s %+8.2f%%  [%+8.2f%%, %+8.2f%%]  p %.3f  n %lu/%lu  %@",
+         change.identifier.UTF8String, change.metric.UTF8String, change.change * 100, change.changeLow * 100,
+         change.changeHigh * 100, change.pValue, (unsigned long)change.baselineCount, (unsigned long)change.currentCount, verdict];
+    }
+    for (NSString *identifier in comparison.missingIdentifiers) {
+        [report log:@"%-64s missing in the current run", identifier.UTF8String];
+    }
+    [report log:@"%lu compared, %lu regressions, %lu improvements", (unsigned long)changes.count,
+     (unsigned long)regressions, (unsigned long)improvements];
+    if (untested) {
+        fprintf(stderr, "warning: %lu comparisons have less than 2 samples on a side, they can not fail, "
+                        "record both runs with --repeat 2 or more\n", (unsigned long)untested);
+    }
+    report.comparison = objects;
+    return regressions > 0;
+}
+
+/// A baseline of another machine class is meaningless, returns NO if the labels differ.
+static BOOL _YYBenchmarkCheckLabels(NSDictionary *baseline, NSString *label) {
+    NSString *baselineLabel = [baseline[@"label"] isKindOfClass:[NSString class]] ? baseline[@"label"] : nil;
+    if (baselineLabel && label && ![baselineLabel isEqualToString:label]) {
+        fprintf(stderr, "the baseline is of %s, not %s\n", baselineLabel.UTF8String, label.UTF8String);
+        return NO;
+    }
+    if (!baselineLabel || !label) {
+        fprintf(stderr, "warning: no --label on both sides, make sure the baseline is of the same machine class\n");
+    }
+    return YES;
+}
+
+static int _YYBenchmarkCompareFiles(YYBenchmarkOptions *options, YYBenchmarkReport *report) {
+    if (options.arguments.count != 2) {
+        fprintf(stderr, "usage: yycache-bench compare BASELINE CURRENT\n");
+        return 2;
+    }
+    NSMutableArray *objects = [NSMutableArray new];
+    for (NSString *path in options.arguments) {
+        NSError *error;
+        NSDictionary *object = [YYBenchmarkComparison reportObjectAtPath:path error:&error];
+        if (!object) {
+            fprintf(stderr, "fail to read %s: %s\n", path.UTF8String, error.localizedDescription.UTF8String);
+            return 1;
+        }
+        [objects addObject:object];
+    }
+    NSString *label = [objects[1][@"label"] isKindOfClass:[NSString class]] ? objects[1][@"label"] : nil;
+    if (!_YYBenchmarkCheckLabels(objects[0], label)) return 2;
+    return _YYBenchmarkCompare(options, objects[0], objects[1], report) ? 3 : 0;
+}
+
+int main(int argc, const char * argv[]) {
+    @autoreleasepool {
+        NSArray *arguments = [NSProcessInfo processInfo].arguments;
+        arguments = arguments.count > 1 ? [arguments subarrayWithRange:NSMakeRange(1, arguments.count - 1)] : @[];
+        YYBenchmarkOptions *options = [[YYBenchmarkOptions alloc] initWithArguments:arguments];
+        if ([options hasOption:@"help"] || [options.command isEqualToString:@"help"]) {
+            _YYBenchmarkPrintUsage();
+            return 0;
+        }
+
+        NSString *json = [options stringForOption:@"json"];
+        NSString *csv = [options stringForOption:@"csv"];
+        YYBenchmarkReport *report = [YYBenchmarkReport new];
+        report.label = [options stringForOption:@"label"];
+        if ([options hasOption:@"quiet"]) {
+            report.log = NULL;
+        } else if ([json isEqualToString:@"-"] || [csv isEqualToString:@"-"]) {
+            report.log = stderr; // keep stdout for the JSON or CSV
+        }
+
+        NSString *command = options.command ?: @"run";
+        if (![@[@"run", @"contention", @"trace", @"matrix", @"overhead", @"soak", @"compare"] containsObject:command]) {
+            fprintf(stderr, "unknown command: %s\n\n", command.UTF8String);
+            _YYBenchmarkPrintUsage();
+            return 2;
+        }
+
+        NSDictionary *baseline = nil;
+        NSString *baselinePath = [options stringForOption:@"baseline"];
+        if (baselinePath) {
+            NSError *error;
+            baseline = [YYBenchmarkComparison reportObjectAtPath:baselinePath error:&error];
+            if (!baseline) {
+                fprintf(stderr, "fail to read %s: %s\n", baselinePath.UTF8String, error.localizedDescription.UTF8String);
+                return 1;
+            }
+            if (!_YYBenchmarkCheckLabels(baseline, report.label)) return 2;
+        }
+
+        int result = 0;
+        NSUInteger repeat = (NSUInteger)MAX([options integerForOption:@"repeat" defaultValue:1], 1);
+        if (baseline && repeat < 2) {
+            fprintf(stderr, "--baseline needs --repeat 2 or more, a single run can not be tested for significance\n");
+            return 2;
+        }
+        for (NSUInteger run = 0; run < repeat && result == 0; run++) {
+            @autoreleasepool {
+                if (repeat > 1) [report beginSection:[NSString stringWithFormat:@"Run %lu of %lu", (unsigned long)run + 1, (unsigned long)repeat]];
+                report.run = run;
+                if ([command isEqualToString:@"run"]) {
+                    result = _YYBenchmarkRun(options, report);
+                } else if ([command isEqualToString:@"contention"]) {
+                    result = _YYBenchmarkContention(options, report);
+                } else if ([command isEqualToString:@"trace"]) {
+                    result = _YYBenchmarkTrace(options, report);
+                } else if ([command isEqualToString:@"matrix"]) {
+                    result = _YYBenchmarkMatrix(options, report);
+                } else if ([command isEqualToString:@"overhead"]) {
+                    result = _YYBenchmarkOverhead(options, report);
+                } else if ([command isEqualToString:@"soak"]) {
+                    result = _YYBenchmarkSoak(options, report);
+                } else {
+                    result = _YYBenchmarkCompareFiles(options, report);
+                    break;
+                }
+            }
+        }
+
+        if ([YYCacheMetrics isEnabled]) {
+            report.cacheMetrics = [YYCacheMetrics snapshot];
+            [report beginSection:@"Cache latency metrics (us)"];
+            NSArray *names = [report.cacheMetrics.allKeys sortedArrayUsingSelector:@selector(compare:)];
+            for (NSString *name in names) {
+                NSDictionary *metric = report.cacheMetrics[name];
+                [report log:@"%-21s %10llu  mean %9.2f  p50 %9.2f  p99 %9.2f  p999 %9.2f  max %10.2f", name.UTF8String,
+                 [metric[@"count"] unsignedLongLongValue], [metric[@"mean_us"] doubleValue], [metric[@"p50_us"] doubleValue],
+                 [metric[@"p99_us"] doubleValue], [metric[@"p999_us"] doubleValue], [metric[@"max_us"] doubleValue]];
+            }
+        }
+
+        if (baseline && result == 0) {
+            if (_YYBenchmarkCompare(options, baseline, report.dictionaryValue, report)) result = 3;
+        }
+
+        if (json) {
+            NSError *error;
+            if (![report writeJSONToPath:json error:&error]) {
+                fprintf(stderr, "fail to write %s: %s\n", json.UTF8String, error.localizedDescription.UTF8String);
+                return 1;
+            }
+        }
+        if (csv) {
+            NSError *error;
+            if (![report writeCSVToPath:csv error:&error]) {
+                fprintf(stderr, "fail to write %s: %s\n", csv.UTF8String, error.localizedDescription.UTF8String);
+                return 1;
+            }
+        }
+        if (report.log) fprintf(report.log, "\n\n--fin--\n\n");
+        return result;
+    }
+}
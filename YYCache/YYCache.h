@@ -17,18 +17,69 @@ FOUNDATION_EXPORT const unsigned char YYCacheVersionString[];
 #import <YYCache/YYMemoryCache.h>
 #import <YYCache/YYDiskCache.h>
 #import <YYCache/YYKVStorage.h>
+#import <YYCache/YYCacheGroup.h>
+#import <YYCache/YYCacheTrimScheduler.h>
+#import <YYCache/YYCacheTraceRecorder.h>
+#import <YYCache/YYCacheMetrics.h>
+#import <YYCache/YYCacheLockProfile.h>
 #elif __has_include(<YYWebImage/YYCache.h>)
 #import <YYWebImage/YYMemoryCache.h>
 #import <YYWebImage/YYDiskCache.h>
 #import <YYWebImage/YYKVStorage.h>
+#import <YYWebImage/YYCacheGroup.h>
+#import <YYWebImage/YYCacheTrimScheduler.h>
+#import <YYWebImage/YYCacheTraceRecorder.h>
+#import <YYWebImage/YYCacheMetrics.h>
+#import <YYWebImage/YYCacheLockProfile.h>
 #else
 #import "YYMemoryCache.h"
 #import "YYDiskCache.h"
 #import "YYKVStorage.h"
+#import "YYCacheGroup.h"
+#import "YYCacheTrimScheduler.h"
+#import "YYCacheTraceRecorder.h"
+#import "YYCacheMetrics.h"
+#import "YYCacheLockProfile.h"
 #endif
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ The write policy of YYCache, which decides how a write reaches the disk cache.
+ */
+typedef NS_ENUM(NSUInteger, YYCacheWritePolicy) {
+    
+    /// Write to memory cache and disk cache in the calling thread (write-through).
+    YYCacheWritePolicySync = 0,
+    
+    /// Write to memory cache in the calling thread, and write to disk cache later
+    /// in a background serial queue (write-behind). The writes of the same key
+    /// reach the disk in the order they are made. Reads see the queued writes.
+    YYCacheWritePolicyAsync,
+    
+    /// Write to memory cache only. The older object of the same key in disk cache
+    /// is removed in background, so it will not be read after the memory eviction.
+    YYCacheWritePolicyMemoryOnly,
+};
+
+/**
+ The tiering policy of YYCache, which decides how objects move between the memory
+ cache and the disk cache.
+ */
+typedef NS_ENUM(NSUInteger, YYCacheTieringPolicy) {
+    
+    /// Every object lives in both tiers, a disk hit is always promoted to memory.
+    YYCacheTieringPolicyInclusive = 0,
+    
+    /// An object lives in only one tier. A set goes to memory, an object evicted
+    /// from memory by limits is demoted to disk, and a disk hit is moved to memory.
+    YYCacheTieringPolicyExclusive,
+    
+    /// Same as inclusive, but a disk hit is promoted only when the key is hit again
+    /// recently, so the one-time reads do not pollute the memory cache.
+    YYCacheTieringPolicyPromoteOnSecondHit,
+};
+
 
 /**
  `YYCache` is a thread safe key-value cache.
@@ -36,6 +87,13 @@ NS_ASSUME_NONNULL_BEGIN
  It use `YYMemoryCache` to store objects in a small and fast memory cache,
  and use `YYDiskCache` to persisting objects to a large and slow disk cache.
  See `YYMemoryCache` and `YYDiskCache` for more information.
+ 
+ A set or remove changes a version of the key before it changes the memory cache,
+ and finishes it after the disk cache is changed. An object read from disk cache is
+ put into memory cache only if no set or remove of the key happened since the read
+ began, so a read racing with a remove never brings back the removed object. The
+ read path takes no extra lock. Writes made directly to `memoryCache` or `diskCache`
+ are not versioned.
  */
 @interface YYCache : NSObject
 
@@ -48,6 +106,20 @@ NS_ASSUME_NONNULL_BEGIN
 /** The underlying disk cache. see `YYDiskCache` for more information.*/
 @property (strong, readonly) YYDiskCache *diskCache;
 
+/**
+ The cache of archived data read from disk cache, between the memory cache and 
+ the disk cache. It's used only when `dataCacheEnabled` is `YES`.
+ 
+ @discussion A memory miss is served from this cache without disk IO (the object is
+ unarchived again). The objects are `YYKVStorageItem` and the cost is the archived 
+ size in bytes, the default `costLimit` is 32MB. It's useful when the decoded objects
+ are much larger than their data, so more objects fit in the same budget.
+ */
+@property (strong, readonly) YYMemoryCache *dataCache;
+
+/** Whether `dataCache` is used. Default is NO. */
+@property BOOL dataCacheEnabled;
+
 /**
  Create a new instance with the specified name.
  Multiple instances with the same name will make the cache unstable.
@@ -97,6 +169,159 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)init UNAVAILABLE_ATTRIBUTE;
 + (instancetype)new UNAVAILABLE_ATTRIBUTE;
 
+#pragma mark - Write Policy
+///=============================================================================
+/// @name Write Policy
+///=============================================================================
+
+/**
+ The write policy of set and remove methods. Default is `YYCacheWritePolicySync`.
+ 
+ @discussion With `YYCacheWritePolicyAsync`, the set methods return as fast as the
+ memory cache, the archive and disk IO are done in background. Call `flush` to wait
+ until all queued writes reach the disk, such as before the app is terminated.
+ */
+@property YYCacheWritePolicy writePolicy;
+
+/**
+ Waits until all queued disk writes (and spills) are finished.
+ This method may blocks the calling thread until file write finished.
+ */
+- (void)flush;
+
+/**
+ Waits until all queued disk writes (and spills) are finished.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param block  A block which will be invoked in background queue when finished.
+ */
+- (void)flushWithBlock:(void(^)(void))block;
+
+#pragma mark - Tiering Policy
+///=============================================================================
+/// @name Tiering Policy
+///=============================================================================
+
+/**
+ The tiering policy. Default is `YYCacheTieringPolicyInclusive`.
+ 
+ @discussion With `YYCacheTieringPolicyExclusive`, the objects evicted from memory,
+ including the ones removed by memory warning or entering background, are moved to
+ disk with their TTLs. Objects removed by `removeObjectForKey:` or `removeAllObjects`
+ of `memoryCache` are lost.
+ 
+ @warning The `didEvictObjectWithTTLBlock` of `memoryCache` is used by this cache,
+ you should not replace it.
+ */
+@property YYCacheTieringPolicy tieringPolicy;
+
+/**
+ The maximum size in bytes of a disk object which can be promoted to memory cache.
+ Default is 0, which means no limit.
+ 
+ @discussion When this value is larger than 0, the promotion is cost-aware: the
+ objects larger than this value stay in disk cache, and the promoted objects take
+ their archived size as the cost in memory cache, so `memoryCache.costLimit`
+ works as a memory budget for the promoted objects.
+ */
+@property NSUInteger promotionCostLimit;
+
+/**
+ If `YES`, the objects evicted from memory cache by limits are spilled to disk cache.
+ Default is NO. (The evicted objects are always spilled with `YYCacheTieringPolicyExclusive`).
+ 
+ @discussion The spilled objects are written in background, in batched transactions
+ with a limited rate, and reads see them before they are written. It's useful when
+ objects are set to `memoryCache` directly, or with `YYCacheWritePolicyMemoryOnly`,
+ so they are not lost when evicted. The remaining TTLs of the objects are kept. Setting
+ or removing the key cancels its pending spill, and an object is not spilled if its key
+ is set or removed after the eviction, or (with a write policy which writes to disk
+ and an inclusive tiering policy) is already in disk cache. Call `flush` to write all
+ pending spills immediately.
+ */
+@property BOOL spillsEvictedObjects;
+
+#pragma mark - Negative Cache
+///=============================================================================
+/// @name Negative Cache
+///=============================================================================
+
+/**
+ The time-to-live in seconds of a negative entry. Default is 0, which means the
+ negative entry is disabled.
+ 
+ @discussion When this value is larger than 0, a key which is not found in both
+ tiers is remembered in a private memory cache (up to 4096 keys, not in `memoryCache`),
+ and the following lookups of this key return nil with two memory lookups until the
+ TTL. Setting the key with this cache removes the negative entry. The objects written
+ to `diskCache` directly may be hidden until the TTL.
+ */
+@property NSTimeInterval negativeCacheTTL;
+
+#pragma mark - Warmup
+///=============================================================================
+/// @name Warmup
+///=============================================================================
+
+/**
+ The maximum number of hot keys to record. Default is 0, which means the hot keys
+ are not recorded.
+ 
+ @discussion When this value is larger than 0, the cache records the top-N keys of
+ the memory cache (ordered by recent access) to disk every `hotKeysRecordInterval`
+ seconds. After launch, you can call `warmupWithCountLimit:timeLimit:completion:`
+ to preload these objects into the memory cache.
+ */
+@property NSUInteger hotKeysLimit;
+
+/**
+ The hot keys record interval in seconds. Default is 60 (1 minute).
+ */
+@property NSTimeInterval hotKeysRecordInterval;
+
+/**
+ Records the hot keys of the memory cache to disk immediately.
+ It has no effect if `hotKeysLimit` is 0 or the memory cache is empty.
+ This method may blocks the calling thread until file write finished.
+ */
+- (void)recordHotKeys;
+
+/**
+ Preloads the recorded hot keys from disk cache into memory cache.
+ 
+ @discussion This method returns immediately and loads the objects in background
+ queue, in the order of the record (the hottest first). It stops when the budget 
+ is used up or the memory cache reaches its `countLimit`. The objects which are 
+ already in memory cache will not be overwritten.
+ 
+ @param countLimit The maximum number of objects to load.
+ @param timeLimit  The maximum time in seconds to spend on loading.
+ @param completion A block which will be invoked in background queue when finished, pass nil to ignore.
+ */
+- (void)warmupWithCountLimit:(NSUInteger)countLimit
+                   timeLimit:(NSTimeInterval)timeLimit
+                  completion:(nullable void(^)(NSUInteger loadedCount))completion;
+
+#pragma mark - Trace
+///=============================================================================
+/// @name Trace
+///=============================================================================
+
+/**
+ The recorder of the accesses of this cache, to replay the real access pattern and
+ plan the limits. The default value is nil, which costs one check per access.
+ 
+ @discussion A get is recorded in the tier which served it, `YYCacheTraceTierMemory`
+ (a negative entry is a miss in memory) or `YYCacheTraceTierDisk` (a miss in both
+ tiers is a miss in disk), with the archived size if it's read from disk. A set or
+ a remove is recorded in `YYCacheTraceTierCache` without size. The keys are prefixed
+ if the cache is in a group. Set the `traceRecorder` of `memoryCache` and `diskCache`
+ instead to record the accesses of each tier.
+ See `YYCacheTraceRecorder` for more information.
+ */
+@property (nullable, strong) YYCacheTraceRecorder *traceRecorder;
+
 #pragma mark - Access Methods   接口方法
 ///=============================================================================
 /// @name Access Methods
@@ -146,11 +371,100 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)objectForKey:(NSString *)key withBlock:(nullable void(^)(NSString *key, id<NSCoding> object))block;
 
+/**
+ Returns the value associated with a given key, and whether it's stale.
+ This method may blocks the calling thread until file read finished.
+ 
+ @discussion An object which is past its soft TTL is returned immediately (stale)
+ with `needsRefresh` set to `YES`, so you can show it and refresh the value in 
+ background. An object which is past its hard TTL is never returned.
+ 
+ @param key          A string identifying the value. If nil, just return nil.
+ @param needsRefresh Output whether the value is past its soft TTL, pass NULL to ignore.
+ @return The value associated with key, or nil if no value is associated with key.
+ */
+- (nullable id<NSCoding>)objectForKey:(NSString *)key needsRefresh:(nullable BOOL *)needsRefresh;
+
+/**
+ Returns the value associated with a given key, and whether it's stale.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param key   A string identifying the value. If nil, just return nil.
+ @param block A block which will be invoked in background queue when finished.
+ */
+- (void)objectForKey:(NSString *)key withRefreshBlock:(nullable void(^)(NSString *key, id<NSCoding> _Nullable object, BOOL needsRefresh))block;
+
+/**
+ Returns a boolean value with the block that indicates whether a given key is in cache.
+ 
+ @discussion If the key is in memory cache, the block is invoked immediately in the 
+ calling thread, before this method returns. Otherwise the disk cache is checked in
+ background, and the block is invoked in the `queue`.
+ 
+ @param key   A string identifying the value. If nil, just return NO.
+ @param queue The queue to invoke the block when it's not a memory hit, pass nil 
+     to invoke it in background queue.
+ @param block A block which will be invoked when finished.
+ */
+- (void)containsObjectForKey:(NSString *)key queue:(nullable dispatch_queue_t)queue withBlock:(nullable void(^)(NSString *key, BOOL contains))block;
+
+/**
+ Returns the value associated with a given key.
+ 
+ @discussion If the object is in memory cache, the block is invoked immediately in 
+ the calling thread, before this method returns (such as in the same run loop for 
+ main queue). Otherwise the object is read from disk cache in background, and the
+ block is invoked in the `queue`.
+ 
+ @param key   A string identifying the value. If nil, just return nil.
+ @param queue The queue to invoke the block when it's not a memory hit, pass nil 
+     to invoke it in background queue.
+ @param block A block which will be invoked when finished.
+ */
+- (void)objectForKey:(NSString *)key queue:(nullable dispatch_queue_t)queue withBlock:(nullable void(^)(NSString *key, id<NSCoding> _Nullable object))block;
+
+/**
+ Returns the value associated with a given key, and whether it needs refresh.
+ Same as `objectForKey:queue:withBlock:`, see `objectForKey:needsRefresh:` for the
+ `needsRefresh` flag.
+ 
+ @param key   A string identifying the value. If nil, just return nil.
+ @param queue The queue to invoke the block when it's not a memory hit, pass nil 
+     to invoke it in background queue.
+ @param block A block which will be invoked when finished.
+ */
+- (void)objectForKey:(NSString *)key queue:(nullable dispatch_queue_t)queue withRefreshBlock:(nullable void(^)(NSString *key, id<NSCoding> _Nullable object, BOOL needsRefresh))block;
+
+/**
+ Returns the values associated with the given keys.
+ This method may blocks the calling thread until file read finished.
+ 
+ @discussion The memory hits are resolved in one locked pass, the misses are fetched
+ from disk cache with multi-key queries and unarchived concurrently, and then
+ promoted to memory cache in one pass (see `tieringPolicy`).
+ 
+ @param keys An array of keys.
+ @return A dictionary which key is the key and value is the value, the keys which
+     are not in cache are not included.
+ */
+- (NSDictionary<NSString *, id<NSCoding>> *)objectsForKeys:(NSArray<NSString *> *)keys;
+
+/**
+ Returns the values associated with the given keys.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param keys  An array of keys.
+ @param block A block which will be invoked in background queue when finished.
+ */
+- (void)objectsForKeys:(NSArray<NSString *> *)keys withBlock:(void(^)(NSDictionary<NSString *, id<NSCoding>> *objects))block;
+
 /**
  在缓存中存值
  Sets the value of the specified key in the cache.
  此方法可以组织调用线程直到文件写完成
- This method may blocks the calling thread until file write finished.
+ This method may blocks the calling thread until file write finished (see `writePolicy`).
  
  @param object The object to be stored in the cache. If nil, it calls `removeObjectForKey:`.
  @param key    The key with which to associate the value. If nil, this method has no effect.
@@ -167,6 +481,35 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key withBlock:(nullable void(^)(void))block;
 
+/**
+ Sets the value of the specified key in the cache, with a soft and a hard TTL.
+ This method may blocks the calling thread until file write finished.
+ 
+ @discussion The TTLs are stored with the object in both memory and disk cache.
+ After the soft TTL, reads still return the object with a needs-refresh flag (see
+ `objectForKey:needsRefresh:`). After the hard TTL, the object is treated as not
+ exists and trimmed in background.
+ 
+ @param object  The object to be stored in the cache. If nil, it calls `removeObjectForKey:`.
+ @param key     The key with which to associate the value. If nil, this method has no effect.
+ @param softTTL The soft time-to-live in seconds, 0 means never stale.
+ @param hardTTL The hard time-to-live in seconds, 0 means never expire.
+ */
+- (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL;
+
+/**
+ Sets the value of the specified key in the cache, with a soft and a hard TTL.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param object  The object to be stored in the cache. If nil, it calls `removeObjectForKey:`.
+ @param key     The key with which to associate the value. If nil, this method has no effect.
+ @param softTTL The soft time-to-live in seconds, 0 means never stale.
+ @param hardTTL The hard time-to-live in seconds, 0 means never expire.
+ @param block   A block which will be invoked in background queue when finished.
+ */
+- (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL withBlock:(nullable void(^)(void))block;
+
 /**
  移除key对应的value
  Removes the value of the specified key in the cache.
@@ -12,8 +12,309 @@
 #import "YYCache.h"
 #import "YYMemoryCache.h"
 #import "YYDiskCache.h"
+#import <time.h>
+#import <stdatomic.h>
 
-@implementation YYCache
+#define Lock() dispatch_semaphore_wait(self->_lock, DISPATCH_TIME_FOREVER)
+#define Unlock() dispatch_semaphore_signal(self->_lock)
+
+static NSString *const kHotKeysFileName = @"hotkeys.plist";
+static const NSUInteger kPromotionHistoryCountLimit = 4096; ///< keys hit once, for promote-on-second-hit
+static const NSUInteger kSpillBatchCount = 64;         ///< objects per spill transaction
+static const NSUInteger kSpillBacklogLimit = 1024;     ///< spill without delay if more objects are waiting
+static const NSTimeInterval kSpillInterval = 0.05;     ///< min interval between spill transactions
+static const NSUInteger kDataCacheCostLimit = 1024 * 1024 * 32; ///< 32MB of archived data
+static const NSUInteger kNegativeCacheCountLimit = 4096; ///< keys known not to exist
+static const NSUInteger kVersionStripeCount = 64;      ///< power of 2, keys share the version counters
+static char kWriteQueueSpecificKey;                    ///< the cache which owns the write queue
+
+/// Invoke a completion block of the user in background, never in the write queue,
+/// so the block can call the methods which wait for the write queue.
+static void _YYCacheCallBack(void (^block)(void)) {
+    if (!block) return;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), block);
+}
+
+/// Remaining time-to-live of an unix expire timestamp, 0 means never expire.
+static NSTimeInterval _YYCacheRemainingTTL(int expireTime, long now) {
+    if (expireTime <= 0) return 0;
+    return MAX(expireTime - now, 0.001); // already passed, but 0 means never
+}
+
+/// Convert a time-to-live to an unix timestamp, 0 means never expire.
+static int _YYCacheExpireTime(NSTimeInterval ttl, long now) {
+    if (ttl <= 0) return 0;
+    if (ttl >= INT_MAX - now) return 0;
+    return (int)(now + MAX(ttl, 1));
+}
+
+/**
+ A disk write which is queued but not finished yet.
+ Typically, you should not use this class directly.
+ */
+@interface _YYCachePendingWrite : NSObject {
+    @package
+    id<NSCoding> _object; ///< nil means remove
+    int _softExpireTime;
+    int _hardExpireTime;
+    BOOL _moved; ///< a remove of the object moved to memory, a spill of the object may replace it
+}
+@end
+
+@implementation _YYCachePendingWrite
+@end
+
+/**
+ The version counters of the keys in a stripe, like a seqlock.
+ A mutation increases `begin` before it changes the memory cache, and increases `end`
+ after the disk cache is changed, so `begin != end` means a mutation is in flight.
+ */
+typedef struct {
+    _Atomic(uint64_t) begin;
+    _Atomic(uint64_t) end;
+} _YYCacheVersionStripe;
+
+/**
+ The version of a key taken before a disk read. The object read from disk cache can
+ be put into memory cache (or data cache) only if the version is still current.
+ */
+typedef struct {
+    uint64_t stripe;
+    uint64_t epoch;
+    bool valid; ///< false if a mutation was in flight when taken
+} _YYCacheVersion;
+
+static NSValue *_YYCacheVersionValue(_YYCacheVersion version) {
+    return [NSValue valueWithBytes:&version objCType:@encode(_YYCacheVersion)];
+}
+
+/// Returns an invalid version if value is nil.
+static _YYCacheVersion _YYCacheVersionFromValue(NSValue *value) {
+    _YYCacheVersion version = {0};
+    [value getValue:&version];
+    return version;
+}
+
+@implementation YYCache {
+    dispatch_semaphore_t _lock;
+    dispatch_queue_t _writeQueue; ///< serial, keeps the order of writes
+    NSMutableDictionary *_pendingWrites; ///< key -> _YYCachePendingWrite
+    YYMemoryCache *_promotionHistory; ///< key -> @YES, the keys hit once in disk cache
+    YYMemoryCache *_negativeCache; ///< key -> @YES, the keys known not to exist, private to keep them out of memoryCache
+    NSMutableArray *_spillKeys; ///< keys evicted from memory, in eviction order
+    NSMutableDictionary *_spillWrites; ///< key -> _YYCachePendingWrite, also in _pendingWrites
+    BOOL _spillScheduled;
+    NSUInteger _hotKeysLimit;
+    BOOL _hotKeysRecording;
+    NSArray *_lastHotKeys;
+    _YYCacheVersionStripe *_versions; ///< kVersionStripeCount stripes, by key hash
+    _YYCacheVersionStripe _epoch; ///< for remove all
+    NSString *_keyPrefix; ///< prepended to the keys in memory cache and disk cache, nil if not in a group
+}
+
+#pragma mark - private
+
+/// The key in memory cache and disk cache, which may be shared by a cache group.
+- (NSString *)_storageKeyForKey:(NSString *)key {
+    if (!_keyPrefix || !key) return key;
+    return [_keyPrefix stringByAppendingString:key];
+}
+
+- (NSString *)_keyForStorageKey:(NSString *)storageKey {
+    if (!_keyPrefix || !storageKey) return storageKey;
+    return [storageKey substringFromIndex:_keyPrefix.length];
+}
+
+- (_YYCacheVersionStripe *)_versionStripeForKey:(NSString *)key {
+    return _versions + (key.hash & (kVersionStripeCount - 1));
+}
+
+/// Should be called before the memory cache is changed by a set or remove.
+- (void)_beginMutationForKey:(NSString *)key {
+    if (!key) return;
+    atomic_fetch_add(&[self _versionStripeForKey:key]->begin, 1);
+}
+
+/// Should be called after the disk cache is changed by a set or remove.
+- (void)_endMutationForKey:(NSString *)key {
+    if (!key) return;
+    atomic_fetch_add(&[self _versionStripeForKey:key]->end, 1);
+}
+
+- (void)_beginMutationForAll {
+    atomic_fetch_add(&_epoch.begin, 1);
+}
+
+- (void)_endMutationForAll {
+    atomic_fetch_add(&_epoch.end, 1);
+}
+
+/// Take the version of a key, should be called after the memory miss and before the disk read.
+- (_YYCacheVersion)_versionForKey:(NSString *)key {
+    _YYCacheVersionStripe *stripe = [self _versionStripeForKey:key];
+    _YYCacheVersion version;
+    version.epoch = atomic_load(&_epoch.begin);
+    version.stripe = atomic_load(&stripe->begin);
+    version.valid = atomic_load(&stripe->end) == version.stripe && atomic_load(&_epoch.end) == version.epoch;
+    return version;
+}
+
+/// Whether no mutation of the key began or was in flight since the version was taken.
+- (BOOL)_isCurrentVersion:(_YYCacheVersion)version forKey:(NSString *)key {
+    if (!version.valid) return NO;
+    if (atomic_load(&_epoch.begin) != version.epoch) return NO;
+    return atomic_load(&[self _versionStripeForKey:key]->begin) == version.stripe;
+}
+
+/// Record the hot keys periodically (every `hotKeysRecordInterval` seconds),
+/// until the `hotKeysLimit` is set to 0.
+- (void)_recordHotKeysRecursively {
+    __weak typeof(self) _self = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_hotKeysRecordInterval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+        __strong typeof(_self) self = _self;
+        if (!self) return;
+        Lock();
+        BOOL stop = self->_hotKeysLimit == 0;
+        if (stop) self->_hotKeysRecording = NO; // the next non-zero limit starts again
+        Unlock();
+        if (stop) return;
+        [self recordHotKeys];
+        [self _recordHotKeysRecursively];
+    });
+}
+
+- (NSString *)_hotKeysPath {
+    NSString *fileName = kHotKeysFileName;
+    if (_keyPrefix) fileName = [NSString stringWithFormat:@"%@.%@", _name, kHotKeysFileName]; // one file per namespace
+    return [_diskCache.path stringByAppendingPathComponent:fileName];
+}
+
+- (_YYCachePendingWrite *)_pendingWriteForKey:(NSString *)key {
+    if (!key) return nil;
+    Lock();
+    _YYCachePendingWrite *write = _pendingWrites.count ? _pendingWrites[key] : nil;
+    Unlock();
+    return write;
+}
+
+/// Run the block in write queue and wait for it, or run it directly if already in the write queue.
+- (void)_performInWriteQueueAndWait:(void(^)(void))block {
+    if (dispatch_get_specific(&kWriteQueueSpecificKey) == (__bridge void *)self) {
+        block();
+    } else {
+        dispatch_sync(_writeQueue, block);
+    }
+}
+
+- (BOOL)_hasPendingWrites {
+    Lock();
+    BOOL has = _pendingWrites.count > 0;
+    Unlock();
+    return has;
+}
+
+/// Queue a disk write (or remove if object is nil) to the write queue, and record it as pending.
+/// The block is invoked in write queue after the write, it should not be a block of the user.
+- (void)_queueDiskWriteWithObject:(id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL block:(void(^)(void))block {
+    long now = time(NULL);
+    _YYCachePendingWrite *write = [_YYCachePendingWrite new];
+    write->_object = object;
+    write->_softExpireTime = _YYCacheExpireTime(softTTL, now);
+    write->_hardExpireTime = _YYCacheExpireTime(hardTTL, now);
+    [self _queueDiskWrite:write forKey:key block:block];
+}
+
+/// Queue a disk remove of an object which is moved to memory cache (promoted, or set with
+/// `YYCacheWritePolicyMemoryOnly`), the spill of the object may replace it when evicted.
+- (void)_queueDiskRemoveForMovedKey:(NSString *)key block:(void(^)(void))block {
+    _YYCachePendingWrite *write = [_YYCachePendingWrite new];
+    write->_moved = YES;
+    [self _queueDiskWrite:write forKey:key block:block];
+}
+
+- (void)_queueDiskWrite:(_YYCachePendingWrite *)write forKey:(NSString *)key block:(void(^)(void))block {
+    Lock();
+    _pendingWrites[key] = write;
+    Unlock();
+    [_dataCache removeObjectForKey:key];
+    
+    // hold self until the write finished
+    dispatch_async(_writeQueue, ^{
+        if (write->_object) {
+            long now = time(NULL);
+            [self->_diskCache setObject:write->_object forKey:key
+                                softTTL:_YYCacheRemainingTTL(write->_softExpireTime, now)
+                                hardTTL:_YYCacheRemainingTTL(write->_hardExpireTime, now)];
+        } else {
+            [self->_diskCache removeObjectForKey:key];
+        }
+        [self->_dataCache removeObjectForKey:key]; // may be filled by a read during the write
+        Lock();
+        if (self->_pendingWrites[key] == write) [self->_pendingWrites removeObjectForKey:key];
+        Unlock();
+        if (block) block();
+    });
+}
+
+/// Write an object to disk cache (or remove if object is nil) with `writePolicy`,
+/// and end the mutation of the key after the disk cache is changed. An object which
+/// lives only in memory (exclusive or memory only) removes the older one on disk.
+- (void)_diskSetObject:(id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL block:(void(^)(void))block {
+    if (!key) return;
+    [_dataCache removeObjectForKey:key];
+    if (object) [_negativeCache removeObjectForKey:key]; // after memory cache is changed
+    YYCacheWritePolicy policy = self.writePolicy;
+    BOOL moved = object && (policy == YYCacheWritePolicyMemoryOnly || self.tieringPolicy == YYCacheTieringPolicyExclusive);
+    if (moved && policy == YYCacheWritePolicySync) object = nil;
+    if (policy == YYCacheWritePolicySync && ![self _hasPendingWrites]) {
+        YYMemoryCache *dataCache = _dataCache;
+        if (object) {
+            if (block) {
+                [_diskCache setObject:object forKey:key softTTL:softTTL hardTTL:hardTTL withBlock:^{
+                    [dataCache removeObjectForKey:key]; // may be filled by a read during the write
+                    [self _endMutationForKey:key];
+                    block();
+                }];
+            } else {
+                [_diskCache setObject:object forKey:key softTTL:softTTL hardTTL:hardTTL];
+                [dataCache removeObjectForKey:key];
+                [self _endMutationForKey:key];
+            }
+        } else {
+            if (block) {
+                [_diskCache removeObjectForKey:key withBlock:^(NSString *key) {
+                    [dataCache removeObjectForKey:key];
+                    [self _endMutationForKey:key];
+                    block();
+                }];
+            } else {
+                [_diskCache removeObjectForKey:key];
+                [dataCache removeObjectForKey:key];
+                [self _endMutationForKey:key];
+            }
+        }
+        return;
+    }
+    void (^completion)(void) = ^{
+        [self _endMutationForKey:key];
+        _YYCacheCallBack(block);
+    };
+    if (moved) {
+        [self _queueDiskRemoveForMovedKey:key block:completion]; // remove the older one
+    } else {
+        [self _queueDiskWriteWithObject:object forKey:key softTTL:softTTL hardTTL:hardTTL block:completion];
+    }
+    if (policy == YYCacheWritePolicySync && !block) [self flush]; // queued after other writes
+}
+
+/// Records a set or a remove, which reaches both tiers.
+- (void)_recordOperation:(YYCacheTraceOperation)operation forKey:(NSString *)key {
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (!recorder || !key) return;
+    [recorder recordOperation:operation tier:YYCacheTraceTierCache key:key size:0 result:YYCacheTraceResultNone];
+}
+
+#pragma mark - public
 
 - (instancetype) init {
     NSLog(@"Use \"initWithName\" or \"initWithPath\" to create YYCache instance.");
@@ -38,14 +339,62 @@
     NSString *name = [path lastPathComponent];
     YYMemoryCache *memoryCache = [YYMemoryCache new];
     memoryCache.name = name;
+    YYMemoryCache *dataCache = [YYMemoryCache new];
+    dataCache.name = [name stringByAppendingString:@".data"];
+    dataCache.costLimit = kDataCacheCostLimit;
     
+    self = [self _initWithName:name memoryCache:memoryCache diskCache:diskCache dataCache:dataCache keyPrefix:nil];
+    __weak typeof(self) _self = self;
+    memoryCache.didEvictObjectWithTTLBlock = ^(YYMemoryCache *cache, id key, id object, NSUInteger cost, NSTimeInterval softTTL, NSTimeInterval hardTTL) {
+        __strong typeof(_self) self = _self;
+        [self _didEvictObject:object forKey:key softTTL:softTTL hardTTL:hardTTL];
+    };
+    return self;
+}
+
+/// The memory cache, disk cache and data cache may be shared by the caches in a group,
+/// then the keys are prefixed, and the owner should route the memory evictions.
+- (instancetype)_initWithName:(NSString *)name
+                  memoryCache:(YYMemoryCache *)memoryCache
+                    diskCache:(YYDiskCache *)diskCache
+                    dataCache:(YYMemoryCache *)dataCache
+                    keyPrefix:(NSString *)keyPrefix {
     self = [super init];
     _name = name;
     _diskCache = diskCache;
     _memoryCache = memoryCache;
+    _dataCache = dataCache;
+    _keyPrefix = keyPrefix.copy;
+    _lock = dispatch_semaphore_create(1);
+    _writeQueue = dispatch_queue_create("com.ibireme.cache.write", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(_writeQueue, &kWriteQueueSpecificKey, (__bridge void *)self, NULL);
+    _pendingWrites = [NSMutableDictionary new];
+    _writePolicy = YYCacheWritePolicySync;
+    _tieringPolicy = YYCacheTieringPolicyInclusive;
+    _spillKeys = [NSMutableArray new];
+    _spillWrites = [NSMutableDictionary new];
+    _promotionHistory = [YYMemoryCache new];
+    _promotionHistory.countLimit = kPromotionHistoryCountLimit;
+    _promotionHistory.shouldRemoveAllObjectsWhenEnteringBackground = NO;
+    _negativeCache = [YYMemoryCache new];
+    _negativeCache.countLimit = kNegativeCacheCountLimit;
+    _versions = calloc(kVersionStripeCount, sizeof(_YYCacheVersionStripe));
+    _hotKeysLimit = 0;
+    _hotKeysRecordInterval = 60;
     return self;
 }
 
+- (void)dealloc {
+    free(_versions);
+}
+
+/// Called when an object is evicted from memory cache by limits.
+- (void)_didEvictObject:(id)object forKey:(id)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL {
+    if (self.spillsEvictedObjects || self.tieringPolicy == YYCacheTieringPolicyExclusive) {
+        [self _spillObject:object forKey:key softTTL:softTTL hardTTL:hardTTL];
+    }
+}
+
 + (instancetype)cacheWithName:(NSString *)name {
     return [[self alloc] initWithName:name];
 }
@@ -54,85 +403,704 @@
     return [[self alloc] initWithPath:path];
 }
 
+/// Cache a negative entry for a key which is not found in both tiers.
+- (void)_setNegativeEntryForKey:(NSString *)key version:(_YYCacheVersion)version {
+    NSTimeInterval ttl = self.negativeCacheTTL;
+    if (ttl <= 0 || !key || !version.valid) return;
+    // not for the key set during the lookup, a set removes the entry after its version
+    [_negativeCache setObject:@YES forKey:key withCost:0 softTTL:0 hardTTL:ttl condition:^BOOL(id currentObject) {
+        return [self _isCurrentVersion:version forKey:key];
+    }];
+}
+
+/// Whether the key is known not to exist, should be checked after a memory cache miss.
+- (BOOL)_hasNegativeEntryForKey:(NSString *)key {
+    if (self.negativeCacheTTL <= 0) return NO;
+    return [_negativeCache objectForKey:key] != nil;
+}
+
 - (BOOL)containsObjectForKey:(NSString *)key {
-    return [_memoryCache containsObjectForKey:key] || [_diskCache containsObjectForKey:key];
+    return [self _containsObjectForKey:[self _storageKeyForKey:key]];
+}
+
+- (BOOL)_containsObjectForKey:(NSString *)key {
+    if ([_memoryCache containsObjectForKey:key]) return YES;
+    if ([self _hasNegativeEntryForKey:key]) return NO;
+    _YYCachePendingWrite *write = [self _pendingWriteForKey:key];
+    if (write) {
+        return write->_object && (write->_hardExpireTime <= 0 || write->_hardExpireTime > time(NULL));
+    }
+    return [_diskCache containsObjectForKey:key];
 }
 
 - (void)containsObjectForKey:(NSString *)key withBlock:(void (^)(NSString *key, BOOL contains))block {
     if (!block) return;
     
-    if ([_memoryCache containsObjectForKey:key]) {
+    NSString *storageKey = [self _storageKeyForKey:key];
+    BOOL memory = [_memoryCache containsObjectForKey:storageKey];
+    if (memory || [self _hasNegativeEntryForKey:storageKey]) {
+        BOOL contains = memory;
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            block(key, contains);
+        });
+    } else if ([self _pendingWriteForKey:storageKey]) {
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-            block(key, YES);
+            block(key, [self _containsObjectForKey:storageKey]);
         });
-    } else  {
+    } else if (!_keyPrefix) {
         [_diskCache containsObjectForKey:key withBlock:block];
+    } else {
+        [_diskCache containsObjectForKey:storageKey withBlock:^(NSString *storageKey, BOOL contains) {
+            block(key, contains);
+        }];
+    }
+}
+
+- (void)containsObjectForKey:(NSString *)key queue:(dispatch_queue_t)queue withBlock:(void (^)(NSString *key, BOOL contains))block {
+    if (!block) return;
+    NSString *storageKey = [self _storageKeyForKey:key];
+    BOOL memory = [_memoryCache containsObjectForKey:storageKey];
+    if (memory || [self _hasNegativeEntryForKey:storageKey]) {
+        block(key, memory);
+        return;
+    }
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        BOOL contains = [self _containsObjectForKey:storageKey];
+        if (queue) {
+            dispatch_async(queue, ^{
+                block(key, contains);
+            });
+        } else {
+            block(key, contains);
+        }
+    });
+}
+
+/// Read an object from disk cache (or the queued write), the item is used to promote the object.
+- (id<NSCoding>)_diskObjectForKey:(NSString *)key version:(_YYCacheVersion)version item:(YYKVStorageItem **)outItem {
+    _YYCachePendingWrite *write = [self _pendingWriteForKey:key];
+    if (write) {
+        if (!write->_object) return nil;
+        if (write->_hardExpireTime > 0 && write->_hardExpireTime <= time(NULL)) return nil;
+        if (outItem) {
+            YYKVStorageItem *item = [YYKVStorageItem new];
+            item.key = key;
+            item.softExpireTime = write->_softExpireTime;
+            item.hardExpireTime = write->_hardExpireTime;
+            *outItem = item;
+        }
+        return write->_object;
+    }
+    YYKVStorageItem *item = [self _dataItemForKey:key];
+    if (!item) {
+        item = [_diskCache itemForKey:key];
+        if (!item) return nil;
+        [self _setDataItem:item version:version];
+    }
+    id<NSCoding> object = [_diskCache objectFromItem:item];
+    if (object && outItem) *outItem = item;
+    return object;
+}
+
+/// Returns the archived item in data cache, nil if not exists or disabled.
+- (YYKVStorageItem *)_dataItemForKey:(NSString *)key {
+    if (!self.dataCacheEnabled) return nil;
+    YYKVStorageItem *item = [_dataCache objectForKey:key];
+    if (item && item.hardExpireTime > 0 && item.hardExpireTime <= time(NULL)) {
+        [_dataCache removeObjectForKey:key];
+        return nil;
+    }
+    return item;
+}
+
+/// Cache an archived item read from disk cache, if no mutation of the key since the version.
+- (void)_setDataItem:(YYKVStorageItem *)item version:(_YYCacheVersion)version {
+    if (!self.dataCacheEnabled || !item.key || !item.value || !version.valid) return;
+    NSString *key = item.key;
+    [_dataCache setObject:item forKey:key withCost:item.value.length softTTL:0 hardTTL:0 condition:^BOOL(id currentObject) {
+        return [self _isCurrentVersion:version forKey:key];
+    }];
+}
+
+/// Promote an object read from disk cache to memory cache, with its TTLs.
+/// Returns NO if the key is set or removed since the version, the object is stale.
+- (BOOL)_promoteObject:(id<NSCoding>)object item:(YYKVStorageItem *)item forKey:(NSString *)key version:(_YYCacheVersion)version {
+    if (!version.valid) return NO;
+    long now = time(NULL);
+    NSUInteger cost = self.promotionCostLimit > 0 ? item.size : 0;
+    return [_memoryCache setObject:object forKey:key withCost:cost
+                           softTTL:_YYCacheRemainingTTL(item.softExpireTime, now)
+                           hardTTL:_YYCacheRemainingTTL(item.hardExpireTime, now)
+                         condition:^BOOL(id currentObject) {
+                             return [self _isCurrentVersion:version forKey:key];
+                         }];
+}
+
+/// Whether an object read from disk cache should be promoted, with `tieringPolicy` and `promotionCostLimit`.
+- (BOOL)_shouldPromoteItem:(YYKVStorageItem *)item forKey:(NSString *)key {
+    NSUInteger costLimit = self.promotionCostLimit;
+    if (costLimit > 0 && item.size > costLimit) return NO;
+    if (self.tieringPolicy == YYCacheTieringPolicyPromoteOnSecondHit) {
+        if (![_promotionHistory containsObjectForKey:key]) {
+            [_promotionHistory setObject:@YES forKey:key];
+            return NO;
+        }
+        [_promotionHistory removeObjectForKey:key];
+    }
+    return YES;
+}
+
+/// Promote an object read from disk cache if needed.
+- (void)_promoteIfNeededObject:(id<NSCoding>)object item:(YYKVStorageItem *)item forKey:(NSString *)key version:(_YYCacheVersion)version {
+    if (![self _shouldPromoteItem:item forKey:key]) return;
+    if (![self _promoteObject:object item:item forKey:key version:version]) return;
+    if (self.tieringPolicy == YYCacheTieringPolicyExclusive) {
+        [self _queueDiskRemoveForMovedKey:key block:nil];
+    }
+}
+
+/// Promote the objects read from disk cache if needed, in one memory cache pass.
+/// The versions is key -> NSValue of _YYCacheVersion.
+- (void)_promoteIfNeededObjects:(NSDictionary *)objects items:(NSDictionary *)items versions:(NSDictionary *)versions {
+    NSMutableArray *keys = [NSMutableArray new];
+    NSMutableArray *values = [NSMutableArray new];
+    NSMutableArray *costs = [NSMutableArray new];
+    NSMutableArray *softTTLs = [NSMutableArray new];
+    NSMutableArray *hardTTLs = [NSMutableArray new];
+    BOOL costAware = self.promotionCostLimit > 0;
+    long now = time(NULL);
+    for (NSString *key in objects) {
+        YYKVStorageItem *item = items[key];
+        if (!_YYCacheVersionFromValue(versions[key]).valid) continue;
+        if (![self _shouldPromoteItem:item forKey:key]) continue;
+        [keys addObject:key];
+        [values addObject:objects[key]];
+        [costs addObject:@(costAware ? item.size : 0)];
+        [softTTLs addObject:@(_YYCacheRemainingTTL(item.softExpireTime, now))];
+        [hardTTLs addObject:@(_YYCacheRemainingTTL(item.hardExpireTime, now))];
+    }
+    if (keys.count == 0) return;
+    NSMutableArray *promotedKeys = [NSMutableArray new];
+    [_memoryCache setObjects:values forKeys:keys withCosts:costs softTTLs:softTTLs hardTTLs:hardTTLs condition:^BOOL(id key, id currentObject) {
+        if (![self _isCurrentVersion:_YYCacheVersionFromValue(versions[key]) forKey:key]) return NO;
+        [promotedKeys addObject:key]; // in memory cache's lock
+        return YES;
+    }];
+    if (self.tieringPolicy == YYCacheTieringPolicyExclusive) {
+        for (NSString *key in promotedKeys) {
+            [self _queueDiskRemoveForMovedKey:key block:nil];
+        }
+    }
+}
+
+/// Whether a spill of the evicted object should replace the pending write of the key,
+/// should be called in lock. A set or remove after the eviction is newer than the object.
+- (BOOL)_canSpillOverPendingWrite:(_YYCachePendingWrite *)pending forKey:(NSString *)key {
+    if (!pending) return YES;
+    if (pending == _spillWrites[key]) return YES; // an older eviction of the key
+    return pending->_moved;
+}
+
+/// Spill an object evicted from memory cache to disk cache later, with its remaining TTLs.
+/// The key is skipped if it's set or removed after the eviction, or already on disk.
+- (void)_spillObject:(id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL {
+    if (![(id)key isKindOfClass:[NSString class]] || !object) return;
+    if ([_memoryCache containsObjectForKey:key]) return; // set again after the eviction
+    Lock();
+    _YYCachePendingWrite *pending = _pendingWrites[key];
+    BOOL spill = [self _canSpillOverPendingWrite:pending forKey:key];
+    Unlock();
+    if (!spill) return;
+    if (!pending && self.tieringPolicy != YYCacheTieringPolicyExclusive && self.writePolicy != YYCacheWritePolicyMemoryOnly) {
+        if ([_diskCache containsObjectForKey:key]) return; // written through when set
+    }
+    
+    long now = time(NULL);
+    _YYCachePendingWrite *write = [_YYCachePendingWrite new];
+    write->_object = object;
+    write->_softExpireTime = _YYCacheExpireTime(softTTL, now);
+    write->_hardExpireTime = _YYCacheExpireTime(hardTTL, now);
+    Lock();
+    if (_pendingWrites[key] != pending) { // set or removed during the disk lookup
+        spill = [self _canSpillOverPendingWrite:_pendingWrites[key] forKey:key];
+    }
+    if (!spill) {
+        Unlock();
+        return;
     }
+    _pendingWrites[key] = write;
+    _spillWrites[key] = write;
+    [_spillKeys addObject:key];
+    BOOL schedule = !_spillScheduled;
+    if (schedule) _spillScheduled = YES;
+    Unlock();
+    [_negativeCache removeObjectForKey:key]; // set to memoryCache directly
+    // a set which did not see the pending spill has changed memory cache before the disk,
+    // and the later sets are queued after it, which cancel it
+    if ([_memoryCache containsObjectForKey:key]) {
+        Lock();
+        if (_pendingWrites[key] == write) [_pendingWrites removeObjectForKey:key];
+        if (_spillWrites[key] == write) [_spillWrites removeObjectForKey:key];
+        Unlock();
+    }
+    if (schedule) [self _scheduleSpill];
+}
+
+/// Write a batch of spilled objects every `kSpillInterval` seconds, until no more.
+- (void)_scheduleSpill {
+    Lock();
+    NSUInteger count = _spillKeys.count;
+    Unlock();
+    NSTimeInterval delay = count >= kSpillBacklogLimit ? 0 : kSpillInterval;
+    // hold self until the objects are spilled
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _writeQueue, ^{
+        [self _writeSpilledObjectsWithLimit:kSpillBatchCount];
+        Lock();
+        BOOL more = self->_spillKeys.count > 0;
+        if (!more) self->_spillScheduled = NO;
+        Unlock();
+        if (more) [self _scheduleSpill];
+    });
+}
+
+/// Write the spilled objects to disk cache in one transaction, should be called in write queue.
+- (void)_writeSpilledObjectsWithLimit:(NSUInteger)limit {
+    NSMutableArray *keys = [NSMutableArray new];
+    NSMutableArray *writes = [NSMutableArray new];
+    Lock();
+    NSUInteger count = MIN(limit, _spillKeys.count);
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *key = _spillKeys[i];
+        _YYCachePendingWrite *write = _spillWrites[key];
+        if (!write) continue; // the newer spill of same key is taken
+        [_spillWrites removeObjectForKey:key];
+        if (_pendingWrites[key] != write) continue; // cancelled by a set or remove
+        [keys addObject:key];
+        [writes addObject:write];
+    }
+    [_spillKeys removeObjectsInRange:NSMakeRange(0, count)];
+    Unlock();
+    if (keys.count == 0) return;
+    
+    NSMutableArray *objects = [NSMutableArray new];
+    NSMutableArray *softTTLs = [NSMutableArray new];
+    NSMutableArray *hardTTLs = [NSMutableArray new];
+    long now = time(NULL);
+    for (_YYCachePendingWrite *write in writes) {
+        [objects addObject:write->_object];
+        [softTTLs addObject:@(_YYCacheRemainingTTL(write->_softExpireTime, now))];
+        [hardTTLs addObject:@(_YYCacheRemainingTTL(write->_hardExpireTime, now))];
+    }
+    [_diskCache setObjects:objects forKeys:keys softTTLs:softTTLs hardTTLs:hardTTLs];
+    for (NSString *key in keys) {
+        [_dataCache removeObjectForKey:key];
+    }
+    
+    Lock();
+    for (NSUInteger i = 0, max = keys.count; i < max; i++) {
+        if (_pendingWrites[keys[i]] == writes[i]) [_pendingWrites removeObjectForKey:keys[i]];
+    }
+    Unlock();
 }
 
 - (id<NSCoding>)objectForKey:(NSString *)key {
-    id<NSCoding> object = [_memoryCache objectForKey:key];
-    if (!object) {
-        object = [_diskCache objectForKey:key];
+    return [self objectForKey:key needsRefresh:NULL];
+}
+
+- (id<NSCoding>)objectForKey:(NSString *)key needsRefresh:(BOOL *)needsRefresh {
+    return [self _objectForKey:[self _storageKeyForKey:key] needsRefresh:needsRefresh];
+}
+
+- (id<NSCoding>)_objectForKey:(NSString *)key needsRefresh:(BOOL *)needsRefresh {
+    BOOL stale = NO;
+    YYCacheTraceTier tier = YYCacheTraceTierMemory;
+    NSUInteger size = 0;
+    id<NSCoding> object = [_memoryCache objectForKey:key needsRefresh:&stale];
+    if (!object && ![self _hasNegativeEntryForKey:key]) {
+        YYKVStorageItem *item = nil;
+        _YYCacheVersion version = [self _versionForKey:key];
+        object = [self _diskObjectForKey:key version:version item:&item];
+        tier = YYCacheTraceTierDisk;
+        size = item.value.length;
         if (object) {
-            [_memoryCache setObject:object forKey:key];
+            stale = item.softExpireTime > 0 && item.softExpireTime <= time(NULL);
+            [self _promoteIfNeededObject:object item:item forKey:key version:version];
+        } else {
+            [self _setNegativeEntryForKey:key version:version];
         }
     }
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        [recorder recordOperation:YYCacheTraceOperationGet tier:tier key:key size:size
+                           result:object ? YYCacheTraceResultHit : YYCacheTraceResultMiss];
+    }
+    if (needsRefresh) *needsRefresh = stale;
     return object;
 }
 
 - (void)objectForKey:(NSString *)key withBlock:(void (^)(NSString *key, id<NSCoding> object))block {
     if (!block) return;
-    id<NSCoding> object = [_memoryCache objectForKey:key];
-    if (object) {
+    [self objectForKey:key withRefreshBlock:^(NSString *key, id<NSCoding> object, BOOL needsRefresh) {
+        block(key, object);
+    }];
+}
+
+- (void)objectForKey:(NSString *)key withRefreshBlock:(void (^)(NSString *key, id<NSCoding> object, BOOL needsRefresh))block {
+    if (!block) return;
+    BOOL stale = NO;
+    NSString *storageKey = [self _storageKeyForKey:key];
+    id<NSCoding> object = [_memoryCache objectForKey:storageKey needsRefresh:&stale];
+    if (object || [self _hasNegativeEntryForKey:storageKey]) {
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-            block(key, object);
+            block(key, object, object ? stale : NO);
         });
     } else {
-        [_diskCache objectForKey:key withBlock:^(NSString *key, id<NSCoding> object) {
-            if (object && ![_memoryCache objectForKey:key]) {
-                [_memoryCache setObject:object forKey:key];
+        [self _diskObjectForKey:storageKey queue:nil withRefreshBlock:block];
+    }
+}
+
+- (void)objectForKey:(NSString *)key queue:(dispatch_queue_t)queue withBlock:(void (^)(NSString *key, id<NSCoding> object))block {
+    if (!block) return;
+    [self objectForKey:key queue:queue withRefreshBlock:^(NSString *key, id<NSCoding> object, BOOL needsRefresh) {
+        block(key, object);
+    }];
+}
+
+- (void)objectForKey:(NSString *)key queue:(dispatch_queue_t)queue withRefreshBlock:(void (^)(NSString *key, id<NSCoding> object, BOOL needsRefresh))block {
+    if (!block) return;
+    BOOL stale = NO;
+    NSString *storageKey = [self _storageKeyForKey:key];
+    id<NSCoding> object = [_memoryCache objectForKey:storageKey needsRefresh:&stale];
+    if (object) {
+        block(key, object, stale); // inline, no thread hop
+    } else if ([self _hasNegativeEntryForKey:storageKey]) {
+        block(key, nil, NO); // known not exists, inline
+    } else {
+        [self _diskObjectForKey:storageKey queue:queue withRefreshBlock:block];
+    }
+}
+
+/// Read an object from disk cache in background, and invoke the block in queue (or the background queue if nil).
+- (void)_diskObjectForKey:(NSString *)key queue:(dispatch_queue_t)queue withRefreshBlock:(void (^)(NSString *key, id<NSCoding> object, BOOL needsRefresh))block {
+    NSString *callbackKey = [self _keyForStorageKey:key];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        YYKVStorageItem *item = nil;
+        _YYCacheVersion version = [self _versionForKey:key];
+        id<NSCoding> object = [self _diskObjectForKey:key version:version item:&item];
+        BOOL stale = NO;
+        if (object) {
+            stale = item.softExpireTime > 0 && item.softExpireTime <= time(NULL);
+            if (![self->_memoryCache containsObjectForKey:key]) {
+                [self _promoteIfNeededObject:object item:item forKey:key version:version];
             }
-            block(key, object);
-        }];
+        } else {
+            [self _setNegativeEntryForKey:key version:version];
+        }
+        if (queue) {
+            dispatch_async(queue, ^{
+                block(callbackKey, object, stale);
+            });
+        } else {
+            block(callbackKey, object, stale);
+        }
+    });
+}
+
+- (NSDictionary<NSString *, id<NSCoding>> *)objectsForKeys:(NSArray<NSString *> *)keys {
+    if (!_keyPrefix) return [self _objectsForKeys:keys];
+    NSMutableArray *storageKeys = [NSMutableArray arrayWithCapacity:keys.count];
+    for (NSString *key in keys) {
+        [storageKeys addObject:[self _storageKeyForKey:key]];
+    }
+    NSMutableDictionary *objects = [NSMutableDictionary new];
+    [[self _objectsForKeys:storageKeys] enumerateKeysAndObjectsUsingBlock:^(NSString *storageKey, id object, BOOL *stop) {
+        objects[[self _keyForStorageKey:storageKey]] = object;
+    }];
+    return objects;
+}
+
+- (NSMutableDictionary *)_objectsForKeys:(NSArray<NSString *> *)keys {
+    NSMutableDictionary *objects = [NSMutableDictionary new];
+    if (keys.count == 0) return objects;
+    [objects addEntriesFromDictionary:[_memoryCache objectsForKeys:keys]];
+    NSMutableSet *negativeKeys = nil;
+    if (objects.count < keys.count && self.negativeCacheTTL > 0) {
+        for (NSString *key in keys) {
+            if (objects[key] || ![_negativeCache objectForKey:key]) continue;
+            if (!negativeKeys) negativeKeys = [NSMutableSet new];
+            [negativeKeys addObject:key];
+        }
+    }
+    if (objects.count + negativeKeys.count == keys.count) {
+        [self _recordGetsForKeys:keys objects:objects items:nil negativeKeys:negativeKeys];
+        return objects;
+    }
+    
+    // the queued writes are newer than disk cache
+    NSMutableArray *diskKeys = [NSMutableArray new];
+    NSMutableDictionary *items = [NSMutableDictionary new];
+    NSMutableDictionary *pendingObjects = [NSMutableDictionary new];
+    NSMutableDictionary *versions = [NSMutableDictionary new];
+    for (NSString *key in keys) {
+        if (objects[key] || [negativeKeys containsObject:key]) continue;
+        versions[key] = _YYCacheVersionValue([self _versionForKey:key]);
+    }
+    int now = (int)time(NULL);
+    Lock();
+    for (NSString *key in keys) {
+        if (objects[key] || [negativeKeys containsObject:key]) continue;
+        _YYCachePendingWrite *write = _pendingWrites.count ? _pendingWrites[key] : nil;
+        if (!write) {
+            [diskKeys addObject:key];
+        } else if (write->_object && (write->_hardExpireTime <= 0 || write->_hardExpireTime > now)) {
+            YYKVStorageItem *item = [YYKVStorageItem new];
+            item.key = key;
+            item.softExpireTime = write->_softExpireTime;
+            item.hardExpireTime = write->_hardExpireTime;
+            items[key] = item;
+            pendingObjects[key] = write->_object;
+        }
     }
+    Unlock();
+    
+    NSDictionary *diskObjects = nil;
+    if (diskKeys.count) {
+        NSMutableArray *diskItems = [NSMutableArray new];
+        NSMutableArray *missedKeys = [NSMutableArray new];
+        for (NSString *key in diskKeys) {
+            YYKVStorageItem *item = [self _dataItemForKey:key];
+            if (item) [diskItems addObject:item];
+            else [missedKeys addObject:key];
+        }
+        if (missedKeys.count) {
+            for (YYKVStorageItem *item in [_diskCache itemsForKeys:missedKeys]) {
+                [self _setDataItem:item version:_YYCacheVersionFromValue(versions[item.key])];
+                [diskItems addObject:item];
+            }
+        }
+        for (YYKVStorageItem *item in diskItems) {
+            items[item.key] = item;
+        }
+        diskObjects = [_diskCache objectsFromItems:diskItems];
+    }
+    
+    NSMutableDictionary *loaded = pendingObjects;
+    [loaded addEntriesFromDictionary:diskObjects];
+    [self _promoteIfNeededObjects:loaded items:items versions:versions];
+    [objects addEntriesFromDictionary:loaded];
+    if (self.negativeCacheTTL > 0) {
+        for (NSString *key in diskKeys) {
+            if (!loaded[key]) [self _setNegativeEntryForKey:key version:_YYCacheVersionFromValue(versions[key])];
+        }
+    }
+    [self _recordGetsForKeys:keys objects:objects items:items negativeKeys:negativeKeys];
+    return objects;
+}
+
+/// Records a multi-get, the keys in `items` (or missed, but not negative) were read from disk.
+- (void)_recordGetsForKeys:(NSArray<NSString *> *)keys objects:(NSDictionary *)objects items:(NSDictionary *)items negativeKeys:(NSSet *)negativeKeys {
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (!recorder) return;
+    for (NSString *key in keys) {
+        YYKVStorageItem *item = items[key];
+        BOOL hit = objects[key] != nil;
+        BOOL memory = hit ? !item : [negativeKeys containsObject:key];
+        [recorder recordOperation:YYCacheTraceOperationGet
+                             tier:memory ? YYCacheTraceTierMemory : YYCacheTraceTierDisk
+                              key:key
+                             size:item.value.length
+                           result:hit ? YYCacheTraceResultHit : YYCacheTraceResultMiss];
+    }
+}
+
+- (void)objectsForKeys:(NSArray<NSString *> *)keys withBlock:(void (^)(NSDictionary<NSString *, id<NSCoding>> *objects))block {
+    if (!block) return;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSDictionary *objects = [self objectsForKeys:keys];
+        block(objects);
+    });
 }
 
 - (void)setObject:(id<NSCoding>)object forKey:(NSString *)key {
-    [_memoryCache setObject:object forKey:key];
-    [_diskCache setObject:object forKey:key];
+    [self setObject:object forKey:key softTTL:0 hardTTL:0];
 }
 
 - (void)setObject:(id<NSCoding>)object forKey:(NSString *)key withBlock:(void (^)(void))block {
-    [_memoryCache setObject:object forKey:key];
-    [_diskCache setObject:object forKey:key withBlock:block];
+    [self setObject:object forKey:key softTTL:0 hardTTL:0 withBlock:block];
+}
+
+- (void)setObject:(id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL {
+    NSString *storageKey = [self _storageKeyForKey:key];
+    [self _beginMutationForKey:storageKey];
+    [_memoryCache setObject:object forKey:storageKey withCost:0 softTTL:softTTL hardTTL:hardTTL];
+    [self _diskSetObject:object forKey:storageKey softTTL:softTTL hardTTL:hardTTL block:nil];
+    [self _recordOperation:object ? YYCacheTraceOperationSet : YYCacheTraceOperationRemove forKey:storageKey];
+}
+
+- (void)setObject:(id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL withBlock:(void (^)(void))block {
+    NSString *storageKey = [self _storageKeyForKey:key];
+    [self _beginMutationForKey:storageKey];
+    [_memoryCache setObject:object forKey:storageKey withCost:0 softTTL:softTTL hardTTL:hardTTL];
+    [self _diskSetObject:object forKey:storageKey softTTL:softTTL hardTTL:hardTTL block:block ? block : ^{}];
+    [self _recordOperation:object ? YYCacheTraceOperationSet : YYCacheTraceOperationRemove forKey:storageKey];
 }
 
 - (void)removeObjectForKey:(NSString *)key {
-    [_memoryCache removeObjectForKey:key];
-    [_diskCache removeObjectForKey:key];
+    NSString *storageKey = [self _storageKeyForKey:key];
+    [self _beginMutationForKey:storageKey];
+    [_memoryCache removeObjectForKey:storageKey];
+    [self _diskSetObject:nil forKey:storageKey softTTL:0 hardTTL:0 block:nil];
+    [self _recordOperation:YYCacheTraceOperationRemove forKey:storageKey];
 }
 
 - (void)removeObjectForKey:(NSString *)key withBlock:(void (^)(NSString *key))block {
-    [_memoryCache removeObjectForKey:key];
-    [_diskCache removeObjectForKey:key withBlock:block];
+    NSString *storageKey = [self _storageKeyForKey:key];
+    [self _beginMutationForKey:storageKey];
+    [_memoryCache removeObjectForKey:storageKey];
+    [self _diskSetObject:nil forKey:storageKey softTTL:0 hardTTL:0 block:^{
+        if (block) block(key);
+    }];
+    [self _recordOperation:YYCacheTraceOperationRemove forKey:storageKey];
+}
+
+/// Remove all objects of this cache from memory cache and data cache, and cancel the queued writes.
+/// Only the objects with key prefix are removed if in a group.
+- (void)_removeAllObjectsInMemory {
+    if (_keyPrefix) {
+        NSString *prefix = _keyPrefix;
+        BOOL (^predicate)(id key) = ^BOOL(id key) {
+            return [key isKindOfClass:[NSString class]] && [key hasPrefix:prefix];
+        };
+        [_memoryCache removeObjectsForKeysPassingTest:predicate];
+        [_dataCache removeObjectsForKeysPassingTest:predicate];
+    } else {
+        [_memoryCache removeAllObjects];
+        [_dataCache removeAllObjects];
+    }
+    [_negativeCache removeAllObjects];
+    Lock();
+    [_pendingWrites removeAllObjects];
+    [_spillWrites removeAllObjects];
+    [_spillKeys removeAllObjects];
+    Unlock();
 }
 
 - (void)removeAllObjects {
-    [_memoryCache removeAllObjects];
-    [_diskCache removeAllObjects];
+    [self _beginMutationForAll];
+    [self _removeAllObjectsInMemory];
+    // after the queued writes
+    [self _performInWriteQueueAndWait:^{
+        if (self->_keyPrefix) [self->_diskCache removeObjectsWithKeyPrefix:self->_keyPrefix];
+        else [self->_diskCache removeAllObjects];
+    }];
+    [self _endMutationForAll];
 }
 
 - (void)removeAllObjectsWithBlock:(void(^)(void))block {
-    [_memoryCache removeAllObjects];
-    [_diskCache removeAllObjectsWithBlock:block];
+    [self _beginMutationForAll];
+    [self _removeAllObjectsInMemory];
+    dispatch_async(_writeQueue, ^{
+        if (self->_keyPrefix) [self->_diskCache removeObjectsWithKeyPrefix:self->_keyPrefix];
+        else [self->_diskCache removeAllObjects];
+        [self _endMutationForAll];
+        _YYCacheCallBack(block);
+    });
 }
 
 - (void)removeAllObjectsWithProgressBlock:(void(^)(int removedCount, int totalCount))progress
                                  endBlock:(void(^)(BOOL error))end {
-    [_memoryCache removeAllObjects];
-    [_diskCache removeAllObjectsWithProgressBlock:progress endBlock:end];
+    [self _beginMutationForAll];
+    [self _removeAllObjectsInMemory];
+    dispatch_async(_writeQueue, ^{
+        if (self->_keyPrefix) { // no progress for the objects in a group
+            [self->_diskCache removeObjectsWithKeyPrefix:self->_keyPrefix];
+            [self _endMutationForAll];
+            if (end) _YYCacheCallBack(^{ end(NO); });
+            return;
+        }
+        [self->_diskCache removeAllObjectsWithProgressBlock:progress endBlock:^(BOOL error) {
+            [self _endMutationForAll];
+            if (end) end(error);
+        }];
+    });
+}
+
+- (void)flush {
+    [self _performInWriteQueueAndWait:^{
+        [self _writeSpilledObjectsWithLimit:NSUIntegerMax];
+    }];
+}
+
+- (void)flushWithBlock:(void(^)(void))block {
+    dispatch_async(_writeQueue, ^{
+        [self _writeSpilledObjectsWithLimit:NSUIntegerMax];
+        _YYCacheCallBack(block);
+    });
+}
+
+- (NSUInteger)hotKeysLimit {
+    Lock();
+    NSUInteger limit = _hotKeysLimit;
+    Unlock();
+    return limit;
+}
+
+- (void)setHotKeysLimit:(NSUInteger)hotKeysLimit {
+    Lock();
+    _hotKeysLimit = hotKeysLimit;
+    BOOL start = hotKeysLimit > 0 && !_hotKeysRecording;
+    if (start) _hotKeysRecording = YES;
+    Unlock();
+    if (start) [self _recordHotKeysRecursively];
+}
+
+- (void)recordHotKeys {
+    NSUInteger limit = self.hotKeysLimit;
+    if (limit == 0) return;
+    NSMutableArray *hotKeys = [NSMutableArray new];
+    for (id key in [_memoryCache recentlyUsedKeysWithLimit:limit]) {
+        if (![key isKindOfClass:[NSString class]]) continue;
+        if (_keyPrefix && ![key hasPrefix:_keyPrefix]) continue; // other namespace in group
+        [hotKeys addObject:[self _keyForStorageKey:key]];
+    }
+    // the memory cache may be emptied (such as entering background), keep the last record
+    if (hotKeys.count == 0) return;
     
+    Lock();
+    BOOL changed = ![_lastHotKeys isEqualToArray:hotKeys];
+    if (changed) _lastHotKeys = hotKeys;
+    Unlock();
+    if (changed) [hotKeys writeToFile:[self _hotKeysPath] atomically:YES];
+}
+
+- (void)warmupWithCountLimit:(NSUInteger)countLimit
+                   timeLimit:(NSTimeInterval)timeLimit
+                  completion:(void(^)(NSUInteger loadedCount))completion {
+    __weak typeof(self) _self = self;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+        __strong typeof(_self) self = _self;
+        NSUInteger loaded = 0;
+        NSArray *hotKeys = self ? [NSArray arrayWithContentsOfFile:[self _hotKeysPath]] : nil;
+        NSDate *begin = [NSDate date];
+        for (NSString *key in hotKeys) {
+            if (loaded >= countLimit) break;
+            if (-[begin timeIntervalSinceNow] > timeLimit) break;
+            if (self.memoryCache.totalCount >= self.memoryCache.countLimit) break;
+            if (![key isKindOfClass:[NSString class]]) continue;
+            NSString *storageKey = [self _storageKeyForKey:key];
+            if ([self.memoryCache containsObjectForKey:storageKey]) continue;
+            @autoreleasepool {
+                YYKVStorageItem *item = nil;
+                _YYCacheVersion version = [self _versionForKey:storageKey];
+                id<NSCoding> object = [self _diskObjectForKey:storageKey version:version item:&item];
+                // do not overwrite the object which is set after warmup began
+                if (object && [self _promoteObject:object item:item forKey:storageKey version:version]) {
+                    loaded++;
+                }
+            }
+        }
+        if (completion) completion(loaded);
+    });
 }
 
 - (NSString *)description {
@@ -0,0 +1,149 @@
+//
+//  YYCacheGroup.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+@class YYCache, YYMemoryCache, YYDiskCache;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ YYCacheGroup is a set of named caches (namespaces) over one memory cache and one
+ disk cache.
+
+ @discussion Each `YYCache` created with `initWithName:` has its own sqlite database,
+ trim timers and limits. A group shares them: the namespaces store their objects in
+ the same `memoryCache` and `diskCache` with a key prefix, so there is one database
+ and one trimmer for each tier, and the limits of these two caches are the global
+ budget of the group. Objects of all namespaces are evicted together in the order of
+ the caches' policies, so the space moves to whichever namespace is hot.
+
+ A namespace can also have its own disk quota, which is checked every
+ `autoTrimInterval` seconds. The quota only caps a namespace, it never reserves space.
+ */
+@interface YYCacheGroup : NSObject
+
+#pragma mark - Attribute
+///=============================================================================
+/// @name Attribute
+///=============================================================================
+
+/** The name of the group, readonly. */
+@property (copy, readonly) NSString *name;
+
+/** The path of the group's disk cache, readonly. */
+@property (copy, readonly) NSString *path;
+
+/** The shared memory cache, its limits are the memory budget of all namespaces. */
+@property (strong, readonly) YYMemoryCache *memoryCache;
+
+/** The shared disk cache, its limits are the disk budget of all namespaces. */
+@property (strong, readonly) YYDiskCache *diskCache;
+
+/**
+ The namespace quotas check time interval in seconds. Default is 60 (1 minute).
+ */
+@property NSTimeInterval autoTrimInterval;
+
+/** The names of the namespaces created, readonly. */
+@property (readonly) NSArray<NSString *> *namespaces;
+
+
+#pragma mark - Initializer
+///=============================================================================
+/// @name Initializer
+///=============================================================================
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+
+/**
+ Create a new group with the specified name.
+
+ @param name  The name of the group. It will create a dictionary with the name in
+     the app's caches dictionary for disk cache.
+ @result A new group object, or nil if an error occurs.
+ */
+- (nullable instancetype)initWithName:(NSString *)name;
+
+/**
+ Create a new group with the specified path.
+
+ @param path  Full path of a directory in which the group's disk cache writes data.
+     Once initialized you should not read and write to this directory.
+ @result A new group object, or nil if an error occurs.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path NS_DESIGNATED_INITIALIZER;
+
+/** Convenience initializer, see `initWithName:`. */
++ (nullable instancetype)groupWithName:(NSString *)name;
+
+/** Convenience initializer, see `initWithPath:`. */
++ (nullable instancetype)groupWithPath:(NSString *)path;
+
+
+#pragma mark - Namespace
+///=============================================================================
+/// @name Namespace
+///=============================================================================
+
+/**
+ Returns the cache of a namespace, creates it if not exists.
+
+ @discussion The returned cache works as a standalone `YYCache`, but its `memoryCache`
+ and `diskCache` are the group's shared caches (in which the keys are prefixed by the
+ namespace), so you should not change their limits for one namespace.
+ `removeAllObjects` of the cache only removes the objects in the namespace.
+
+ @param name The name of the namespace. It should not be empty, and should not
+     contain '/' or the unit separator (0x1F).
+ @return The cache of the namespace, the same instance for the same name.
+ */
+- (nullable YYCache *)cacheForNamespace:(NSString *)name;
+
+/**
+ Sets the maximum total cost (in bytes) the disk cache can hold for a namespace.
+ 0 means no quota (default), the namespace is only limited by the group's budget.
+ */
+- (void)setCostLimit:(NSUInteger)costLimit forNamespace:(NSString *)name;
+
+/** Returns the maximum total cost of a namespace in disk cache, 0 means no quota. */
+- (NSUInteger)costLimitForNamespace:(NSString *)name;
+
+/**
+ Sets the maximum number of objects the disk cache can hold for a namespace.
+ 0 means no quota (default), the namespace is only limited by the group's budget.
+ */
+- (void)setCountLimit:(NSUInteger)countLimit forNamespace:(NSString *)name;
+
+/** Returns the maximum number of objects of a namespace in disk cache, 0 means no quota. */
+- (NSUInteger)countLimitForNamespace:(NSString *)name;
+
+/**
+ Returns the total cost (in bytes) of a namespace in disk cache.
+ This method may blocks the calling thread until file read finished.
+ */
+- (NSInteger)totalCostForNamespace:(NSString *)name;
+
+/**
+ Returns the number of objects of a namespace in disk cache.
+ This method may blocks the calling thread until file read finished.
+ */
+- (NSInteger)totalCountForNamespace:(NSString *)name;
+
+/**
+ Removes objects from the namespaces which are over their quotas, with the disk
+ cache's `evictionPolicy`. This method may blocks the calling thread until finished.
+ */
+- (void)trimNamespaces;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,257 @@
+//
+//  YYCacheGroup.m
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYCacheGroup.h"
+#import "YYCache.h"
+#import "YYMemoryCache.h"
+#import "YYDiskCache.h"
+#import "YYCacheTrimScheduler.h"
+
+#define Lock() dispatch_semaphore_wait(self->_lock, DISPATCH_TIME_FOREVER)
+#define Unlock() dispatch_semaphore_signal(self->_lock)
+
+static NSString *const kNamespaceSeparator = @"\x1F"; ///< unit separator, between namespace and key
+static const NSUInteger kDataCacheCostLimit = 1024 * 1024 * 32; ///< 32MB of archived data, shared
+
+/// The namespace is a path component and a key prefix.
+static BOOL _YYCacheGroupIsValidNamespace(NSString *name) {
+    if (name.length == 0) return NO;
+    if ([name rangeOfString:@"/"].location != NSNotFound) return NO;
+    if ([name rangeOfString:kNamespaceSeparator].location != NSNotFound) return NO;
+    return YES;
+}
+
+/// Implemented in YYCache.m.
+@interface YYCache (YYCacheGroup)
+- (instancetype)_initWithName:(NSString *)name
+                  memoryCache:(YYMemoryCache *)memoryCache
+                    diskCache:(YYDiskCache *)diskCache
+                    dataCache:(YYMemoryCache *)dataCache
+                    keyPrefix:(NSString *)keyPrefix;
+- (void)_didEvictObject:(id)object forKey:(id)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL;
+@end
+
+/**
+ The quota of a namespace.
+ Typically, you should not use this class directly.
+ */
+@interface _YYCacheGroupQuota : NSObject {
+    @package
+    NSUInteger _costLimit; ///< 0 means no quota
+    NSUInteger _countLimit; ///< 0 means no quota
+}
+@end
+
+@implementation _YYCacheGroupQuota
+@end
+
+
+@interface YYCacheGroup () <YYCacheTrimming>
+@end
+
+@implementation YYCacheGroup {
+    dispatch_semaphore_t _lock;
+    YYMemoryCache *_dataCache;
+    NSMutableDictionary *_caches; ///< namespace -> YYCache
+    NSMutableDictionary *_quotas; ///< namespace -> _YYCacheGroupQuota
+    NSTimeInterval _autoTrimInterval;
+}
+
+#pragma mark - private
+
+- (void)trimToLimits {
+    [self trimNamespaces];
+}
+
+/// The quotas are checked every `autoTrimInterval`, not prioritized.
+- (double)trimPressure {
+    return 0;
+}
+
+- (NSString *)_keyPrefixForNamespace:(NSString *)name {
+    return [name stringByAppendingString:kNamespaceSeparator];
+}
+
+/// Route an object evicted from the shared memory cache to the namespace's cache.
+- (void)_didEvictObject:(id)object forKey:(id)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL {
+    if (![key isKindOfClass:[NSString class]]) return;
+    NSRange range = [key rangeOfString:kNamespaceSeparator];
+    if (range.location == NSNotFound) return;
+    NSString *name = [key substringToIndex:range.location];
+    Lock();
+    YYCache *cache = _caches[name];
+    Unlock();
+    [cache _didEvictObject:object forKey:key softTTL:softTTL hardTTL:hardTTL];
+}
+
+- (_YYCacheGroupQuota *)_quotaForNamespace:(NSString *)name create:(BOOL)create {
+    _YYCacheGroupQuota *quota = _quotas[name];
+    if (!quota && create) {
+        quota = [_YYCacheGroupQuota new];
+        _quotas[name] = quota;
+    }
+    return quota;
+}
+
+#pragma mark - public
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYCacheGroup init error" reason:@"YYCacheGroup must be initialized with a path. Use 'initWithName:' or 'initWithPath:' instead." userInfo:nil];
+    return [self initWithPath:@""];
+}
+
+- (instancetype)initWithName:(NSString *)name {
+    if (name.length == 0) return nil;
+    NSString *cacheFolder = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    NSString *path = [cacheFolder stringByAppendingPathComponent:name];
+    return [self initWithPath:path];
+}
+
+- (instancetype)initWithPath:(NSString *)path {
+    if (path.length == 0) return nil;
+    YYDiskCache *diskCache = [[YYDiskCache alloc] initWithPath:path];
+    if (!diskCache) return nil;
+    NSString *name = [path lastPathComponent];
+    YYMemoryCache *memoryCache = [YYMemoryCache new];
+    memoryCache.name = name;
+
+    self = [super init];
+    _name = name;
+    _path = path;
+    _memoryCache = memoryCache;
+    _diskCache = diskCache;
+    _autoTrimInterval = 60;
+    _lock = dispatch_semaphore_create(1);
+    _caches = [NSMutableDictionary new];
+    _quotas = [NSMutableDictionary new];
+    _dataCache = [YYMemoryCache new];
+    _dataCache.name = [name stringByAppendingString:@".data"];
+    _dataCache.costLimit = kDataCacheCostLimit;
+
+    __weak typeof(self) _self = self;
+    memoryCache.didEvictObjectWithTTLBlock = ^(YYMemoryCache *cache, id key, id object, NSUInteger cost, NSTimeInterval softTTL, NSTimeInterval hardTTL) {
+        __strong typeof(_self) self = _self;
+        [self _didEvictObject:object forKey:key softTTL:softTTL hardTTL:hardTTL];
+    };
+    [[YYCacheTrimScheduler sharedScheduler] registerCache:self];
+    return self;
+}
+
++ (instancetype)groupWithName:(NSString *)name {
+    return [[self alloc] initWithName:name];
+}
+
++ (instancetype)groupWithPath:(NSString *)path {
+    return [[self alloc] initWithPath:path];
+}
+
+- (YYCache *)cacheForNamespace:(NSString *)name {
+    if (!_YYCacheGroupIsValidNamespace(name)) return nil;
+    Lock();
+    YYCache *cache = _caches[name];
+    if (!cache) {
+        cache = [[YYCache alloc] _initWithName:name
+                                   memoryCache:_memoryCache
+                                     diskCache:_diskCache
+                                     dataCache:_dataCache
+                                     keyPrefix:[self _keyPrefixForNamespace:name]];
+        if (cache) _caches[name] = cache;
+    }
+    Unlock();
+    return cache;
+}
+
+- (NSArray *)namespaces {
+    Lock();
+    NSArray *names = _caches.allKeys;
+    Unlock();
+    return names;
+}
+
+- (void)setCostLimit:(NSUInteger)costLimit forNamespace:(NSString *)name {
+    if (!_YYCacheGroupIsValidNamespace(name)) return;
+    Lock();
+    [self _quotaForNamespace:name create:YES]->_costLimit = costLimit;
+    Unlock();
+}
+
+- (NSUInteger)costLimitForNamespace:(NSString *)name {
+    if (!name) return 0;
+    Lock();
+    _YYCacheGroupQuota *quota = [self _quotaForNamespace:name create:NO];
+    NSUInteger limit = quota ? quota->_costLimit : 0;
+    Unlock();
+    return limit;
+}
+
+- (void)setCountLimit:(NSUInteger)countLimit forNamespace:(NSString *)name {
+    if (!_YYCacheGroupIsValidNamespace(name)) return;
+    Lock();
+    [self _quotaForNamespace:name create:YES]->_countLimit = countLimit;
+    Unlock();
+}
+
+- (NSUInteger)countLimitForNamespace:(NSString *)name {
+    if (!name) return 0;
+    Lock();
+    _YYCacheGroupQuota *quota = [self _quotaForNamespace:name create:NO];
+    NSUInteger limit = quota ? quota->_countLimit : 0;
+    Unlock();
+    return limit;
+}
+
+- (NSInteger)totalCostForNamespace:(NSString *)name {
+    if (!_YYCacheGroupIsValidNamespace(name)) return 0;
+    return [_diskCache totalCostWithKeyPrefix:[self _keyPrefixForNamespace:name]];
+}
+
+- (NSInteger)totalCountForNamespace:(NSString *)name {
+    if (!_YYCacheGroupIsValidNamespace(name)) return 0;
+    return [_diskCache totalCountWithKeyPrefix:[self _keyPrefixForNamespace:name]];
+}
+
+- (void)trimNamespaces {
+    NSMutableDictionary *quotas = [NSMutableDictionary new];
+    Lock();
+    [_quotas enumerateKeysAndObjectsUsingBlock:^(NSString *name, _YYCacheGroupQuota *quota, BOOL *stop) {
+        _YYCacheGroupQuota *copied = [_YYCacheGroupQuota new]; // the limits may be changed during trim
+        copied->_costLimit = quota->_costLimit;
+        copied->_countLimit = quota->_countLimit;
+        quotas[name] = copied;
+    }];
+    Unlock();
+    [quotas enumerateKeysAndObjectsUsingBlock:^(NSString *name, _YYCacheGroupQuota *quota, BOOL *stop) {
+        NSString *prefix = [self _keyPrefixForNamespace:name];
+        if (quota->_costLimit > 0) [self->_diskCache trimToCost:quota->_costLimit withKeyPrefix:prefix];
+        if (quota->_countLimit > 0) [self->_diskCache trimToCount:quota->_countLimit withKeyPrefix:prefix];
+    }];
+}
+
+- (NSTimeInterval)autoTrimInterval {
+    Lock();
+    NSTimeInterval autoTrimInterval = _autoTrimInterval;
+    Unlock();
+    return autoTrimInterval;
+}
+
+- (void)setAutoTrimInterval:(NSTimeInterval)autoTrimInterval {
+    Lock();
+    _autoTrimInterval = autoTrimInterval;
+    Unlock();
+    [[YYCacheTrimScheduler sharedScheduler] rescheduleCache:self];
+}
+
+- (NSString *)description {
+    if (_name) return [NSString stringWithFormat:@"<%@: %p> (%@)", self.class, self, _name];
+    else return [NSString stringWithFormat:@"<%@: %p>", self.class, self];
+}
+
+@end
@@ -0,0 +1,67 @@
+//
+//  YYCacheLockProfile.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The operation which holds a cache's lock.
+typedef NS_ENUM(NSUInteger, YYCacheLockOperation) {
+    YYCacheLockOperationGet = 0,    ///< get, contains and the batch get
+    YYCacheLockOperationSet,        ///< set and the batch set
+    YYCacheLockOperationRemove,     ///< remove, remove all and remove by prefix or predicate
+    YYCacheLockOperationTrim,       ///< trim by the limits, automatically or manually
+    YYCacheLockOperationCheckpoint, ///< the WAL checkpoint of YYKVStorage (in a remove or a trim), and closing it
+    YYCacheLockOperationOther,      ///< the totals, the properties, snapshot, export and import
+    YYCacheLockOperationCount,
+};
+
+/**
+ YYCacheLockStats is a snapshot of the lock profile of a YYMemoryCache or YYDiskCache,
+ to tell whether its lock is a bottleneck and which operation holds it.
+
+ @discussion The profiling is off by default. When enabled, an acquisition costs a
+ try-lock and three clock reads more. It's counted to the operation which acquires
+ the lock. A hold is counted to the operation which holds the lock; when a trim or
+ a remove does a WAL checkpoint, the checkpoint is counted as a hold of its own, so
+ `maxHoldTime` of the trim is the longest part before or after a checkpoint.
+ */
+@interface YYCacheLockStats : NSObject
+
+@property (readonly) uint64_t acquisitions;          ///< times the lock was acquired
+@property (readonly) uint64_t contendedAcquisitions; ///< times the lock was held by another thread when acquiring
+@property (readonly) NSTimeInterval totalWaitTime;   ///< seconds waited for the lock
+@property (readonly) NSTimeInterval maxWaitTime;     ///< the longest wait in seconds
+@property (readonly) NSTimeInterval totalHoldTime;   ///< seconds the lock was held
+@property (readonly) NSTimeInterval maxHoldTime;     ///< the longest hold in seconds
+
+/** contendedAcquisitions / acquisitions, 0 if not acquired. */
+@property (readonly) double contentionRate;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+
+/** The stats of an operation, nil if the receiver is already the stats of an operation. */
+- (nullable YYCacheLockStats *)statsForOperation:(YYCacheLockOperation)operation;
+
+/** The name of an operation, such as "trim". */
++ (NSString *)nameForOperation:(YYCacheLockOperation)operation;
+
+/**
+ The stats as a dictionary, to log or to encode in JSON: {acquisitions, contended,
+ contention_rate, wait_total_us, wait_max_us, hold_total_us, hold_max_us}, and the
+ same for each acquired operation in "operations".
+ */
+- (NSDictionary<NSString *, id> *)dictionaryValue;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,132 @@
+//
+//  YYCacheLockProfile.m
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYCacheLockProfilePrivate.h"
+
+void YYCacheLockProfileSetEnabled(YYCacheLockProfile *profile, bool enabled) {
+    if (enabled && !profile->enabled) {
+        memset(profile->counters, 0, sizeof(profile->counters));
+    }
+    profile->acquireTime = 0;
+    __atomic_store_n(&profile->enabled, enabled, __ATOMIC_RELAXED);
+}
+
+
+@implementation YYCacheLockStats {
+    YYCacheLockCounters _counters;
+    NSArray<YYCacheLockStats *> *_operations; ///< nil for the stats of an operation
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYCacheLockStats init error" reason:@"Use 'initWithProfile:' instead." userInfo:nil];
+    return [self initWithProfile:NULL];
+}
+
+- (instancetype)_initWithCounters:(YYCacheLockCounters)counters {
+    self = [super init];
+    _counters = counters;
+    return self;
+}
+
+- (instancetype)initWithProfile:(const YYCacheLockProfile *)profile {
+    self = [super init];
+    NSMutableArray *operations = [NSMutableArray new];
+    for (NSUInteger i = 0; i < YYCacheLockOperationCount; i++) {
+        YYCacheLockCounters c = profile->counters[i];
+        [operations addObject:[[YYCacheLockStats alloc] _initWithCounters:c]];
+        _counters.acquisitions += c.acquisitions;
+        _counters.contendedAcquisitions += c.contendedAcquisitions;
+        _counters.totalWaitTime += c.totalWaitTime;
+        _counters.maxWaitTime = MAX(_counters.maxWaitTime, c.maxWaitTime);
+        _counters.totalHoldTime += c.totalHoldTime;
+        _counters.maxHoldTime = MAX(_counters.maxHoldTime, c.maxHoldTime);
+    }
+    _operations = operations;
+    return self;
+}
+
+- (uint64_t)acquisitions {
+    return _counters.acquisitions;
+}
+
+- (uint64_t)contendedAcquisitions {
+    return _counters.contendedAcquisitions;
+}
+
+- (NSTimeInterval)totalWaitTime {
+    return _counters.totalWaitTime / 1e9;
+}
+
+- (NSTimeInterval)maxWaitTime {
+    return _counters.maxWaitTime / 1e9;
+}
+
+- (NSTimeInterval)totalHoldTime {
+    return _counters.totalHoldTime / 1e9;
+}
+
+- (NSTimeInterval)maxHoldTime {
+    return _counters.maxHoldTime / 1e9;
+}
+
+- (double)contentionRate {
+    if (_counters.acquisitions == 0) return 0;
+    return (double)_counters.contendedAcquisitions / _counters.acquisitions;
+}
+
+- (YYCacheLockStats *)statsForOperation:(YYCacheLockOperation)operation {
+    if (operation >= _operations.count) return nil;
+    return _operations[operation];
+}
+
++ (NSString *)nameForOperation:(YYCacheLockOperation)operation {
+    switch (operation) {
+        case YYCacheLockOperationGet: return @"get";
+        case YYCacheLockOperationSet: return @"set";
+        case YYCacheLockOperationRemove: return @"remove";
+        case YYCacheLockOperationTrim: return @"trim";
+        case YYCacheLockOperationCheckpoint: return @"checkpoint";
+        case YYCacheLockOperationOther: return @"other";
+        default: return @"unknown";
+    }
+}
+
+- (NSDictionary *)_countersDictionary {
+    return @{@"acquisitions" : @(_counters.acquisitions),
+             @"contended" : @(_counters.contendedAcquisitions),
+             @"contention_rate" : @(self.contentionRate),
+             @"wait_total_us" : @(_counters.totalWaitTime / 1e3),
+             @"wait_max_us" : @(_counters.maxWaitTime / 1e3),
+             @"hold_total_us" : @(_counters.totalHoldTime / 1e3),
+             @"hold_max_us" : @(_counters.maxHoldTime / 1e3)};
+}
+
+- (NSDictionary *)dictionaryValue {
+    NSMutableDictionary *dic = [self _countersDictionary].mutableCopy;
+    if (_operations) {
+        NSMutableDictionary *operations = [NSMutableDictionary new];
+        [_operations enumerateObjectsUsingBlock:^(YYCacheLockStats *stats, NSUInteger idx, BOOL *stop) {
+            // a checkpoint in a trim or a remove is switched to with the lock held, not acquired
+            if (stats->_counters.acquisitions == 0 && stats->_counters.totalHoldTime == 0) return;
+            operations[[YYCacheLockStats nameForOperation:idx]] = [stats _countersDictionary];
+        }];
+        dic[@"operations"] = operations;
+    }
+    return dic;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> acquisitions:%llu contended:%llu (%.1f%%) wait:%.3fms max hold:%.3fms",
+            self.class, self, (unsigned long long)_counters.acquisitions, (unsigned long long)_counters.contendedAcquisitions, self.contentionRate * 100,
+            _counters.totalWaitTime / 1e6, _counters.maxHoldTime / 1e6];
+}
+
+@end
@@ -0,0 +1,160 @@
+//
+//  YYCacheLockProfilePrivate.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+// Private header of YYCache, it's not imported by the public headers.
+
+#import "YYCacheLockProfile.h"
+#import "YYKVStorage.h"
+#import "YYCacheMediaTime.h"
+#import <dispatch/dispatch.h>
+#import <pthread.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The counters of an operation, the times are in nanoseconds.
+typedef struct {
+    uint64_t acquisitions;          ///< times the lock was acquired
+    uint64_t contendedAcquisitions; ///< times the lock was held by another thread when acquiring
+    uint64_t totalWaitTime;
+    uint64_t maxWaitTime;
+    uint64_t totalHoldTime;
+    uint64_t maxHoldTime;
+} YYCacheLockCounters;
+
+/**
+ The profile of a lock, it's embedded in the cache and updated with the lock held.
+ */
+typedef struct {
+    bool enabled;                     ///< read without the lock, written with it
+    YYCacheLockOperation operation;   ///< the operation of the current holder
+    uint64_t acquireTime;             ///< when the current hold began, 0 if not profiled
+    YYCacheLockCounters counters[YYCacheLockOperationCount];
+} YYCacheLockProfile;
+
+/// Monotonic time in nanoseconds.
+static inline uint64_t YYCacheLockProfileNow(void) {
+    return YYCacheMonotonicNanoseconds();
+}
+
+static inline bool YYCacheLockProfileIsEnabled(YYCacheLockProfile *profile) {
+    return __atomic_load_n(&profile->enabled, __ATOMIC_RELAXED);
+}
+
+/// Called with the lock just acquired, `start` is the time before acquiring.
+static inline void YYCacheLockProfileDidAcquire(YYCacheLockProfile *profile, YYCacheLockOperation operation, uint64_t start, bool contended) {
+    uint64_t now = YYCacheLockProfileNow();
+    uint64_t wait = now - start;
+    YYCacheLockCounters *counters = &profile->counters[operation];
+    counters->acquisitions++;
+    if (contended) counters->contendedAcquisitions++;
+    counters->totalWaitTime += wait;
+    if (wait > counters->maxWaitTime) counters->maxWaitTime = wait;
+    profile->operation = operation;
+    profile->acquireTime = now;
+}
+
+/// Ends the current hold (if profiled) at `now`, and counts it to the current operation.
+static inline void _YYCacheLockProfileEndHold(YYCacheLockProfile *profile, uint64_t now) {
+    uint64_t hold = now - profile->acquireTime;
+    YYCacheLockCounters *counters = &profile->counters[profile->operation];
+    counters->totalHoldTime += hold;
+    if (hold > counters->maxHoldTime) counters->maxHoldTime = hold;
+}
+
+/// Called with the lock held, just before releasing it.
+static inline void YYCacheLockProfileWillRelease(YYCacheLockProfile *profile) {
+    if (!profile->acquireTime) return;
+    _YYCacheLockProfileEndHold(profile, YYCacheLockProfileNow());
+    profile->acquireTime = 0;
+}
+
+/**
+ Called with the lock held, counts the rest of the hold to another operation, such as
+ a checkpoint in a trim. The time before is counted to the previous operation as a hold.
+
+ @return The previous operation, to switch back with it.
+ */
+static inline YYCacheLockOperation YYCacheLockProfileSwitchOperation(YYCacheLockProfile *profile, YYCacheLockOperation operation) {
+    YYCacheLockOperation previous = profile->operation;
+    if (profile->acquireTime) {
+        uint64_t now = YYCacheLockProfileNow();
+        _YYCacheLockProfileEndHold(profile, now);
+        profile->acquireTime = now;
+    }
+    profile->operation = operation;
+    return previous;
+}
+
+static inline void YYCacheLockProfileMutexLock(pthread_mutex_t *mutex, YYCacheLockProfile *profile, YYCacheLockOperation operation) {
+    if (!YYCacheLockProfileIsEnabled(profile)) {
+        pthread_mutex_lock(mutex);
+        return;
+    }
+    uint64_t start = YYCacheLockProfileNow();
+    bool contended = pthread_mutex_trylock(mutex) != 0;
+    if (contended) pthread_mutex_lock(mutex);
+    YYCacheLockProfileDidAcquire(profile, operation, start, contended);
+}
+
+/// A failed try is not counted, the caller retries it later.
+static inline int YYCacheLockProfileMutexTryLock(pthread_mutex_t *mutex, YYCacheLockProfile *profile, YYCacheLockOperation operation) {
+    if (!YYCacheLockProfileIsEnabled(profile)) return pthread_mutex_trylock(mutex);
+    uint64_t start = YYCacheLockProfileNow();
+    int result = pthread_mutex_trylock(mutex);
+    if (result == 0) YYCacheLockProfileDidAcquire(profile, operation, start, false);
+    return result;
+}
+
+static inline void YYCacheLockProfileMutexUnlock(pthread_mutex_t *mutex, YYCacheLockProfile *profile) {
+    YYCacheLockProfileWillRelease(profile);
+    pthread_mutex_unlock(mutex);
+}
+
+static inline void YYCacheLockProfileSemaphoreWait(dispatch_semaphore_t semaphore, YYCacheLockProfile *profile, YYCacheLockOperation operation) {
+    if (!YYCacheLockProfileIsEnabled(profile)) {
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+        return;
+    }
+    uint64_t start = YYCacheLockProfileNow();
+    bool contended = dispatch_semaphore_wait(semaphore, DISPATCH_TIME_NOW) != 0;
+    if (contended) dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    YYCacheLockProfileDidAcquire(profile, operation, start, contended);
+}
+
+static inline void YYCacheLockProfileSemaphoreSignal(dispatch_semaphore_t semaphore, YYCacheLockProfile *profile) {
+    YYCacheLockProfileWillRelease(profile);
+    dispatch_semaphore_signal(semaphore);
+}
+
+/// Enables or disables the profile, called with the lock held. Enabling it resets the counters.
+FOUNDATION_EXPORT void YYCacheLockProfileSetEnabled(YYCacheLockProfile *profile, bool enabled);
+
+
+@interface YYCacheLockStats ()
+
+/** Creates the stats with a copy of the profile, called with the lock held. */
+- (instancetype)initWithProfile:(const YYCacheLockProfile *)profile;
+
+@end
+
+
+@interface YYKVStorage ()
+
+/**
+ The lock profile of the owner's lock, the WAL checkpoints are counted to it as
+ `YYCacheLockOperationCheckpoint`. Default is NULL. It's set by YYDiskCache, and
+ must outlive the storage.
+ */
+@property (nullable, nonatomic) YYCacheLockProfile *lockProfile;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,46 @@
+//
+//  YYCacheMediaTime.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+// Private header of YYCache, it's not imported by the public headers.
+
+#if __has_include(<QuartzCore/QuartzCore.h>)
+#import <QuartzCore/QuartzCore.h>
+#else
+#import <time.h>
+/// Monotonic time in seconds, same as QuartzCore's (no QuartzCore in GNUstep).
+static inline double CACurrentMediaTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+#endif
+
+#ifdef __APPLE__
+#import <mach/mach_time.h>
+#import <dispatch/dispatch.h>
+/// Monotonic time in nanoseconds (clock_gettime needs iOS 10, mach time works on iOS 6).
+static inline uint64_t YYCacheMonotonicNanoseconds(void) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+#else
+#import <time.h>
+/// Monotonic time in nanoseconds.
+static inline uint64_t YYCacheMonotonicNanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
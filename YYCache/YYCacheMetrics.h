@@ -0,0 +1,105 @@
+//
+//  YYCacheMetrics.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The measured phases.
+typedef NS_ENUM(NSUInteger, YYCacheMetric) {
+    YYCacheMetricMemoryGet = 0,     ///< YYMemoryCache `objectForKey:`, total
+    YYCacheMetricMemorySet,         ///< YYMemoryCache `setObject:forKey:...`, total
+    YYCacheMetricMemoryLockWait,    ///< YYMemoryCache, waiting for the lock in get and set
+    YYCacheMetricDiskGet,           ///< YYDiskCache `objectForKey:`, total
+    YYCacheMetricDiskSet,           ///< YYDiskCache `setObject:forKey:...`, total
+    YYCacheMetricDiskLockWait,      ///< YYDiskCache, waiting for the lock
+    YYCacheMetricDiskArchive,       ///< YYDiskCache, archiving an object
+    YYCacheMetricDiskUnarchive,     ///< YYDiskCache, unarchiving an object
+    YYCacheMetricStorageSQLiteRead, ///< YYKVStorage, querying an item or a value
+    YYCacheMetricStorageSQLiteWrite,///< YYKVStorage, saving an item or updating its access time
+    YYCacheMetricStorageFileRead,   ///< YYKVStorage, reading a file
+    YYCacheMetricStorageFileWrite,  ///< YYKVStorage, writing a file
+    YYCacheMetricCount,
+};
+
+
+/**
+ An exporter receives the metrics periodically, such as to log them or send them
+ to a monitoring service.
+ */
+@protocol YYCacheMetricsExporter <NSObject>
+
+/**
+ Called in a background queue every `interval` seconds.
+
+ @param metrics  The metrics of the interval (not since launch), in the format of
+                 `[YYCacheMetrics snapshot]`. The phases without records are omitted.
+ @param interval The interval in seconds.
+ */
+- (void)exportMetrics:(NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)metrics
+             interval:(NSTimeInterval)interval;
+
+@end
+
+
+/**
+ An exporter which calls a block.
+ */
+@interface YYCacheMetricsBlockExporter : NSObject <YYCacheMetricsExporter>
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithBlock:(void (^)(NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *metrics, NSTimeInterval interval))block NS_DESIGNATED_INITIALIZER;
+
+@end
+
+
+/**
+ YYCacheMetrics collects the latency histograms of YYMemoryCache, YYDiskCache and
+ YYKVStorage, to tell how long an access takes and where the time goes (lock wait,
+ sqlite, file IO or archive).
+
+ @discussion The metrics are recorded only if the library is compiled with
+ `YYCACHE_METRICS_ENABLED=1`. Each thread records to its own histograms without lock,
+ they are merged when read. A histogram has 16 buckets for each power of 2 (about 6%
+ of precision) up to 2^40 ns, and takes about 57KB for all the phases of a thread.
+ */
+@interface YYCacheMetrics : NSObject
+
+/** Whether the library is compiled with `YYCACHE_METRICS_ENABLED=1`. */
++ (BOOL)isEnabled;
+
+/** The name of a phase in the snapshot, such as "disk.lock_wait". */
++ (NSString *)nameForMetric:(YYCacheMetric)metric;
+
+/**
+ The metrics since launch (or the last `reset`), empty if not enabled.
+
+ @return A dictionary of phase name -> {count, mean_us, p50_us, p90_us, p99_us,
+ p999_us, max_us}. The phases without records are omitted.
+ */
++ (NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)snapshot;
+
+/** Restarts the `snapshot` from now. The exporters are not affected. */
++ (void)reset;
+
+/**
+ Adds an exporter, which is called every `interval` seconds with the metrics of the
+ interval. It has no effect if not enabled. The exporter is retained until removed.
+ */
++ (void)addExporter:(id<YYCacheMetricsExporter>)exporter interval:(NSTimeInterval)interval;
+
+/** Removes an exporter. */
++ (void)removeExporter:(id<YYCacheMetricsExporter>)exporter;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,312 @@
+//
+//  YYCacheMetrics.m
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYCacheMetricsPrivate.h"
+#if YYCACHE_METRICS_ENABLED
+#import <pthread.h>
+#import <stdatomic.h>
+#import <stdlib.h>
+#import <string.h>
+#import <math.h>
+#endif
+
+@implementation YYCacheMetricsBlockExporter {
+    void (^_block)(NSDictionary *metrics, NSTimeInterval interval);
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYCacheMetricsBlockExporter init error" reason:@"Use 'initWithBlock:' instead." userInfo:nil];
+    return [self initWithBlock:^(NSDictionary *metrics, NSTimeInterval interval) {}];
+}
+
+- (instancetype)initWithBlock:(void (^)(NSDictionary *metrics, NSTimeInterval interval))block {
+    self = [super init];
+    _block = [block copy];
+    return self;
+}
+
+- (void)exportMetrics:(NSDictionary *)metrics interval:(NSTimeInterval)interval {
+    if (_block) _block(metrics, interval);
+}
+
+@end
+
+
+#if YYCACHE_METRICS_ENABLED
+
+// enum, they are the sizes of the arrays below
+enum {
+    kSubBucketBits = 4,  ///< 16 buckets per power of 2
+    kSubBucketCount = 1 << kSubBucketBits,
+    kMaxExponent = 39,   ///< values up to 2^40 ns (18 min)
+    kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBucketCount,
+};
+
+/// Summed histograms of all phases.
+typedef struct {
+    uint64_t counts[YYCacheMetricCount][kBucketCount];
+    uint64_t sums[YYCacheMetricCount]; ///< nanoseconds
+} _YYCacheMetricsData;
+
+/// The histograms of one thread, written only by the thread.
+typedef struct _YYCacheMetricsShard {
+    struct _YYCacheMetricsShard *next;
+    _Atomic(uint64_t) counts[YYCacheMetricCount][kBucketCount];
+    _Atomic(uint64_t) sums[YYCacheMetricCount];
+} _YYCacheMetricsShard;
+
+static pthread_mutex_t _shardsLock = PTHREAD_MUTEX_INITIALIZER; ///< _shards, _retired and _base
+static _YYCacheMetricsShard *_shards;
+static _YYCacheMetricsData _retired; ///< the shards of the exited threads
+static _YYCacheMetricsData _base;    ///< subtracted from the snapshot, set by reset
+static pthread_key_t _shardKey;
+static pthread_once_t _shardKeyOnce = PTHREAD_ONCE_INIT;
+
+static inline int _YYCacheMetricsBucket(uint64_t value) {
+    if (value < kSubBucketCount) return (int)value;
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > kMaxExponent) return kBucketCount - 1;
+    return (exponent - kSubBucketBits + 1) * kSubBucketCount + (int)((value >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1));
+}
+
+/// The middle value of a bucket.
+static double _YYCacheMetricsBucketValue(int bucket) {
+    if (bucket < kSubBucketCount) return bucket;
+    int exponent = bucket / kSubBucketCount + kSubBucketBits - 1;
+    uint64_t sub = kSubBucketCount + bucket % kSubBucketCount;
+    uint64_t width = 1ULL << (exponent - kSubBucketBits);
+    return sub * width + (width - 1) / 2.0;
+}
+
+static void _YYCacheMetricsThreadExit(void *value) {
+    _YYCacheMetricsShard *shard = value;
+    pthread_mutex_lock(&_shardsLock);
+    for (_YYCacheMetricsShard **link = &_shards; *link; link = &(*link)->next) {
+        if (*link == shard) {
+            *link = shard->next;
+            break;
+        }
+    }
+    for (int m = 0; m < YYCacheMetricCount; m++) {
+        for (int b = 0; b < kBucketCount; b++) {
+            _retired.counts[m][b] += atomic_load_explicit(&shard->counts[m][b], memory_order_relaxed);
+        }
+        _retired.sums[m] += atomic_load_explicit(&shard->sums[m], memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&_shardsLock);
+    free(shard);
+}
+
+static void _YYCacheMetricsInitShardKey() {
+    pthread_key_create(&_shardKey, _YYCacheMetricsThreadExit);
+}
+
+static _YYCacheMetricsShard *_YYCacheMetricsCurrentShard() {
+    pthread_once(&_shardKeyOnce, _YYCacheMetricsInitShardKey);
+    _YYCacheMetricsShard *shard = pthread_getspecific(_shardKey);
+    if (shard) return shard;
+    shard = calloc(1, sizeof(_YYCacheMetricsShard));
+    if (!shard) return NULL;
+    pthread_mutex_lock(&_shardsLock);
+    shard->next = _shards;
+    _shards = shard;
+    pthread_mutex_unlock(&_shardsLock);
+    pthread_setspecific(_shardKey, shard);
+    return shard;
+}
+
+void YYCacheMetricsRecord(YYCacheMetric metric, uint64_t nanoseconds) {
+    if (metric >= YYCacheMetricCount) return;
+    _YYCacheMetricsShard *shard = _YYCacheMetricsCurrentShard();
+    if (!shard) return;
+    // only this thread writes the shard, so a relaxed load and store is enough
+    _Atomic(uint64_t) *count = &shard->counts[metric][_YYCacheMetricsBucket(nanoseconds)];
+    atomic_store_explicit(count, atomic_load_explicit(count, memory_order_relaxed) + 1, memory_order_relaxed);
+    _Atomic(uint64_t) *sum = &shard->sums[metric];
+    atomic_store_explicit(sum, atomic_load_explicit(sum, memory_order_relaxed) + nanoseconds, memory_order_relaxed);
+}
+
+/// Sums all the shards, should be called in lock.
+static void _YYCacheMetricsCollect(_YYCacheMetricsData *data) {
+    memcpy(data, &_retired, sizeof(_YYCacheMetricsData));
+    for (_YYCacheMetricsShard *shard = _shards; shard; shard = shard->next) {
+        for (int m = 0; m < YYCacheMetricCount; m++) {
+            for (int b = 0; b < kBucketCount; b++) {
+                data->counts[m][b] += atomic_load_explicit(&shard->counts[m][b], memory_order_relaxed);
+            }
+            data->sums[m] += atomic_load_explicit(&shard->sums[m], memory_order_relaxed);
+        }
+    }
+}
+
+/// The metrics of `data - base`.
+static NSDictionary *_YYCacheMetricsDictionary(const _YYCacheMetricsData *data, const _YYCacheMetricsData *base) {
+    static const double kPercentiles[] = {0.5, 0.9, 0.99, 0.999};
+    static NSString *const kPercentileNames[] = {@"p50_us", @"p90_us", @"p99_us", @"p999_us"};
+    NSMutableDictionary *metrics = [NSMutableDictionary new];
+    for (int m = 0; m < YYCacheMetricCount; m++) {
+        uint64_t total = 0;
+        for (int b = 0; b < kBucketCount; b++) total += data->counts[m][b] - base->counts[m][b];
+        if (total == 0) continue;
+
+        NSMutableDictionary *metric = [NSMutableDictionary new];
+        metric[@"count"] = @(total);
+        metric[@"mean_us"] = @((data->sums[m] - base->sums[m]) / 1000.0 / total);
+        uint64_t seen = 0;
+        int p = 0, maxBucket = 0;
+        for (int b = 0; b < kBucketCount; b++) {
+            uint64_t count = data->counts[m][b] - base->counts[m][b];
+            if (count == 0) continue;
+            seen += count;
+            maxBucket = b;
+            while (p < 4 && seen >= (uint64_t)ceil(kPercentiles[p] * total)) {
+                metric[kPercentileNames[p]] = @(_YYCacheMetricsBucketValue(b) / 1000.0);
+                p++;
+            }
+        }
+        metric[@"max_us"] = @(_YYCacheMetricsBucketValue(maxBucket) / 1000.0);
+        metrics[[YYCacheMetrics nameForMetric:m]] = metric;
+    }
+    return metrics;
+}
+
+/**
+ A registered exporter and its timer.
+ Typically, you should not use this class directly.
+ */
+@interface _YYCacheMetricsExporterEntry : NSObject {
+    @package
+    id<YYCacheMetricsExporter> _exporter;
+    NSTimeInterval _interval;
+    dispatch_source_t _timer;
+    _YYCacheMetricsData *_last; ///< the data at the last export
+}
+@end
+
+@implementation _YYCacheMetricsExporterEntry
+- (void)dealloc {
+    free(_last);
+}
+@end
+
+static dispatch_queue_t _exportQueue; ///< serial, the exporters are accessed in this queue
+static NSMutableArray *_exporters;     ///< _YYCacheMetricsExporterEntry
+
+static void _YYCacheMetricsInitExport() {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _exportQueue = dispatch_queue_create("com.ibireme.cache.metrics", DISPATCH_QUEUE_SERIAL);
+        _exporters = [NSMutableArray new];
+    });
+}
+
+#endif
+
+
+@implementation YYCacheMetrics
+
++ (BOOL)isEnabled {
+    return YYCACHE_METRICS_ENABLED;
+}
+
++ (NSString *)nameForMetric:(YYCacheMetric)metric {
+    switch (metric) {
+        case YYCacheMetricMemoryGet: return @"memory.get";
+        case YYCacheMetricMemorySet: return @"memory.set";
+        case YYCacheMetricMemoryLockWait: return @"memory.lock_wait";
+        case YYCacheMetricDiskGet: return @"disk.get";
+        case YYCacheMetricDiskSet: return @"disk.set";
+        case YYCacheMetricDiskLockWait: return @"disk.lock_wait";
+        case YYCacheMetricDiskArchive: return @"disk.archive";
+        case YYCacheMetricDiskUnarchive: return @"disk.unarchive";
+        case YYCacheMetricStorageSQLiteRead: return @"storage.sqlite_read";
+        case YYCacheMetricStorageSQLiteWrite: return @"storage.sqlite_write";
+        case YYCacheMetricStorageFileRead: return @"storage.file_read";
+        case YYCacheMetricStorageFileWrite: return @"storage.file_write";
+        default: return @"unknown";
+    }
+}
+
++ (NSDictionary *)snapshot {
+#if YYCACHE_METRICS_ENABLED
+    _YYCacheMetricsData *data = malloc(sizeof(_YYCacheMetricsData));
+    if (!data) return @{};
+    pthread_mutex_lock(&_shardsLock);
+    _YYCacheMetricsCollect(data);
+    NSDictionary *metrics = _YYCacheMetricsDictionary(data, &_base);
+    pthread_mutex_unlock(&_shardsLock);
+    free(data);
+    return metrics;
+#else
+    return @{};
+#endif
+}
+
++ (void)reset {
+#if YYCACHE_METRICS_ENABLED
+    pthread_mutex_lock(&_shardsLock);
+    _YYCacheMetricsCollect(&_base);
+    pthread_mutex_unlock(&_shardsLock);
+#endif
+}
+
++ (void)addExporter:(id<YYCacheMetricsExporter>)exporter interval:(NSTimeInterval)interval {
+#if YYCACHE_METRICS_ENABLED
+    if (!exporter || interval <= 0) return;
+    _YYCacheMetricsInitExport();
+    _YYCacheMetricsExporterEntry *entry = [_YYCacheMetricsExporterEntry new];
+    entry->_exporter = exporter;
+    entry->_interval = interval;
+    entry->_last = malloc(sizeof(_YYCacheMetricsData));
+    if (!entry->_last) return;
+    pthread_mutex_lock(&_shardsLock);
+    _YYCacheMetricsCollect(entry->_last);
+    pthread_mutex_unlock(&_shardsLock);
+
+    __weak _YYCacheMetricsExporterEntry *_entry = entry;
+    entry->_timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _exportQueue);
+    dispatch_source_set_timer(entry->_timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)),
+                              (uint64_t)(interval * NSEC_PER_SEC), (uint64_t)(interval * 0.1 * NSEC_PER_SEC));
+    dispatch_source_set_event_handler(entry->_timer, ^{
+        __strong _YYCacheMetricsExporterEntry *entry = _entry;
+        if (!entry) return;
+        _YYCacheMetricsData *data = malloc(sizeof(_YYCacheMetricsData));
+        if (!data) return;
+        pthread_mutex_lock(&_shardsLock);
+        _YYCacheMetricsCollect(data);
+        pthread_mutex_unlock(&_shardsLock);
+        NSDictionary *metrics = _YYCacheMetricsDictionary(data, entry->_last);
+        free(entry->_last);
+        entry->_last = data;
+        [entry->_exporter exportMetrics:metrics interval:entry->_interval];
+    });
+    dispatch_async(_exportQueue, ^{
+        [_exporters addObject:entry];
+        dispatch_resume(entry->_timer);
+    });
+#endif
+}
+
++ (void)removeExporter:(id<YYCacheMetricsExporter>)exporter {
+#if YYCACHE_METRICS_ENABLED
+    if (!exporter) return;
+    _YYCacheMetricsInitExport();
+    dispatch_async(_exportQueue, ^{
+        for (_YYCacheMetricsExporterEntry *entry in _exporters.copy) {
+            if (entry->_exporter != exporter) continue;
+            dispatch_source_cancel(entry->_timer);
+            [_exporters removeObject:entry];
+        }
+    });
+#endif
+}
+
+@end
@@ -0,0 +1,46 @@
+//
+//  YYCacheMetricsPrivate.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+// Private header of YYCache, it's not imported by the public headers.
+
+#import "YYCacheMetrics.h"
+
+/**
+ Set `YYCACHE_METRICS_ENABLED=1` in the preprocessor macros of the library to record
+ the latency metrics. When it's 0 (the default), the measure macros below compile to
+ the plain statements, and the access methods have no extra cost.
+ */
+#ifndef YYCACHE_METRICS_ENABLED
+#define YYCACHE_METRICS_ENABLED 0
+#endif
+
+#if YYCACHE_METRICS_ENABLED
+
+#import "YYCacheMediaTime.h"
+
+/// Records a latency in nanoseconds to the histogram shard of the current thread.
+FOUNDATION_EXPORT void YYCacheMetricsRecord(YYCacheMetric metric, uint64_t nanoseconds);
+
+#define YYCacheMetricsBegin(start) uint64_t start = YYCacheMonotonicNanoseconds()
+#define YYCacheMetricsEnd(metric, start) YYCacheMetricsRecord(metric, YYCacheMonotonicNanoseconds() - (start))
+#define YYCacheMetricsMeasure(metric, ...) do { \
+    YYCacheMetricsBegin(_yy_metrics_start); \
+    __VA_ARGS__; \
+    YYCacheMetricsEnd(metric, _yy_metrics_start); \
+} while (0)
+
+#else
+
+#define YYCacheMetricsBegin(start)
+#define YYCacheMetricsEnd(metric, start)
+#define YYCacheMetricsMeasure(metric, ...) __VA_ARGS__
+
+#endif
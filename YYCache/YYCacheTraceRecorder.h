@@ -0,0 +1,160 @@
+//
+//  YYCacheTraceRecorder.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The operation of a trace entry.
+typedef NS_ENUM(uint8_t, YYCacheTraceOperation) {
+    YYCacheTraceOperationGet = 0,
+    YYCacheTraceOperationSet,
+    YYCacheTraceOperationRemove,
+};
+
+/// The tier of a trace entry.
+typedef NS_ENUM(uint8_t, YYCacheTraceTier) {
+    YYCacheTraceTierCache = 0, ///< YYCache, the tiers are not known (a set or a remove)
+    YYCacheTraceTierMemory,    ///< YYMemoryCache, or a YYCache get served by its memory cache
+    YYCacheTraceTierDisk,      ///< YYDiskCache, or a YYCache get served by (or missed in) its disk cache
+};
+
+/// The result of a trace entry.
+typedef NS_ENUM(uint8_t, YYCacheTraceResult) {
+    YYCacheTraceResultNone = 0, ///< set and remove
+    YYCacheTraceResultHit,
+    YYCacheTraceResultMiss,
+};
+
+/// One entry of a trace file, 24 bytes, little-endian.
+typedef struct {
+    uint64_t time;   ///< nanoseconds since the recorder was created (monotonic)
+    uint64_t key;    ///< FNV-1a 64 of the UTF-8 key, or the value of an NSNumber key
+    uint32_t size;   ///< bytes (the cost in memory cache), 0 if unknown
+    uint8_t op;      ///< YYCacheTraceOperation
+    uint8_t tier;    ///< YYCacheTraceTier
+    uint8_t result;  ///< YYCacheTraceResult
+    uint8_t reserved;
+} YYCacheTraceEntry;
+
+/// The header of a trace file, 32 bytes, followed by the entries.
+typedef struct {
+    char magic[8];       ///< YYCacheTraceFileMagic
+    uint32_t version;    ///< YYCacheTraceFileVersion
+    uint32_t entrySize;  ///< sizeof(YYCacheTraceEntry)
+    double sampleRate;   ///< the fraction of keys recorded
+    uint64_t startTime;  ///< wall clock of the first entry's time 0, microseconds since 1970
+} YYCacheTraceFileHeader;
+
+FOUNDATION_EXPORT const char YYCacheTraceFileMagic[8]; ///< "YYCTRACE"
+FOUNDATION_EXPORT const uint32_t YYCacheTraceFileVersion;
+
+/**
+ YYCacheTraceRecorder records the accesses of caches to a binary trace file, to
+ replay real access patterns and plan the capacities with them.
+
+ @discussion Set it to the `traceRecorder` of YYMemoryCache, YYDiskCache or YYCache
+ (one recorder may be shared by many caches). A cache without recorder pays one check
+ per access.
+
+ The cost of recording is sampled and bounded:
+
+ * Sampling is by key (a key is recorded in all or none of its accesses), so the
+   sampled trace has the same reuse pattern as the full trace at `sampleRate` of its
+   footprint. Scale the capacities by `sampleRate` when replaying it.
+ * Each thread writes to its own ring buffer of `bufferCapacity` entries, without
+   lock. A background timer writes the rings to the file every second. When a ring
+   is full, the entries are dropped and counted in `droppedCount`, the caller never
+   waits for the file.
+ * The file stops growing at `fileSizeLimit`.
+
+ The entries of different threads are not in time order in the file, sort them by
+ `time` when reading.
+ */
+@interface YYCacheTraceRecorder : NSObject
+
+/** The path of the trace file. */
+@property (readonly) NSString *path;
+
+/** The fraction of keys to record, in (0, 1]. */
+@property (readonly) double sampleRate;
+
+/** Entries of each thread's ring buffer. */
+@property (readonly) NSUInteger bufferCapacity;
+
+/**
+ The maximum size of the trace file in bytes, the entries over the limit are dropped.
+ The default value is 64MB.
+ */
+@property uint64_t fileSizeLimit;
+
+/** The number of entries written to the file. */
+@property (readonly) uint64_t recordedCount;
+
+/** The number of entries dropped by a full ring buffer or the `fileSizeLimit`. */
+@property (readonly) uint64_t droppedCount;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+
+/**
+ Creates a recorder which records all keys, with 4096 entries for each thread.
+ The file is replaced if exists.
+
+ @param path The path of the trace file.
+ @result A new recorder, or nil if the file can not be created.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path;
+
+/**
+ The designated initializer. The file is replaced if exists.
+
+ @param path           The path of the trace file.
+ @param sampleRate     The fraction of keys to record, in (0, 1].
+ @param bufferCapacity Entries of each thread's ring buffer, rounded up to a power of 2.
+ @result A new recorder, or nil if the file can not be created.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path
+                           sampleRate:(double)sampleRate
+                       bufferCapacity:(NSUInteger)bufferCapacity NS_DESIGNATED_INITIALIZER;
+
+/**
+ Records an access, it's called by the caches. It never blocks: the entry is dropped
+ if the ring buffer of the current thread is full.
+
+ @param operation The operation.
+ @param tier      The tier.
+ @param key       The key, an NSString or NSNumber is hashed by its value, other
+                  objects by `hash`.
+ @param size      The size in bytes, 0 if unknown.
+ @param result    The result.
+ */
+- (void)recordOperation:(YYCacheTraceOperation)operation
+                   tier:(YYCacheTraceTier)tier
+                    key:(id)key
+                   size:(NSUInteger)size
+                 result:(YYCacheTraceResult)result;
+
+/**
+ Writes the recorded entries to the file.
+ This method blocks the calling thread until the file is written.
+ */
+- (void)flush;
+
+/**
+ Writes the recorded entries and closes the file, the following accesses are not
+ recorded. It's called when the recorder is released.
+ */
+- (void)close;
+
+@end
+
+NS_ASSUME_NONNULL_END
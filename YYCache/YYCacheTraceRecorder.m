@@ -0,0 +1,354 @@
+//
+//  YYCacheTraceRecorder.m
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYCacheTraceRecorder.h"
+#import "YYCacheMediaTime.h"
+#import <CoreFoundation/CoreFoundation.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <sys/time.h>
+
+const char YYCacheTraceFileMagic[8] = {'Y', 'Y', 'C', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t YYCacheTraceFileVersion = 1;
+
+static const NSUInteger kDefaultBufferCapacity = 4096;          ///< entries, 96KB per thread
+static const NSUInteger kMaxBufferCapacity = 1024 * 1024;      ///< entries, 24MB per thread
+static const uint64_t kDefaultFileSizeLimit = 1024 * 1024 * 64; ///< 64MB
+static const NSTimeInterval kFlushInterval = 1.0;               ///< seconds between two background flushes
+
+/**
+ The ring buffer of one thread for one recorder. The thread writes `head`, the
+ recorder's flush writes `tail`, so no lock is needed between them.
+
+ It's held by both the thread (released when the thread exits) and the recorder
+ (released when the thread exited and the ring is drained, or the recorder closed).
+ */
+typedef struct _YYCacheTraceRing {
+    struct _YYCacheTraceRing *threadNext;   ///< the thread's rings, only accessed by the thread
+    struct _YYCacheTraceRing *recorderNext; ///< the recorder's rings, accessed in the recorder's lock
+    uint64_t recorderID;
+    uint64_t mask;                          ///< capacity - 1
+    _Atomic(uint64_t) head;                 ///< next entry to write
+    _Atomic(uint64_t) tail;                 ///< next entry to read
+    _Atomic(uint64_t) dropped;
+    atomic_bool threadExited;
+    atomic_bool recorderClosed;
+    atomic_int refCount;
+    YYCacheTraceEntry entries[];
+} _YYCacheTraceRing;
+
+static pthread_key_t _YYCacheTraceThreadKey; ///< value is the first _YYCacheTraceRing of the thread
+static pthread_once_t _YYCacheTraceThreadKeyOnce = PTHREAD_ONCE_INIT;
+static _Atomic(uint64_t) _YYCacheTraceNextRecorderID = 1; ///< never reused, unlike pthread keys
+
+static inline uint64_t _YYCacheTraceNow() {
+    return YYCacheMonotonicNanoseconds();
+}
+
+/// splitmix64, mixes the bits of a key hash for sampling.
+static inline uint64_t _YYCacheTraceMix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/// FNV-1a 64, same as the "keys" trace files of the benchmark.
+static inline uint64_t _YYCacheTraceHash(const char *str, size_t length) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static uint64_t _YYCacheTraceKeyHash(id key) {
+    if ([key isKindOfClass:[NSString class]]) {
+        const char *str = CFStringGetCStringPtr((__bridge CFStringRef)key, kCFStringEncodingUTF8);
+        if (!str) str = [(NSString *)key UTF8String];
+        return str ? _YYCacheTraceHash(str, strlen(str)) : 0;
+    }
+    if ([key isKindOfClass:[NSNumber class]]) {
+        return [(NSNumber *)key unsignedLongLongValue];
+    }
+    return (uint64_t)[key hash];
+}
+
+static void _YYCacheTraceRingRelease(_YYCacheTraceRing *ring) {
+    if (atomic_fetch_sub_explicit(&ring->refCount, 1, memory_order_acq_rel) == 1) free(ring);
+}
+
+static void _YYCacheTraceThreadExit(void *value) {
+    _YYCacheTraceRing *ring = value;
+    while (ring) {
+        _YYCacheTraceRing *next = ring->threadNext;
+        atomic_store_explicit(&ring->threadExited, true, memory_order_release);
+        _YYCacheTraceRingRelease(ring);
+        ring = next;
+    }
+}
+
+static void _YYCacheTraceInitThreadKey() {
+    pthread_key_create(&_YYCacheTraceThreadKey, _YYCacheTraceThreadExit);
+}
+
+static inline _YYCacheTraceRing *_YYCacheTraceThreadRing(uint64_t recorderID) {
+    _YYCacheTraceRing *ring = pthread_getspecific(_YYCacheTraceThreadKey);
+    while (ring && ring->recorderID != recorderID) ring = ring->threadNext;
+    return ring;
+}
+
+/// Add a ring to the current thread, and release the rings of the closed recorders.
+static void _YYCacheTraceThreadAddRing(_YYCacheTraceRing *ring) {
+    _YYCacheTraceRing *first = pthread_getspecific(_YYCacheTraceThreadKey);
+    _YYCacheTraceRing **link = &first;
+    while (*link) {
+        _YYCacheTraceRing *current = *link;
+        if (atomic_load_explicit(&current->recorderClosed, memory_order_acquire)) {
+            *link = current->threadNext;
+            _YYCacheTraceRingRelease(current);
+        } else {
+            link = &current->threadNext;
+        }
+    }
+    ring->threadNext = first;
+    pthread_setspecific(_YYCacheTraceThreadKey, ring);
+}
+
+
+@implementation YYCacheTraceRecorder {
+    uint64_t _recorderID;
+    uint64_t _sampleThreshold; ///< of 2^32, the key is recorded if its mixed hash is below
+    uint64_t _startTime;       ///< _YYCacheTraceNow() of time 0
+    atomic_bool _closed;
+
+    pthread_mutex_t _lock;     ///< the rings, the file and the counts
+    _YYCacheTraceRing *_rings;
+    FILE *_file;
+    uint64_t _fileSize;
+    uint64_t _recordedCount;
+    uint64_t _droppedCount;    ///< by the file size limit and the released rings
+    dispatch_source_t _timer;
+}
+
+#pragma mark - private
+
+/// Creates the ring of the current thread, nil if out of memory or closed.
+- (_YYCacheTraceRing *)_addRingForCurrentThread {
+    size_t size = sizeof(_YYCacheTraceRing) + sizeof(YYCacheTraceEntry) * _bufferCapacity;
+    _YYCacheTraceRing *ring = calloc(1, size);
+    if (!ring) return NULL;
+    ring->recorderID = _recorderID;
+    ring->mask = _bufferCapacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    atomic_init(&ring->threadExited, false);
+    atomic_init(&ring->recorderClosed, false);
+    atomic_init(&ring->refCount, 2);
+
+    pthread_mutex_lock(&_lock);
+    if (atomic_load_explicit(&_closed, memory_order_relaxed)) {
+        // closed during the record, `close` has released the rings and would never see this one
+        pthread_mutex_unlock(&_lock);
+        free(ring);
+        return NULL;
+    }
+    ring->recorderNext = _rings;
+    _rings = ring;
+    pthread_mutex_unlock(&_lock);
+    _YYCacheTraceThreadAddRing(ring);
+    return ring;
+}
+
+/// Writes the entries to the file, should be called in lock.
+- (void)_writeEntries:(const YYCacheTraceEntry *)entries count:(uint64_t)count {
+    if (count == 0) return;
+    uint64_t limit = self.fileSizeLimit;
+    uint64_t writable = _fileSize < limit ? (limit - _fileSize) / sizeof(YYCacheTraceEntry) : 0;
+    uint64_t written = 0;
+    if (_file && writable > 0) {
+        written = fwrite(entries, sizeof(YYCacheTraceEntry), (size_t)MIN(count, writable), _file);
+    }
+    _fileSize += written * sizeof(YYCacheTraceEntry);
+    _recordedCount += written;
+    _droppedCount += count - written;
+}
+
+/// Writes all the rings to the file, should be called in lock.
+- (void)_drainRings {
+    _YYCacheTraceRing **link = &_rings;
+    while (*link) {
+        _YYCacheTraceRing *ring = *link;
+        // read the flag before the head, then all the entries of an exited thread are seen
+        BOOL exited = atomic_load_explicit(&ring->threadExited, memory_order_acquire);
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        if (head != tail) {
+            uint64_t capacity = ring->mask + 1;
+            uint64_t start = tail & ring->mask;
+            uint64_t count = head - tail;
+            uint64_t first = MIN(count, capacity - start);
+            [self _writeEntries:ring->entries + start count:first];
+            [self _writeEntries:ring->entries count:count - first];
+            atomic_store_explicit(&ring->tail, head, memory_order_release);
+        }
+        if (exited) {
+            *link = ring->recorderNext;
+            _droppedCount += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+            _YYCacheTraceRingRelease(ring);
+        } else {
+            link = &ring->recorderNext;
+        }
+    }
+}
+
+#pragma mark - public
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYCacheTraceRecorder init error" reason:@"YYCacheTraceRecorder must be initialized with a path. Use 'initWithPath:' or 'initWithPath:sampleRate:bufferCapacity:' instead." userInfo:nil];
+    return [self initWithPath:@"" sampleRate:1 bufferCapacity:kDefaultBufferCapacity];
+}
+
+- (instancetype)initWithPath:(NSString *)path {
+    return [self initWithPath:path sampleRate:1 bufferCapacity:kDefaultBufferCapacity];
+}
+
+- (instancetype)initWithPath:(NSString *)path sampleRate:(double)sampleRate bufferCapacity:(NSUInteger)bufferCapacity {
+    self = [super init];
+    if (!self) return nil;
+    pthread_mutex_init(&_lock, NULL);
+    atomic_init(&_closed, false);
+    if (path.length == 0 || !(sampleRate > 0)) return nil;
+    pthread_once(&_YYCacheTraceThreadKeyOnce, _YYCacheTraceInitThreadKey);
+
+    FILE *file = fopen(path.fileSystemRepresentation, "wb");
+    if (!file) return nil;
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    NSUInteger capacity = 2;
+    while (capacity < MIN(bufferCapacity, kMaxBufferCapacity)) capacity <<= 1;
+
+    _path = path.copy;
+    _sampleRate = MIN(sampleRate, 1);
+    _sampleThreshold = (uint64_t)(_sampleRate * 4294967296.0);
+    _bufferCapacity = capacity;
+    _fileSizeLimit = kDefaultFileSizeLimit;
+    _recorderID = atomic_fetch_add(&_YYCacheTraceNextRecorderID, 1);
+    _startTime = _YYCacheTraceNow();
+    _file = file;
+
+    YYCacheTraceFileHeader header = {{0}};
+    memcpy(header.magic, YYCacheTraceFileMagic, sizeof(header.magic));
+    header.version = YYCacheTraceFileVersion;
+    header.entrySize = sizeof(YYCacheTraceEntry);
+    header.sampleRate = _sampleRate;
+    header.startTime = (uint64_t)now.tv_sec * 1000000ULL + (uint64_t)now.tv_usec;
+    _fileSize = fwrite(&header, sizeof(header), 1, _file) * sizeof(header);
+
+    __weak typeof(self) _self = self;
+    _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+    dispatch_source_set_timer(_timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kFlushInterval * NSEC_PER_SEC)),
+                              (uint64_t)(kFlushInterval * NSEC_PER_SEC), (uint64_t)(kFlushInterval * 0.1 * NSEC_PER_SEC));
+    dispatch_source_set_event_handler(_timer, ^{
+        __strong typeof(_self) self = _self;
+        [self flush];
+    });
+    dispatch_resume(_timer);
+    return self;
+}
+
+- (void)dealloc {
+    [self close];
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void)recordOperation:(YYCacheTraceOperation)operation tier:(YYCacheTraceTier)tier key:(id)key size:(NSUInteger)size result:(YYCacheTraceResult)result {
+    if (!key || atomic_load_explicit(&_closed, memory_order_relaxed)) return;
+    uint64_t hash = _YYCacheTraceKeyHash(key);
+    if ((_YYCacheTraceMix(hash) >> 32) >= _sampleThreshold) return;
+
+    _YYCacheTraceRing *ring = _YYCacheTraceThreadRing(_recorderID);
+    if (!ring) {
+        ring = [self _addRingForCurrentThread];
+        if (!ring) return;
+    }
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail > ring->mask) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    YYCacheTraceEntry *entry = &ring->entries[head & ring->mask];
+    entry->time = _YYCacheTraceNow() - _startTime;
+    entry->key = hash;
+    entry->size = (uint32_t)MIN(size, (NSUInteger)UINT32_MAX);
+    entry->op = operation;
+    entry->tier = tier;
+    entry->result = result;
+    entry->reserved = 0;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+- (void)flush {
+    pthread_mutex_lock(&_lock);
+    [self _drainRings];
+    if (_file) fflush(_file);
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)close {
+    if (atomic_exchange(&_closed, true)) return;
+    if (_timer) dispatch_source_cancel(_timer);
+    pthread_mutex_lock(&_lock);
+    [self _drainRings];
+    for (_YYCacheTraceRing *ring = _rings, *next; ring; ring = next) {
+        next = ring->recorderNext;
+        _droppedCount += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        atomic_store_explicit(&ring->recorderClosed, true, memory_order_release);
+        _YYCacheTraceRingRelease(ring);
+    }
+    _rings = NULL;
+    if (_file) {
+        fclose(_file);
+        _file = NULL;
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+- (uint64_t)recordedCount {
+    pthread_mutex_lock(&_lock);
+    uint64_t count = _recordedCount;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (uint64_t)droppedCount {
+    pthread_mutex_lock(&_lock);
+    uint64_t count = _droppedCount;
+    for (_YYCacheTraceRing *ring = _rings; ring; ring = ring->recorderNext) {
+        count += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> (%@: %llu recorded, %llu dropped)", self.class, self, _path,
+            (unsigned long long)self.recordedCount, (unsigned long long)self.droppedCount];
+}
+
+@end
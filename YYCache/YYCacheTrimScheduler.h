@@ -0,0 +1,85 @@
+//
+//  YYCacheTrimScheduler.h
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A cache which can be trimmed by `YYCacheTrimScheduler`.
+ */
+@protocol YYCacheTrimming <NSObject>
+
+/** The interval in seconds between two automatic trims, 0 or negative to pause. */
+@property (readonly) NSTimeInterval autoTrimInterval;
+
+/**
+ How much the cache is over its limits, such as `totalCost / costLimit`.
+ Greater than 1 means over budget. It's called often, so it should be cheap.
+ */
+- (double)trimPressure;
+
+/** Trims the cache to its limits, this method blocks the calling thread until finished. */
+- (void)trimToLimits;
+
+@end
+
+
+/**
+ YYCacheTrimScheduler owns the automatic trimming of all caches in the process.
+
+ @discussion Instead of a timer for each cache, the scheduler has one timer in one
+ serial queue. Each pass trims the caches which are due (every `autoTrimInterval`
+ seconds) or over budget, the most over budget first, and at most `maxTrimsPerPass`
+ caches; the rest are trimmed in the next pass, at least `minPassInterval` seconds
+ later. The wake-ups of the caches are coalesced into these passes.
+ 
+ The trims run in a background queue, out of the scheduler's queue, so a slow disk
+ trim doesn't delay the other caches. A cache is not trimmed again until its trim
+ has finished.
+
+ `YYMemoryCache`, `YYDiskCache` and `YYCacheGroup` register themselves when created.
+ */
+@interface YYCacheTrimScheduler : NSObject
+
+/** The shared scheduler. */
++ (instancetype)sharedScheduler;
+
+/** The maximum number of caches to trim in one pass. Default is 4. */
+@property NSUInteger maxTrimsPerPass;
+
+/** The minimum interval in seconds between two passes. Default is 1.0. */
+@property NSTimeInterval minPassInterval;
+
+/**
+ Registers a cache, it will be trimmed after its `autoTrimInterval`.
+ The cache is held weakly, and unregistered automatically when released.
+ */
+- (void)registerCache:(id<YYCacheTrimming>)cache;
+
+/** Unregisters a cache, it will not be trimmed automatically. */
+- (void)unregisterCache:(id<YYCacheTrimming>)cache;
+
+/**
+ Trims a cache in the next pass, such as after a large import.
+ Multiple calls before the pass are coalesced.
+ */
+- (void)setNeedsTrimForCache:(id<YYCacheTrimming>)cache;
+
+/**
+ Reschedules a cache after its `autoTrimInterval` changed, the next trim is
+ `autoTrimInterval` seconds from now instead of the old due time.
+ */
+- (void)rescheduleCache:(id<YYCacheTrimming>)cache;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,228 @@
+//
+//  YYCacheTrimScheduler.m
+//  YYCache <https://github.com/ibireme/YYCache>
+//
+//  Created by agent on 26/10/18.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYCacheTrimScheduler.h"
+#import "YYCacheMediaTime.h"
+
+static const NSTimeInterval kPausedCheckInterval = 60; ///< recheck a paused cache's interval
+static const NSTimeInterval kCoalesceWindow = 1.0;    ///< trim the caches due soon in the same pass
+static const double kTimerLeewayRatio = 0.1;          ///< leeway of the timer, let system coalesce wake-ups
+
+/**
+ A registered cache's schedule.
+ Typically, you should not use this class directly.
+ */
+@interface _YYCacheTrimEntry : NSObject {
+    @package
+    __weak id<YYCacheTrimming> _cache;
+    NSTimeInterval _due; ///< media time
+    BOOL _trimming; ///< the trim is running out of the scheduler's queue
+}
+@end
+
+@implementation _YYCacheTrimEntry
+@end
+
+
+@implementation YYCacheTrimScheduler {
+    dispatch_queue_t _queue; ///< serial, all the states are accessed in this queue
+    dispatch_source_t _timer;
+    NSTimeInterval _timerFireTime; ///< 0 means not scheduled
+    NSTimeInterval _lastPassTime;
+    NSMutableArray *_entries; ///< _YYCacheTrimEntry
+}
+
+#pragma mark - private
+
+static NSTimeInterval _YYCacheTrimIntervalOf(id<YYCacheTrimming> cache) {
+    NSTimeInterval interval = cache.autoTrimInterval;
+    return interval > 0 ? interval : kPausedCheckInterval;
+}
+
+- (_YYCacheTrimEntry *)_entryForCache:(id<YYCacheTrimming>)cache {
+    for (_YYCacheTrimEntry *entry in _entries) {
+        if (entry->_cache == cache) return entry;
+    }
+    return nil;
+}
+
+/// Set the timer to fire at the earliest due, should be called in queue.
+- (void)_schedule {
+    NSTimeInterval earliest = DBL_MAX;
+    for (_YYCacheTrimEntry *entry in _entries) {
+        if (entry->_trimming) continue; // rescheduled when finished
+        if (entry->_due < earliest) earliest = entry->_due;
+    }
+    if (earliest == DBL_MAX) {
+        _timerFireTime = 0;
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+    NSTimeInterval fireTime = MAX(earliest, _lastPassTime + self.minPassInterval);
+    if (_timerFireTime > 0 && _timerFireTime <= fireTime) return; // an earlier pass will reschedule
+
+    _timerFireTime = fireTime;
+    NSTimeInterval delay = MAX(fireTime - CACurrentMediaTime(), 0);
+    uint64_t leeway = (uint64_t)(delay * kTimerLeewayRatio * NSEC_PER_SEC);
+    dispatch_source_set_timer(_timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, leeway);
+}
+
+/// Trim a cache in background, so a slow trim (such as a disk cache) doesn't delay the
+/// other caches and the passes. Should be called in queue.
+- (void)_trimCache:(id<YYCacheTrimming>)cache entry:(_YYCacheTrimEntry *)entry {
+    entry->_trimming = YES;
+    entry->_due = DBL_MAX; // set when finished, unless changed during the trim
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+        @autoreleasepool {
+            [cache trimToLimits];
+        }
+        dispatch_async(self->_queue, ^{
+            entry->_trimming = NO;
+            if (entry->_due == DBL_MAX) entry->_due = CACurrentMediaTime() + _YYCacheTrimIntervalOf(cache);
+            [self _schedule];
+        });
+    });
+}
+
+/// Trim the due or over budget caches, the most over budget first, should be called in queue.
+- (void)_pass {
+    NSTimeInterval now = CACurrentMediaTime();
+    _timerFireTime = 0;
+    _lastPassTime = now;
+
+    NSMutableArray *candidates = [NSMutableArray new];
+    NSMutableArray *pressures = [NSMutableArray new];
+    NSMutableIndexSet *released = [NSMutableIndexSet new];
+    [_entries enumerateObjectsUsingBlock:^(_YYCacheTrimEntry *entry, NSUInteger idx, BOOL *stop) {
+        id<YYCacheTrimming> cache = entry->_cache;
+        if (!cache) {
+            [released addIndex:idx];
+            return;
+        }
+        if (entry->_trimming) return;
+        double pressure = cache.trimPressure;
+        if (entry->_due <= now + kCoalesceWindow || pressure > 1) {
+            [candidates addObject:entry];
+            [pressures addObject:@(pressure)];
+        }
+    }];
+    [_entries removeObjectsAtIndexes:released];
+
+    NSMutableArray *order = [NSMutableArray new];
+    for (NSUInteger i = 0; i < candidates.count; i++) [order addObject:@(i)];
+    [order sortUsingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b) {
+        NSComparisonResult result = [pressures[b.unsignedIntegerValue] compare:pressures[a.unsignedIntegerValue]];
+        if (result != NSOrderedSame) return result;
+        NSTimeInterval dueA = ((_YYCacheTrimEntry *)candidates[a.unsignedIntegerValue])->_due;
+        NSTimeInterval dueB = ((_YYCacheTrimEntry *)candidates[b.unsignedIntegerValue])->_due;
+        return dueA < dueB ? NSOrderedAscending : (dueA > dueB ? NSOrderedDescending : NSOrderedSame);
+    }];
+
+    NSUInteger limit = MAX(self.maxTrimsPerPass, 1);
+    for (NSUInteger i = 0; i < order.count && i < limit; i++) {
+        _YYCacheTrimEntry *entry = candidates[[order[i] unsignedIntegerValue]];
+        id<YYCacheTrimming> cache = entry->_cache;
+        if (!cache) continue;
+        if (cache.autoTrimInterval > 0) {
+            [self _trimCache:cache entry:entry];
+        } else {
+            entry->_due = now + _YYCacheTrimIntervalOf(cache);
+        }
+    }
+    // the rest are still due, and will be trimmed after minPassInterval
+    [self _schedule];
+}
+
+#pragma mark - public
+
++ (instancetype)sharedScheduler {
+    static YYCacheTrimScheduler *scheduler;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        scheduler = [[self alloc] init];
+    });
+    return scheduler;
+}
+
+- (instancetype)init {
+    self = [super init];
+    _maxTrimsPerPass = 4;
+    _minPassInterval = 1.0;
+    _entries = [NSMutableArray new];
+    _queue = dispatch_queue_create("com.ibireme.cache.trim", DISPATCH_QUEUE_SERIAL);
+    dispatch_set_target_queue(_queue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+    _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+    __weak typeof(self) _self = self;
+    dispatch_source_set_event_handler(_timer, ^{
+        __strong typeof(_self) self = _self;
+        [self _pass];
+    });
+    dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+    dispatch_resume(_timer);
+    return self;
+}
+
+- (void)dealloc {
+    dispatch_source_cancel(_timer);
+}
+
+- (void)registerCache:(id<YYCacheTrimming>)cache {
+    if (!cache) return;
+    __weak id<YYCacheTrimming> weakCache = cache;
+    dispatch_async(_queue, ^{
+        id<YYCacheTrimming> cache = weakCache;
+        if (!cache || [self _entryForCache:cache]) return;
+        _YYCacheTrimEntry *entry = [_YYCacheTrimEntry new];
+        entry->_cache = cache;
+        entry->_due = CACurrentMediaTime() + _YYCacheTrimIntervalOf(cache);
+        [self->_entries addObject:entry];
+        [self _schedule];
+    });
+}
+
+- (void)unregisterCache:(id<YYCacheTrimming>)cache {
+    if (!cache) return;
+    __weak id<YYCacheTrimming> weakCache = cache;
+    dispatch_async(_queue, ^{
+        id<YYCacheTrimming> cache = weakCache;
+        if (!cache) return; // released, removed in next pass
+        _YYCacheTrimEntry *entry = [self _entryForCache:cache];
+        if (entry) [self->_entries removeObject:entry];
+    });
+}
+
+- (void)setNeedsTrimForCache:(id<YYCacheTrimming>)cache {
+    if (!cache) return;
+    __weak id<YYCacheTrimming> weakCache = cache;
+    dispatch_async(_queue, ^{
+        id<YYCacheTrimming> cache = weakCache;
+        if (!cache) return;
+        _YYCacheTrimEntry *entry = [self _entryForCache:cache];
+        if (!entry) return;
+        entry->_due = 0; // coalesced, already due
+        [self _schedule];
+    });
+}
+
+- (void)rescheduleCache:(id<YYCacheTrimming>)cache {
+    if (!cache) return;
+    __weak id<YYCacheTrimming> weakCache = cache;
+    dispatch_async(_queue, ^{
+        id<YYCacheTrimming> cache = weakCache;
+        if (!cache) return;
+        _YYCacheTrimEntry *entry = [self _entryForCache:cache];
+        if (!entry || entry->_due == 0) return; // already due
+        entry->_due = CACurrentMediaTime() + _YYCacheTrimIntervalOf(cache);
+        [self _schedule];
+    });
+}
+
+@end
@@ -11,6 +11,16 @@
 
 #import <Foundation/Foundation.h>
 
+#if __has_include(<YYCache/YYKVStorage.h>)
+#import <YYCache/YYKVStorage.h>
+#elif __has_include(<YYWebImage/YYKVStorage.h>)
+#import <YYWebImage/YYKVStorage.h>
+#else
+#import "YYKVStorage.h"
+#endif
+
+@class YYCacheTraceRecorder, YYCacheLockStats;
+
 NS_ASSUME_NONNULL_BEGIN
 
 /**
@@ -19,7 +29,7 @@ NS_ASSUME_NONNULL_BEGIN
  
  YYDiskCache has these features:
  
- * It use LRU (least-recently-used) to remove objects.
+ * It use LRU (least-recently-used) or GDSF (GreedyDual-Size-Frequency) to remove objects.
  * It can be controlled by cost, count, and age.
  * It can be configured to automatically evict objects when there's no free disk space.
  * It can automatically decide the storage type (sqlite/file) for each object to get
@@ -126,16 +136,49 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  The auto trim check time interval in seconds. Default is 60 (1 minute).
  
- @discussion The cache holds an internal timer to check whether the cache reaches
- its limits, and if the limit is reached, it begins to evict objects.
+ @discussion The cache is checked by the shared `YYCacheTrimScheduler`, with the
+ other caches in one timer. If the limit is reached, it begins to evict objects.
  */
 @property NSTimeInterval autoTrimInterval;
 
+/**
+ The eviction policy used when the cache is trimmed by cost or count.
+ 
+ @discussion The default value is YYKVStorageEvictionPolicyLRU. Set it to
+ YYKVStorageEvictionPolicyGDSF if the objects' size varies widely, then the small
+ and frequently accessed objects are kept longer, and the object hit ratio goes up
+ at the same disk budget. See `YYKVStorageEvictionPolicy` for more information.
+ The trim by age always removes objects by last access time.
+ */
+@property YYKVStorageEvictionPolicy evictionPolicy;
+
 /**
  Set `YES` to enable error logs for debug.
  */
 @property BOOL errorLogsEnabled;
 
+/**
+ The recorder of the accesses (get, set and remove), to replay the real access
+ pattern and plan the limits. The default value is nil, which costs one check
+ per access. The size of an entry is the archived data length.
+ See `YYCacheTraceRecorder` for more information.
+ */
+@property (nullable, strong) YYCacheTraceRecorder *traceRecorder;
+
+/**
+ Whether to profile the contention of the cache's lock, see `lockStats`.
+ The default value is NO. Enabling it resets the stats.
+ */
+@property BOOL lockProfilingEnabled;
+
+/**
+ The contention of the cache's lock since the profiling was enabled: acquisitions,
+ contended acquisitions, wait and hold time, in total and for get, set, remove, trim,
+ the WAL checkpoints and the other operations. All zero if it's never enabled.
+ See `YYCacheLockStats` for more information.
+ */
+- (YYCacheLockStats *)lockStats;
+
 #pragma mark - Initializer
 ///=============================================================================
 /// @name Initializer
@@ -221,6 +264,52 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)objectForKey:(NSString *)key withBlock:(void(^)(NSString *key, id<NSCoding> _Nullable object))block;
 
+/**
+ Returns the value associated with a given key, and whether it's stale.
+ This method may blocks the calling thread until file read finished.
+ 
+ @discussion An object which is past its soft TTL is still returned (stale), and
+ `needsRefresh` is set to `YES`, so you can use the stale value immediately and 
+ refresh it in background. An object which is past its hard TTL is never returned.
+ 
+ @param key          A string identifying the value. If nil, just return nil.
+ @param needsRefresh Output whether the value is past its soft TTL, pass NULL to ignore.
+ @return The value associated with key, or nil if no value is associated with key.
+ */
+- (nullable id<NSCoding>)objectForKey:(NSString *)key needsRefresh:(nullable BOOL *)needsRefresh;
+
+/**
+ Returns the value associated with a given key, and whether it's stale.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param key   A string identifying the value. If nil, just return nil.
+ @param block A block which will be invoked in background queue when finished.
+ */
+- (void)objectForKey:(NSString *)key withRefreshBlock:(void(^)(NSString *key, id<NSCoding> _Nullable object, BOOL needsRefresh))block;
+
+/**
+ Returns the values associated with the given keys.
+ This method may blocks the calling thread until file read finished.
+ 
+ @discussion The items are fetched with multi-key queries, and unarchived concurrently.
+ 
+ @param keys An array of keys.
+ @return A dictionary which key is the key and value is the value, the keys which 
+     are not in cache are not included.
+ */
+- (NSDictionary<NSString *, id<NSCoding>> *)objectsForKeys:(NSArray<NSString *> *)keys;
+
+/**
+ Returns the values associated with the given keys.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param keys  An array of keys.
+ @param block A block which will be invoked in background queue when finished.
+ */
+- (void)objectsForKeys:(NSArray<NSString *> *)keys withBlock:(void(^)(NSDictionary<NSString *, id<NSCoding>> *objects))block;
+
 /**
  Sets the value of the specified key in the cache.
  This method may blocks the calling thread until file write finished.
@@ -230,6 +319,35 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key;
 
+/**
+ Sets the value of the specified key in the cache, with a soft and a hard TTL.
+ This method may blocks the calling thread until file write finished.
+ 
+ @discussion After the soft TTL, the object is stale but still readable, see
+ `objectForKey:needsRefresh:`. After the hard TTL, the object is treated as not
+ exists and will be removed by the auto trim. The TTLs are stored with the object,
+ the `ageLimit` still works as before.
+ 
+ @param object  The object to be stored in the cache. If nil, it calls `removeObjectForKey:`.
+ @param key     The key with which to associate the value. If nil, this method has no effect.
+ @param softTTL The soft time-to-live in seconds, 0 means never stale.
+ @param hardTTL The hard time-to-live in seconds, 0 means never expire.
+ */
+- (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL;
+
+/**
+ Sets the value of the specified key in the cache, with a soft and a hard TTL.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param object  The object to be stored in the cache. If nil, it calls `removeObjectForKey:`.
+ @param key     The key with which to associate the value. If nil, this method has no effect.
+ @param softTTL The soft time-to-live in seconds, 0 means never stale.
+ @param hardTTL The hard time-to-live in seconds, 0 means never expire.
+ @param block   A block which will be invoked in background queue when finished.
+ */
+- (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL withBlock:(nullable void(^)(void))block;
+
 /**
  Sets the value of the specified key in the cache.
  This method returns immediately and invoke the passed block in background queue
@@ -240,6 +358,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key withBlock:(void(^)(void))block;
 
+/**
+ Sets the values of the specified keys in the cache, in one transaction.
+ This method may blocks the calling thread until file write finished.
+ 
+ @discussion It's much faster than calling `setObject:forKey:` for each object when
+ writing many objects, the objects are archived out of lock and saved with one commit.
+ 
+ @param objects The objects to be stored in the cache.
+ @param keys    The keys with which to associate the values, the count should be
+     same as objects.
+ */
+- (void)setObjects:(NSArray<id<NSCoding>> *)objects forKeys:(NSArray<NSString *> *)keys;
+
+/**
+ Sets the values of the specified keys in the cache with time-to-lives, in one transaction.
+ This method may blocks the calling thread until file write finished.
+ 
+ @param objects  The objects to be stored in the cache.
+ @param keys     The keys with which to associate the values, the count should be
+     same as objects.
+ @param softTTLs The soft time-to-lives in seconds (NSNumber, 0 means never stale),
+     nil or the same count as objects.
+ @param hardTTLs The hard time-to-lives in seconds (NSNumber, 0 means never expire),
+     nil or the same count as objects.
+ */
+- (void)setObjects:(NSArray<id<NSCoding>> *)objects forKeys:(NSArray<NSString *> *)keys softTTLs:(nullable NSArray<NSNumber *> *)softTTLs hardTTLs:(nullable NSArray<NSNumber *> *)hardTTLs;
+
 /**
  Removes the value of the specified key in the cache.
  This method may blocks the calling thread until file delete finished.
@@ -326,7 +471,7 @@ NS_ASSUME_NONNULL_BEGIN
 ///=============================================================================
 
 /**
- Removes objects from the cache use LRU, until the `totalCount` is below the specified value.
+ Removes objects from the cache with `evictionPolicy`, until the `totalCount` is below the specified value.
  This method may blocks the calling thread until operation finished.
  
  @param count  The total count allowed to remain after the cache has been trimmed.
@@ -334,7 +479,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)trimToCount:(NSUInteger)count;
 
 /**
- Removes objects from the cache use LRU, until the `totalCount` is below the specified value.
+ Removes objects from the cache with `evictionPolicy`, until the `totalCount` is below the specified value.
  This method returns immediately and invoke the passed block in background queue
  when the operation finished.
  
@@ -344,7 +489,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)trimToCount:(NSUInteger)count withBlock:(void(^)(void))block;
 
 /**
- Removes objects from the cache use LRU, until the `totalCost` is below the specified value.
+ Removes objects from the cache with `evictionPolicy`, until the `totalCost` is below the specified value.
  This method may blocks the calling thread until operation finished.
  
  @param cost The total cost allowed to remain after the cache has been trimmed.
@@ -352,7 +497,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)trimToCost:(NSUInteger)cost;
 
 /**
- Removes objects from the cache use LRU, until the `totalCost` is below the specified value.
+ Removes objects from the cache with `evictionPolicy`, until the `totalCost` is below the specified value.
  This method returns immediately and invoke the passed block in background queue
  when the operation finished.
  
@@ -380,6 +525,161 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)trimToAge:(NSTimeInterval)age withBlock:(void(^)(void))block;
 
 
+#pragma mark - Key Prefix
+///=============================================================================
+/// @name Key Prefix
+///=============================================================================
+
+/**
+ Removes the objects which key has the specified prefix.
+ This method may blocks the calling thread until file delete finished.
+ 
+ @param prefix  A non-empty key prefix, the last character should not be 0xFFFF.
+ */
+- (void)removeObjectsWithKeyPrefix:(NSString *)prefix;
+
+/**
+ Removes the objects which key has the specified prefix.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param prefix  A non-empty key prefix, the last character should not be 0xFFFF.
+ @param block   A block which will be invoked in background queue when finished.
+ */
+- (void)removeObjectsWithKeyPrefix:(NSString *)prefix withBlock:(nullable void(^)(void))block;
+
+/**
+ Returns the number of objects which key has the specified prefix.
+ This method may blocks the calling thread until file read finished.
+ */
+- (NSInteger)totalCountWithKeyPrefix:(NSString *)prefix;
+
+/**
+ Returns the total cost (in bytes) of objects which key has the specified prefix.
+ This method may blocks the calling thread until file read finished.
+ */
+- (NSInteger)totalCostWithKeyPrefix:(NSString *)prefix;
+
+/**
+ Removes objects which key has the specified prefix with `evictionPolicy`, until
+ the count of these objects is below the specified value.
+ This method may blocks the calling thread until operation finished.
+ */
+- (void)trimToCount:(NSUInteger)count withKeyPrefix:(NSString *)prefix;
+
+/**
+ Removes objects which key has the specified prefix with `evictionPolicy`, until
+ the cost of these objects is below the specified value.
+ This method may blocks the calling thread until operation finished.
+ */
+- (void)trimToCost:(NSUInteger)cost withKeyPrefix:(NSString *)prefix;
+
+
+#pragma mark - Archive
+///=============================================================================
+/// @name Archive
+///=============================================================================
+
+/**
+ Writes all objects in the cache to a single portable archive file.
+ 
+ @discussion The archive contains the key, the archived value, the extended data
+ and the expiry time of each object, written as a stream page by page, so the
+ memory usage does not grow with the cache size. The archive is byte order
+ independent, and can be imported by another cache which use the same archive 
+ (`customArchiveBlock` / `customUnarchiveBlock`) method.
+ 
+ This method may blocks the calling thread until file write finished, but the 
+ cache is only locked while reading each page.
+ 
+ @param path  The archive file path, the file will be replaced if it exists.
+ @return Whether succeed.
+ */
+- (BOOL)exportToArchiveAtPath:(NSString *)path;
+
+/**
+ Writes all objects in the cache to a single portable archive file.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param path   The archive file path, the file will be replaced if it exists.
+ @param block  A block which will be invoked in background queue when finished.
+ */
+- (void)exportToArchiveAtPath:(NSString *)path withBlock:(nullable void(^)(BOOL succeed))block;
+
+/**
+ Imports the objects from an archive file which is written by `exportToArchiveAtPath:`.
+ 
+ @discussion The objects are saved in batched transactions without unarchiving, and 
+ the values are copied from the mapped archive to sqlite or file directly. The 
+ objects with the same key in the cache are replaced, and the hard expired objects 
+ in the archive are skipped. If the cache goes over the limit, the objects will 
+ be evicted later in background.
+ 
+ This method may blocks the calling thread until operation finished.
+ 
+ @param path  The archive file path.
+ @return The number of imported objects, or -1 if the archive is invalid or an error occurs.
+ */
+- (NSInteger)importFromArchiveAtPath:(NSString *)path;
+
+/**
+ Imports the objects from an archive file which is written by `exportToArchiveAtPath:`.
+ This method returns immediately and invoke the passed block in background queue
+ when the operation finished.
+ 
+ @param path   The archive file path.
+ @param block  A block which will be invoked in background queue when finished.
+ */
+- (void)importFromArchiveAtPath:(NSString *)path withBlock:(nullable void(^)(NSInteger importedCount))block;
+
+
+#pragma mark - Storage Item
+///=============================================================================
+/// @name Storage Item
+///=============================================================================
+
+/**
+ Returns the storage item (archived value and meta data) associated with a given key.
+ This method may blocks the calling thread until file read finished.
+ 
+ @discussion Use `objectFromItem:` to unarchive the object. It's useful when you 
+ need the meta data (such as size or TTL) with the object.
+ 
+ @param key A string identifying the value. If nil, just return nil.
+ @return The item associated with key, or nil if no value is associated with key.
+ */
+- (nullable YYKVStorageItem *)itemForKey:(NSString *)key;
+
+/**
+ Unarchive the object from a storage item, with `customUnarchiveBlock` if it's not nil.
+ The item's extended data will be set to the object.
+ 
+ @param item An item returned by `itemForKey:`.
+ @return The unarchived object, or nil if an error occurs.
+ */
+- (nullable id<NSCoding>)objectFromItem:(YYKVStorageItem *)item;
+
+/**
+ Returns the storage items associated with the given keys, with their values.
+ The keys are queried in a few multi-key queries instead of one query per key.
+ This method may blocks the calling thread until file read finished.
+ 
+ @param keys An array of keys.
+ @return An array of items, the keys which are not in cache are not included.
+ */
+- (NSArray<YYKVStorageItem *> *)itemsForKeys:(NSArray<NSString *> *)keys;
+
+/**
+ Unarchive the objects from storage items concurrently, see `objectFromItem:`.
+ 
+ @param items Items returned by `itemsForKeys:`.
+ @return A dictionary which key is the item's key and value is the object, the 
+     items which can not be unarchived are not included.
+ */
+- (NSDictionary<NSString *, id<NSCoding>> *)objectsFromItems:(NSArray<YYKVStorageItem *> *)items;
+
+
 #pragma mark - Extended Data
 ///=============================================================================
 /// @name Extended Data
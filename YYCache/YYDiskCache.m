@@ -11,15 +11,34 @@
 
 #import "YYDiskCache.h"
 #import "YYKVStorage.h"
+#import "YYCacheTrimScheduler.h"
+#import "YYCacheTraceRecorder.h"
+#import "YYCacheMetricsPrivate.h"
+#import "YYCacheLockProfilePrivate.h"
+#if __has_include(<UIKit/UIKit.h>)
 #import <UIKit/UIKit.h>
+#endif
+#if __has_include(<CommonCrypto/CommonCrypto.h>)
 #import <CommonCrypto/CommonCrypto.h>
+#else
+#import <openssl/evp.h>
+#define CC_MD5_DIGEST_LENGTH 16
+#define CC_LONG size_t
+/// CommonCrypto's MD5 with OpenSSL's EVP API, as MD5() is deprecated since OpenSSL 3.
+static unsigned char *CC_MD5(const void *data, CC_LONG len, unsigned char *md) {
+    EVP_Digest(data, len, md, NULL, EVP_md5(), NULL);
+    return md;
+}
+#endif
 #import <objc/runtime.h>
+#import <stdatomic.h>
 #import <time.h>
 
-#define Lock() dispatch_semaphore_wait(self->_lock, DISPATCH_TIME_FOREVER)
-#define Unlock() dispatch_semaphore_signal(self->_lock)
+#define Lock(_op_) YYCacheMetricsMeasure(YYCacheMetricDiskLockWait, YYCacheLockProfileSemaphoreWait(self->_lock, &self->_lockProfile, YYCacheLockOperation##_op_))
+#define Unlock() YYCacheLockProfileSemaphoreSignal(self->_lock, &self->_lockProfile)
 
 static const int extended_data_key;
+static const NSUInteger kMultiGetChunkCount = 256; ///< keys per query, below the sqlite variable limit
 
 /// Free disk space in bytes.
 static int64_t _YYDiskSpaceFree() {
@@ -77,36 +96,106 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     dispatch_semaphore_signal(_globalInstancesLock);
 }
 
+/// Convert a time-to-live to a unix timestamp, 0 means never expire.
+static int _YYDiskCacheExpireTime(NSTimeInterval ttl) {
+    if (ttl <= 0) return 0;
+    long timestamp = time(NULL);
+    if (ttl >= INT_MAX - timestamp) return 0;
+    return (int)(timestamp + MAX(ttl, 1));
+}
+
+
+/*
+ Archive file (little endian):
+ 
+ header:  "YYDA" | uint32 version
+ entries: uint32 key length | key (utf8) | uint32 value length | value |
+          uint32 extended data length | extended data |
+          int32 soft expire time | int32 hard expire time    ...repeated
+ end:     uint32 0
+ */
+static const char kArchiveMagic[4] = {'Y', 'Y', 'D', 'A'};
+static const uint32_t kArchiveVersion = 1;
+static const int kArchivePageCount = 256;                    ///< items per page when export
+static const NSUInteger kArchiveBatchCount = 512;            ///< items per transaction when import
+static const NSUInteger kArchiveBatchSize = 1024 * 1024 * 16; ///< bytes per transaction when import
+
+static BOOL _YYDiskArchiveWriteUInt32(FILE *file, uint32_t value) {
+    value = CFSwapInt32HostToLittle(value);
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+static BOOL _YYDiskArchiveWriteData(FILE *file, NSData *data) {
+    if (data.length > UINT32_MAX) return NO;
+    if (!_YYDiskArchiveWriteUInt32(file, (uint32_t)data.length)) return NO;
+    return data.length == 0 || fwrite(data.bytes, 1, data.length, file) == data.length;
+}
+
+static BOOL _YYDiskArchiveReadUInt32(const uint8_t **p, const uint8_t *end, uint32_t *value) {
+    if ((size_t)(end - *p) < sizeof(uint32_t)) return NO;
+    uint32_t v;
+    memcpy(&v, *p, sizeof(v));
+    *p += sizeof(v);
+    *value = CFSwapInt32LittleToHost(v);
+    return YES;
+}
+
 
+@interface YYDiskCache () <YYCacheTrimming>
+@end
 
 @implementation YYDiskCache {
     YYKVStorage *_kv;
     dispatch_semaphore_t _lock;
+    YYCacheLockProfile _lockProfile;
     dispatch_queue_t _queue;
+    _Atomic(NSInteger) _estimatedCost; ///< measured in trim and increased by writes (in lock), -1 means unknown
+    _Atomic(NSInteger) _estimatedCount; ///< measured in trim and increased by writes (in lock), -1 means unknown
+    _Atomic(NSTimeInterval) _autoTrimInterval; ///< read by the scheduler, not in lock
 }
 
-- (void)_trimRecursively {
-    __weak typeof(self) _self = self;
-    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_autoTrimInterval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
-        __strong typeof(_self) self = _self;
-        if (!self) return;
-        [self _trimInBackground];
-        [self _trimRecursively];
-    });
+- (void)_trimInBackground {
+    [[YYCacheTrimScheduler sharedScheduler] setNeedsTrimForCache:self];
+}
+
+- (void)trimToLimits {
+    Lock(Trim);
+    NSUInteger costLimit = self.costLimit, countLimit = self.countLimit;
+    [self _trimToCost:costLimit];
+    [self _trimToCount:countLimit];
+    [self _trimToAge:self.ageLimit];
+    [self _trimToFreeDiskSpace:self.freeDiskSpaceLimit];
+    [self _trimExpired];
+    // only measure when limited, the trim has already read the same sum
+    atomic_store(&_estimatedCost, costLimit < INT_MAX ? [_kv getItemsSize] : -1);
+    atomic_store(&_estimatedCount, countLimit < INT_MAX ? [_kv getItemsCount] : -1);
+    Unlock();
 }
 
-- (void)_trimInBackground {
-    __weak typeof(self) _self = self;
-    dispatch_async(_queue, ^{
-        __strong typeof(_self) self = _self;
-        if (!self) return;
-        Lock();
-        [self _trimToCost:self.costLimit];
-        [self _trimToCount:self.countLimit];
-        [self _trimToAge:self.ageLimit];
-        [self _trimToFreeDiskSpace:self.freeDiskSpaceLimit];
-        Unlock();
-    });
+/// Overwrites are counted again, so the estimate is an upper bound until next trim. Called in lock.
+/// The write which goes over budget asks the scheduler to trim now instead of at the due time.
+- (void)_estimateWrittenCost:(NSUInteger)cost count:(NSUInteger)count {
+    BOOL overBudget = NO;
+    if (atomic_load(&_estimatedCost) >= 0) {
+        NSInteger old = atomic_fetch_add(&_estimatedCost, (NSInteger)cost);
+        NSInteger limit = (NSInteger)MIN(self.costLimit, (NSUInteger)NSIntegerMax);
+        if (old <= limit && old + (NSInteger)cost > limit) overBudget = YES;
+    }
+    if (atomic_load(&_estimatedCount) >= 0) {
+        NSInteger old = atomic_fetch_add(&_estimatedCount, (NSInteger)count);
+        NSInteger limit = (NSInteger)MIN(self.countLimit, (NSUInteger)NSIntegerMax);
+        if (old <= limit && old + (NSInteger)count > limit) overBudget = YES;
+    }
+    if (overBudget) [self _trimInBackground];
+}
+
+/// Estimated from the last trim and the writes since, without a query.
+/// Not in lock, which may be held by a long write, the estimates are atomic.
+- (double)trimPressure {
+    NSInteger cost = atomic_load(&_estimatedCost), count = atomic_load(&_estimatedCount);
+    double costPressure = cost > 0 ? (double)cost / MAX(self.costLimit, 1) : 0;
+    double countPressure = count > 0 ? (double)count / MAX(self.countLimit, 1) : 0;
+    return MAX(costPressure, countPressure);
 }
 
 - (void)_trimToCost:(NSUInteger)costLimit {
@@ -132,6 +221,12 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     [_kv removeItemsEarlierThanTime:(int)age];
 }
 
+- (void)_trimExpired {
+    long timestamp = time(NULL);
+    if (timestamp >= INT_MAX) return;
+    [_kv removeItemsExpiredEarlierThanTime:(int)timestamp];
+}
+
 - (void)_trimToFreeDiskSpace:(NSUInteger)targetFreeDiskSpace {
     if (targetFreeDiskSpace == 0) return;
     int64_t totalBytes = [_kv getItemsSize];
@@ -152,8 +247,32 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     return filename;
 }
 
+/// The filename to save the value, nil if the value should be saved in sqlite.
+- (NSString *)_filenameForKey:(NSString *)key valueLength:(NSUInteger)length {
+    if (_kv.type == YYKVStorageTypeSQLite) return nil;
+    if (length <= _inlineThreshold) return nil;
+    return [self _filenameForKey:key];
+}
+
+- (NSData *)_dataFromObject:(id<NSCoding>)object {
+    NSData *value = nil;
+    YYCacheMetricsBegin(start);
+    if (_customArchiveBlock) {
+        value = _customArchiveBlock(object);
+    } else {
+        @try {
+            value = [NSKeyedArchiver archivedDataWithRootObject:object];
+        }
+        @catch (NSException *exception) {
+            // nothing to do...
+        }
+    }
+    YYCacheMetricsEnd(YYCacheMetricDiskArchive, start);
+    return value;
+}
+
 - (void)_appWillBeTerminated {
-    Lock();
+    Lock(Checkpoint);
     _kv = nil;
     Unlock();
 }
@@ -161,7 +280,9 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 #pragma mark - public
 
 - (void)dealloc {
+#if __has_include(<UIKit/UIKit.h>)
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationWillTerminateNotification object:nil];
+#endif
 }
 
 - (instancetype)init {
@@ -194,6 +315,7 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     if (!kv) return nil;
     
     _kv = kv;
+    _kv.lockProfile = &_lockProfile;
     _path = path;
     _lock = dispatch_semaphore_create(1);
     _queue = dispatch_queue_create("com.ibireme.cache.disk", DISPATCH_QUEUE_CONCURRENT);
@@ -202,18 +324,22 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     _costLimit = NSUIntegerMax;
     _ageLimit = DBL_MAX;
     _freeDiskSpaceLimit = 0;
-    _autoTrimInterval = 60;
+    atomic_init(&_autoTrimInterval, 60);
+    atomic_init(&_estimatedCost, -1);
+    atomic_init(&_estimatedCount, -1);
     
-    [self _trimRecursively];
+    [[YYCacheTrimScheduler sharedScheduler] registerCache:self];
     _YYDiskCacheSetGlobal(self);
     
+#if __has_include(<UIKit/UIKit.h>)
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_appWillBeTerminated) name:UIApplicationWillTerminateNotification object:nil];
+#endif
     return self;
 }
 
 - (BOOL)containsObjectForKey:(NSString *)key {
     if (!key) return NO;
-    Lock();
+    Lock(Get);
     BOOL contains = [_kv itemExistsForKey:key];
     Unlock();
     return contains;
@@ -230,13 +356,38 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 }
 
 - (id<NSCoding>)objectForKey:(NSString *)key {
+    return [self objectForKey:key needsRefresh:NULL];
+}
+
+- (id<NSCoding>)objectForKey:(NSString *)key needsRefresh:(BOOL *)needsRefresh {
+    YYCacheMetricsBegin(start);
+    YYKVStorageItem *item = [self itemForKey:key];
+    id<NSCoding> object = item ? [self objectFromItem:item] : nil;
+    if (needsRefresh) {
+        *needsRefresh = object && item.softExpireTime > 0 && item.softExpireTime <= time(NULL);
+    }
+    YYCacheMetricsEnd(YYCacheMetricDiskGet, start);
+    return object;
+}
+
+- (YYKVStorageItem *)itemForKey:(NSString *)key {
     if (!key) return nil;
-    Lock();
+    Lock(Get);
     YYKVStorageItem *item = [_kv getItemForKey:key];
     Unlock();
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        [recorder recordOperation:YYCacheTraceOperationGet tier:YYCacheTraceTierDisk key:key size:item.value.length
+                           result:item.value ? YYCacheTraceResultHit : YYCacheTraceResultMiss];
+    }
+    return item.value ? item : nil;
+}
+
+- (id<NSCoding>)objectFromItem:(YYKVStorageItem *)item {
     if (!item.value) return nil;
     
     id object = nil;
+    YYCacheMetricsBegin(start);
     if (_customUnarchiveBlock) {
         object = _customUnarchiveBlock(item.value);
     } else {
@@ -247,12 +398,74 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
             // nothing to do...
         }
     }
+    YYCacheMetricsEnd(YYCacheMetricDiskUnarchive, start);
     if (object && item.extendedData) {
         [YYDiskCache setExtendedData:item.extendedData toObject:object];
     }
     return object;
 }
 
+- (NSArray<YYKVStorageItem *> *)itemsForKeys:(NSArray<NSString *> *)keys {
+    NSMutableArray *items = [NSMutableArray new];
+    for (NSUInteger i = 0, max = keys.count; i < max; i += kMultiGetChunkCount) {
+        NSArray *chunk = [keys subarrayWithRange:NSMakeRange(i, MIN(kMultiGetChunkCount, max - i))];
+        Lock(Get);
+        NSArray *chunkItems = [_kv getItemForKeys:chunk];
+        Unlock();
+        for (YYKVStorageItem *item in chunkItems) {
+            if (item.value) [items addObject:item];
+        }
+        YYCacheTraceRecorder *recorder = self.traceRecorder;
+        if (recorder) {
+            NSMutableDictionary *lengths = [NSMutableDictionary new];
+            for (YYKVStorageItem *item in chunkItems) {
+                if (item.value && item.key) lengths[item.key] = @(item.value.length);
+            }
+            for (NSString *key in chunk) {
+                NSNumber *length = lengths[key];
+                [recorder recordOperation:YYCacheTraceOperationGet tier:YYCacheTraceTierDisk key:key size:length.unsignedIntegerValue
+                                   result:length ? YYCacheTraceResultHit : YYCacheTraceResultMiss];
+            }
+        }
+    }
+    return items;
+}
+
+- (NSDictionary<NSString *, id<NSCoding>> *)objectsFromItems:(NSArray<YYKVStorageItem *> *)items {
+    NSUInteger count = items.count;
+    NSMutableDictionary *objects = [NSMutableDictionary new];
+    if (count == 0) return objects;
+    if (count == 1) {
+        id<NSCoding> object = [self objectFromItem:items.firstObject];
+        if (object) objects[((YYKVStorageItem *)items.firstObject).key] = object;
+        return objects;
+    }
+    dispatch_semaphore_t lock = dispatch_semaphore_create(1);
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        YYKVStorageItem *item = items[i];
+        id<NSCoding> object = [self objectFromItem:item];
+        if (!object || !item.key) return;
+        dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
+        objects[item.key] = object;
+        dispatch_semaphore_signal(lock);
+    });
+    return objects;
+}
+
+- (NSDictionary<NSString *, id<NSCoding>> *)objectsForKeys:(NSArray<NSString *> *)keys {
+    return [self objectsFromItems:[self itemsForKeys:keys]];
+}
+
+- (void)objectsForKeys:(NSArray<NSString *> *)keys withBlock:(void(^)(NSDictionary<NSString *, id<NSCoding>> *objects))block {
+    if (!block) return;
+    __weak typeof(self) _self = self;
+    dispatch_async(_queue, ^{
+        __strong typeof(_self) self = _self;
+        NSDictionary *objects = [self objectsForKeys:keys];
+        block(objects ? objects : @{});
+    });
+}
+
 - (void)objectForKey:(NSString *)key withBlock:(void(^)(NSString *key, id<NSCoding> object))block {
     if (!block) return;
     __weak typeof(self) _self = self;
@@ -263,36 +476,46 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     });
 }
 
+- (void)objectForKey:(NSString *)key withRefreshBlock:(void(^)(NSString *key, id<NSCoding> object, BOOL needsRefresh))block {
+    if (!block) return;
+    __weak typeof(self) _self = self;
+    dispatch_async(_queue, ^{
+        __strong typeof(_self) self = _self;
+        BOOL needsRefresh = NO;
+        id<NSCoding> object = [self objectForKey:key needsRefresh:&needsRefresh];
+        block(key, object, needsRefresh);
+    });
+}
+
 - (void)setObject:(id<NSCoding>)object forKey:(NSString *)key {
+    [self setObject:object forKey:key softTTL:0 hardTTL:0];
+}
+
+- (void)setObject:(id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL {
     if (!key) return;
     if (!object) {
         [self removeObjectForKey:key];
         return;
     }
     
+    YYCacheMetricsBegin(start);
     NSData *extendedData = [YYDiskCache getExtendedDataFromObject:object];
-    NSData *value = nil;
-    if (_customArchiveBlock) {
-        value = _customArchiveBlock(object);
-    } else {
-        @try {
-            value = [NSKeyedArchiver archivedDataWithRootObject:object];
-        }
-        @catch (NSException *exception) {
-            // nothing to do...
-        }
-    }
+    NSData *value = [self _dataFromObject:object];
     if (!value) return;
-    NSString *filename = nil;
-    if (_kv.type != YYKVStorageTypeSQLite) {
-        if (value.length > _inlineThreshold) {
-            filename = [self _filenameForKey:key];
-        }
-    }
+    NSString *filename = [self _filenameForKey:key valueLength:value.length];
     
-    Lock();
-    [_kv saveItemWithKey:key value:value filename:filename extendedData:extendedData];
+    int softExpireTime = _YYDiskCacheExpireTime(softTTL);
+    int hardExpireTime = _YYDiskCacheExpireTime(hardTTL);
+    Lock(Set);
+    if ([_kv saveItemWithKey:key value:value filename:filename extendedData:extendedData softExpireTime:softExpireTime hardExpireTime:hardExpireTime]) {
+        [self _estimateWrittenCost:value.length count:1];
+    }
     Unlock();
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        [recorder recordOperation:YYCacheTraceOperationSet tier:YYCacheTraceTierDisk key:key size:value.length result:YYCacheTraceResultNone];
+    }
+    YYCacheMetricsEnd(YYCacheMetricDiskSet, start);
 }
 
 - (void)setObject:(id<NSCoding>)object forKey:(NSString *)key withBlock:(void(^)(void))block {
@@ -304,11 +527,61 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     });
 }
 
+- (void)setObject:(id<NSCoding>)object forKey:(NSString *)key softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL withBlock:(void(^)(void))block {
+    __weak typeof(self) _self = self;
+    dispatch_async(_queue, ^{
+        __strong typeof(_self) self = _self;
+        [self setObject:object forKey:key softTTL:softTTL hardTTL:hardTTL];
+        if (block) block();
+    });
+}
+
+- (void)setObjects:(NSArray<id<NSCoding>> *)objects forKeys:(NSArray<NSString *> *)keys {
+    [self setObjects:objects forKeys:keys softTTLs:nil hardTTLs:nil];
+}
+
+- (void)setObjects:(NSArray<id<NSCoding>> *)objects forKeys:(NSArray<NSString *> *)keys softTTLs:(NSArray<NSNumber *> *)softTTLs hardTTLs:(NSArray<NSNumber *> *)hardTTLs {
+    if (objects.count == 0 || objects.count != keys.count) return;
+    if ((softTTLs && softTTLs.count != objects.count) || (hardTTLs && hardTTLs.count != objects.count)) return;
+    NSMutableArray *items = [NSMutableArray new];
+    for (NSUInteger i = 0, max = objects.count; i < max; i++) {
+        @autoreleasepool {
+            id<NSCoding> object = objects[i];
+            NSData *value = [self _dataFromObject:object];
+            if (!value) continue;
+            YYKVStorageItem *item = [YYKVStorageItem new];
+            item.key = keys[i];
+            item.value = value;
+            item.extendedData = [YYDiskCache getExtendedDataFromObject:object];
+            item.filename = [self _filenameForKey:item.key valueLength:value.length];
+            item.softExpireTime = softTTLs ? _YYDiskCacheExpireTime(softTTLs[i].doubleValue) : 0;
+            item.hardExpireTime = hardTTLs ? _YYDiskCacheExpireTime(hardTTLs[i].doubleValue) : 0;
+            [items addObject:item];
+        }
+    }
+    if (items.count == 0) return;
+    NSUInteger cost = 0;
+    for (YYKVStorageItem *item in items) cost += item.value.length;
+    Lock(Set);
+    if ([_kv saveItems:items]) [self _estimateWrittenCost:cost count:items.count];
+    Unlock();
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        for (YYKVStorageItem *item in items) {
+            [recorder recordOperation:YYCacheTraceOperationSet tier:YYCacheTraceTierDisk key:item.key size:item.value.length result:YYCacheTraceResultNone];
+        }
+    }
+}
+
 - (void)removeObjectForKey:(NSString *)key {
     if (!key) return;
-    Lock();
+    Lock(Remove);
     [_kv removeItemForKey:key];
     Unlock();
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        [recorder recordOperation:YYCacheTraceOperationRemove tier:YYCacheTraceTierDisk key:key size:0 result:YYCacheTraceResultNone];
+    }
 }
 
 - (void)removeObjectForKey:(NSString *)key withBlock:(void(^)(NSString *key))block {
@@ -321,7 +594,7 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 }
 
 - (void)removeAllObjects {
-    Lock();
+    Lock(Remove);
     [_kv removeAllItems];
     Unlock();
 }
@@ -344,14 +617,14 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
             if (end) end(YES);
             return;
         }
-        Lock();
+        Lock(Remove);
         [_kv removeAllItemsWithProgressBlock:progress endBlock:end];
         Unlock();
     });
 }
 
 - (NSInteger)totalCount {
-    Lock();
+    Lock(Other);
     int count = [_kv getItemsCount];
     Unlock();
     return count;
@@ -368,7 +641,7 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 }
 
 - (NSInteger)totalCost {
-    Lock();
+    Lock(Other);
     int count = [_kv getItemsSize];
     Unlock();
     return count;
@@ -385,7 +658,7 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 }
 
 - (void)trimToCount:(NSUInteger)count {
-    Lock();
+    Lock(Trim);
     [self _trimToCount:count];
     Unlock();
 }
@@ -400,7 +673,7 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 }
 
 - (void)trimToCost:(NSUInteger)cost {
-    Lock();
+    Lock(Trim);
     [self _trimToCost:cost];
     Unlock();
 }
@@ -415,7 +688,7 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 }
 
 - (void)trimToAge:(NSTimeInterval)age {
-    Lock();
+    Lock(Trim);
     [self _trimToAge:age];
     Unlock();
 }
@@ -429,6 +702,165 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     });
 }
 
+- (void)removeObjectsWithKeyPrefix:(NSString *)prefix {
+    Lock(Remove);
+    [_kv removeItemsWithKeyPrefix:prefix];
+    Unlock();
+}
+
+- (void)removeObjectsWithKeyPrefix:(NSString *)prefix withBlock:(void(^)(void))block {
+    __weak typeof(self) _self = self;
+    dispatch_async(_queue, ^{
+        __strong typeof(_self) self = _self;
+        [self removeObjectsWithKeyPrefix:prefix];
+        if (block) block();
+    });
+}
+
+- (NSInteger)totalCountWithKeyPrefix:(NSString *)prefix {
+    Lock(Other);
+    int count = [_kv getItemsCountWithKeyPrefix:prefix];
+    Unlock();
+    return count;
+}
+
+- (NSInteger)totalCostWithKeyPrefix:(NSString *)prefix {
+    Lock(Other);
+    int cost = [_kv getItemsSizeWithKeyPrefix:prefix];
+    Unlock();
+    return cost;
+}
+
+- (void)trimToCount:(NSUInteger)count withKeyPrefix:(NSString *)prefix {
+    if (count >= INT_MAX) return;
+    Lock(Trim);
+    [_kv removeItemsWithKeyPrefix:prefix toFitCount:(int)count];
+    Unlock();
+}
+
+- (void)trimToCost:(NSUInteger)cost withKeyPrefix:(NSString *)prefix {
+    if (cost >= INT_MAX) return;
+    Lock(Trim);
+    [_kv removeItemsWithKeyPrefix:prefix toFitSize:(int)cost];
+    Unlock();
+}
+
+- (BOOL)exportToArchiveAtPath:(NSString *)path {
+    if (path.length == 0) return NO;
+    NSString *tmpPath = [path stringByAppendingString:@".tmp"];
+    FILE *file = fopen(tmpPath.fileSystemRepresentation, "wb");
+    if (!file) return NO;
+    
+    BOOL suc = fwrite(kArchiveMagic, 1, 4, file) == 4 && _YYDiskArchiveWriteUInt32(file, kArchiveVersion);
+    NSString *lastKey = nil;
+    while (suc) {
+        @autoreleasepool {
+            Lock(Other);
+            NSArray *items = [_kv getItemsAfterKey:lastKey limit:kArchivePageCount];
+            Unlock();
+            if (items.count == 0) break;
+            for (YYKVStorageItem *item in items) {
+                NSData *key = [item.key dataUsingEncoding:NSUTF8StringEncoding];
+                if (key.length == 0 || item.value.length == 0) continue;
+                suc = _YYDiskArchiveWriteData(file, key) &&
+                      _YYDiskArchiveWriteData(file, item.value) &&
+                      _YYDiskArchiveWriteData(file, item.extendedData) &&
+                      _YYDiskArchiveWriteUInt32(file, (uint32_t)item.softExpireTime) &&
+                      _YYDiskArchiveWriteUInt32(file, (uint32_t)item.hardExpireTime);
+                if (!suc) break;
+            }
+            lastKey = ((YYKVStorageItem *)items.lastObject).key;
+        }
+    }
+    if (suc) suc = _YYDiskArchiveWriteUInt32(file, 0);
+    if (fclose(file) != 0) suc = NO;
+    if (suc) {
+        suc = rename(tmpPath.fileSystemRepresentation, path.fileSystemRepresentation) == 0;
+    }
+    if (!suc) [[NSFileManager defaultManager] removeItemAtPath:tmpPath error:NULL];
+    return suc;
+}
+
+- (void)exportToArchiveAtPath:(NSString *)path withBlock:(void(^)(BOOL succeed))block {
+    __weak typeof(self) _self = self;
+    dispatch_async(_queue, ^{
+        __strong typeof(_self) self = _self;
+        BOOL succeed = [self exportToArchiveAtPath:path];
+        if (block) block(succeed);
+    });
+}
+
+- (NSInteger)importFromArchiveAtPath:(NSString *)path {
+    if (path.length == 0) return -1;
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:NULL];
+    if (data.length < 8 || memcmp(data.bytes, kArchiveMagic, 4) != 0) return -1;
+    const uint8_t *bytes = data.bytes;
+    const uint8_t *end = bytes + data.length;
+    const uint8_t *p = bytes + 4;
+    uint32_t version = 0;
+    if (!_YYDiskArchiveReadUInt32(&p, end, &version) || version != kArchiveVersion) return -1;
+    
+    int now = (int)time(NULL);
+    NSInteger importedCount = 0;
+    BOOL suc = YES, finished = NO;
+    while (suc && !finished) {
+        @autoreleasepool {
+            NSMutableArray *batch = [NSMutableArray new];
+            NSUInteger batchSize = 0;
+            while (batch.count < kArchiveBatchCount && batchSize < kArchiveBatchSize) {
+                uint32_t keyLength, valueLength, extendedDataLength, softExpireTime, hardExpireTime;
+                if (!_YYDiskArchiveReadUInt32(&p, end, &keyLength)) { suc = NO; break; }
+                if (keyLength == 0) { finished = YES; break; }
+                if ((size_t)(end - p) < keyLength) { suc = NO; break; }
+                NSString *key = [[NSString alloc] initWithBytes:p length:keyLength encoding:NSUTF8StringEncoding];
+                p += keyLength;
+                if (!_YYDiskArchiveReadUInt32(&p, end, &valueLength) || (size_t)(end - p) < valueLength) { suc = NO; break; }
+                NSData *value = [data subdataWithRange:NSMakeRange(p - bytes, valueLength)];
+                p += valueLength;
+                if (!_YYDiskArchiveReadUInt32(&p, end, &extendedDataLength) || (size_t)(end - p) < extendedDataLength) { suc = NO; break; }
+                NSData *extendedData = extendedDataLength ? [data subdataWithRange:NSMakeRange(p - bytes, extendedDataLength)] : nil;
+                p += extendedDataLength;
+                if (!_YYDiskArchiveReadUInt32(&p, end, &softExpireTime) ||
+                    !_YYDiskArchiveReadUInt32(&p, end, &hardExpireTime)) { suc = NO; break; }
+                
+                if (!key || valueLength == 0) continue;
+                if ((int)hardExpireTime > 0 && (int)hardExpireTime <= now) continue;
+                YYKVStorageItem *item = [YYKVStorageItem new];
+                item.key = key;
+                item.value = value;
+                item.extendedData = extendedData;
+                item.softExpireTime = (int)softExpireTime;
+                item.hardExpireTime = (int)hardExpireTime;
+                item.filename = [self _filenameForKey:key valueLength:valueLength];
+                [batch addObject:item];
+                batchSize += valueLength;
+            }
+            if (suc && batch.count) {
+                Lock(Other);
+                BOOL saved = [_kv saveItems:batch];
+                if (saved) [self _estimateWrittenCost:batchSize count:batch.count];
+                Unlock();
+                if (saved) {
+                    importedCount += batch.count;
+                } else {
+                    suc = NO;
+                }
+            }
+        }
+    }
+    if (importedCount > 0) [self _trimInBackground];
+    return suc ? importedCount : -1;
+}
+
+- (void)importFromArchiveAtPath:(NSString *)path withBlock:(void(^)(NSInteger importedCount))block {
+    __weak typeof(self) _self = self;
+    dispatch_async(_queue, ^{
+        __strong typeof(_self) self = _self;
+        NSInteger importedCount = [self importFromArchiveAtPath:path];
+        if (block) block(importedCount);
+    });
+}
+
 + (NSData *)getExtendedDataFromObject:(id)object {
     if (!object) return nil;
     return (NSData *)objc_getAssociatedObject(object, &extended_data_key);
@@ -445,16 +877,55 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
 }
 
 - (BOOL)errorLogsEnabled {
-    Lock();
+    Lock(Other);
     BOOL enabled = _kv.errorLogsEnabled;
     Unlock();
     return enabled;
 }
 
 - (void)setErrorLogsEnabled:(BOOL)errorLogsEnabled {
-    Lock();
+    Lock(Other);
     _kv.errorLogsEnabled = errorLogsEnabled;
     Unlock();
 }
 
+- (NSTimeInterval)autoTrimInterval {
+    return atomic_load(&_autoTrimInterval);
+}
+
+- (void)setAutoTrimInterval:(NSTimeInterval)autoTrimInterval {
+    atomic_store(&_autoTrimInterval, autoTrimInterval);
+    [[YYCacheTrimScheduler sharedScheduler] rescheduleCache:self];
+}
+
+- (BOOL)lockProfilingEnabled {
+    return YYCacheLockProfileIsEnabled(&_lockProfile);
+}
+
+- (void)setLockProfilingEnabled:(BOOL)lockProfilingEnabled {
+    dispatch_semaphore_wait(_lock, DISPATCH_TIME_FOREVER);
+    YYCacheLockProfileSetEnabled(&_lockProfile, lockProfilingEnabled);
+    dispatch_semaphore_signal(_lock);
+}
+
+- (YYCacheLockStats *)lockStats {
+    dispatch_semaphore_wait(_lock, DISPATCH_TIME_FOREVER);
+    YYCacheLockStats *stats = [[YYCacheLockStats alloc] initWithProfile:&_lockProfile];
+    dispatch_semaphore_signal(_lock);
+    return stats;
+}
+
+- (YYKVStorageEvictionPolicy)evictionPolicy {
+    Lock(Other);
+    YYKVStorageEvictionPolicy policy = _kv.evictionPolicy;
+    Unlock();
+    return policy;
+}
+
+- (void)setEvictionPolicy:(YYKVStorageEvictionPolicy)evictionPolicy {
+    Lock(Other);
+    _kv.evictionPolicy = evictionPolicy;
+    Unlock();
+}
+
 @end
@@ -24,6 +24,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic) int size;                             ///< value's size in bytes
 @property (nonatomic) int modTime;                          ///< modification unix timestamp
 @property (nonatomic) int accessTime;                       ///< last access unix timestamp
+@property (nonatomic) int accessCount;                      ///< number of accesses (writes and reads)
+@property (nonatomic) int softExpireTime;                   ///< soft expiry unix timestamp (0 if never), the value is stale after it
+@property (nonatomic) int hardExpireTime;                   ///< hard expiry unix timestamp (0 if never), the item is removed after it
 @property (nullable, nonatomic, strong) NSData *extendedData; ///< extended data (nil if no extended data)
 @end
 
@@ -57,6 +60,28 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
     YYKVStorageTypeMixed = 2,
 };
 
+/**
+ Eviction policy, indicated which items are removed first when the storage is
+ trimmed to fit a size or count.
+ 
+ @discussion LRU only looks at the last access time, so a 5MB file and a 2KB item
+ are evicted with the same eagerness. GDSF (GreedyDual-Size-Frequency) gives each
+ item a priority `L + accessCount / size`, where `L` is the priority of the last
+ evicted item (it "ages" the items that are not accessed any more). Small and 
+ frequently accessed items are kept longer, which gets a higher object hit ratio
+ for the same disk budget.
+ 
+ The access count and priority are maintained for every item regardless of the
+ policy, so the policy can be changed at any time.
+ */
+typedef NS_ENUM(NSUInteger, YYKVStorageEvictionPolicy) {
+    /// The least recently used items are removed first.
+    YYKVStorageEvictionPolicyLRU = 0,
+    
+    /// The items with lowest GreedyDual-Size-Frequency priority are removed first.
+    YYKVStorageEvictionPolicyGDSF = 1,
+};
+
 
 
 /**
@@ -85,6 +110,14 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
 @property (nonatomic, readonly) NSString *path;        ///< The path of this storage.
 @property (nonatomic, readonly) YYKVStorageType type;  ///< The type of this storage.
 @property (nonatomic) BOOL errorLogsEnabled;           ///< Set `YES` to enable error logs for debug.
+@property (nonatomic) YYKVStorageEvictionPolicy evictionPolicy; ///< The eviction policy of `removeItemsToFit...`. Default is LRU.
+
+/**
+ The clock of the access time, modification time and expiration, in seconds since 1970.
+ Default is nil, which is `time(NULL)`. A trace replay may set a virtual clock (such as
+ one tick per access), so the LRU order is not limited by the one second resolution.
+ */
+@property (nullable, nonatomic, copy) int (^timeBlock)(void);
 
 #pragma mark - Initializer
 ///=============================================================================
@@ -106,6 +139,18 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  */
 - (nullable instancetype)initWithPath:(NSString *)path type:(YYKVStorageType)type NS_DESIGNATED_INITIALIZER;
 
+/**
+ Sets a pragma of the sqlite connection, to tune the storage for a platform, such as
+ `journal_mode` ("wal" or "delete"), `synchronous` ("off", "normal" or "full") or
+ `mmap_size` (bytes). The defaults are "wal", "normal" and no mmap. The pragma is
+ set again if the db is reopened.
+ 
+ @param name  The name of the pragma, lowercase letters and '_'.
+ @param value The value, letters, digits, '_' and '-'.
+ @return Whether succeed.
+ */
+- (BOOL)setPragma:(NSString *)name value:(NSString *)value;
+
 
 #pragma mark - Save Items
 ///=============================================================================
@@ -115,8 +160,9 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
 /**
  Save an item or update the item with 'key' if it already exists.
  
- @discussion This method will save the item.key, item.value, item.filename and
- item.extendedData to disk or sqlite, other properties will be ignored. item.key 
+ @discussion This method will save the item.key, item.value, item.filename,
+ item.extendedData, item.softExpireTime and item.hardExpireTime to disk or sqlite,
+ other properties will be ignored. item.key 
  and item.value should not be empty (nil or zero length).
  
  If the `type` is YYKVStorageTypeFile, then the item.filename should not be empty.
@@ -162,6 +208,45 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
                filename:(nullable NSString *)filename
            extendedData:(nullable NSData *)extendedData;
 
+/**
+ Save an item or update the item with 'key' if it already exists.
+ 
+ @discussion See `saveItemWithKey:value:filename:extendedData:` for the storage 
+ type. The item is stale after the soft expire time (it can still be read, see
+ `YYKVStorageItem.softExpireTime`), and is treated as not exists after the hard
+ expire time, it will be removed by `removeItemsExpiredEarlierThanTime:`.
+ 
+ @param key             The key, should not be empty (nil or zero length).
+ @param value           The key, should not be empty (nil or zero length).
+ @param filename        The filename.
+ @param extendedData    The extended data for this item (pass nil to ignore it).
+ @param softExpireTime  The soft expiry unix timestamp, 0 means never.
+ @param hardExpireTime  The hard expiry unix timestamp, 0 means never.
+ 
+ @return Whether succeed.
+ */
+- (BOOL)saveItemWithKey:(NSString *)key
+                  value:(NSData *)value
+               filename:(nullable NSString *)filename
+           extendedData:(nullable NSData *)extendedData
+         softExpireTime:(int)softExpireTime
+         hardExpireTime:(int)hardExpireTime;
+
+/**
+ Save items or update the items which already exist, in one transaction.
+ 
+ @discussion It's much faster than calling `saveItem:` for each item, because the
+ sqlite only commits (and syncs) once. The rules of each item is same as `saveItem:`,
+ and the last item wins if a key appears more than once.
+ If any item can not be saved, the transaction is rolled back and the files written
+ are deleted, so nothing is saved.
+ 
+ @param items  An array of items.
+ @return Whether all items are saved. NO means none of them is saved, except in the
+ rare case a file can not be moved in place after the commit, when only that item is removed.
+ */
+- (BOOL)saveItems:(NSArray<YYKVStorageItem *> *)items;
+
 #pragma mark - Remove Items
 ///=============================================================================
 /// @name Remove Items
@@ -200,9 +285,18 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  */
 - (BOOL)removeItemsEarlierThanTime:(int)time;
 
+/**
+ Remove all items which hard expire time is earlier than a specified timestamp.
+ The items without hard expire time will not be removed.
+ 
+ @param time  The specified unix timestamp.
+ @return Whether succeed.
+ */
+- (BOOL)removeItemsExpiredEarlierThanTime:(int)time;
+
 /**
  Remove items to make the total size not larger than a specified size.
- The least recently used (LRU) items will be removed first.
+ The items will be removed in the order of `evictionPolicy`.
  
  @param maxSize The specified size in bytes.
  @return Whether succeed.
@@ -211,13 +305,43 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
 
 /**
  Remove items to make the total count not larger than a specified count.
- The least recently used (LRU) items will be removed first.
+ The items will be removed in the order of `evictionPolicy`.
  
  @param maxCount The specified item count.
  @return Whether succeed.
  */
 - (BOOL)removeItemsToFitCount:(int)maxCount;
 
+/**
+ Remove all items which key has a specified prefix.
+ 
+ @param prefix The key prefix, the last character should not be 0xFFFF.
+ @return Whether succeed.
+ */
+- (BOOL)removeItemsWithKeyPrefix:(NSString *)prefix;
+
+/**
+ Remove items which key has a specified prefix, to make the total size of these
+ items not larger than a specified size. The items will be removed in the order 
+ of `evictionPolicy`.
+ 
+ @param prefix  The key prefix, the last character should not be 0xFFFF.
+ @param maxSize The specified size in bytes.
+ @return Whether succeed.
+ */
+- (BOOL)removeItemsWithKeyPrefix:(NSString *)prefix toFitSize:(int)maxSize;
+
+/**
+ Remove items which key has a specified prefix, to make the count of these items
+ not larger than a specified count. The items will be removed in the order of 
+ `evictionPolicy`.
+ 
+ @param prefix   The key prefix, the last character should not be 0xFFFF.
+ @param maxCount The specified item count.
+ @return Whether succeed.
+ */
+- (BOOL)removeItemsWithKeyPrefix:(NSString *)prefix toFitCount:(int)maxCount;
+
 /**
  Remove all items in background queue.
  
@@ -249,7 +373,7 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  Get item with a specified key.
  
  @param key A specified key.
- @return Item for the key, or nil if not exists / error occurs.
+ @return Item for the key, or nil if not exists / hard expired / error occurs.
  */
 - (nullable YYKVStorageItem *)getItemForKey:(NSString *)key;
 
@@ -258,7 +382,7 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  The `value` in this item will be ignored.
  
  @param key A specified key.
- @return Item information for the key, or nil if not exists / error occurs.
+ @return Item information for the key, or nil if not exists / hard expired / error occurs.
  */
 - (nullable YYKVStorageItem *)getItemInfoForKey:(NSString *)key;
 
@@ -266,12 +390,13 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  Get item value with a specified key.
  
  @param key  A specified key.
- @return Item's value, or nil if not exists / error occurs.
+ @return Item's value, or nil if not exists / hard expired / error occurs.
  */
 - (nullable NSData *)getItemValueForKey:(NSString *)key;
 
 /**
  Get items with an array of keys.
+ The hard expired items will not be returned.
  
  @param keys  An array of specified keys.
  @return An array of `YYKVStorageItem`, or nil if not exists / error occurs.
@@ -280,7 +405,7 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
 
 /**
  Get item infomartions with an array of keys.
- The `value` in items will be ignored.
+ The `value` in items will be ignored, the hard expired items will not be returned.
  
  @param keys  An array of specified keys.
  @return An array of `YYKVStorageItem`, or nil if not exists / error occurs.
@@ -289,6 +414,7 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
 
 /**
  Get items value with an array of keys.
+ The hard expired items will not be returned.
  
  @param keys  An array of specified keys.
  @return A dictionary which key is 'key' and value is 'value', or nil if not 
@@ -296,6 +422,18 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  */
 - (nullable NSDictionary<NSString *, NSData *> *)getItemValueForKeys:(NSArray<NSString *> *)keys;
 
+/**
+ Get items in the order of key, used to enumerate the whole storage page by page.
+ The hard expired items will not be returned, and the access time is not updated.
+ 
+ @param key    The items after this key will be returned, pass nil to get the 
+    first page.
+ @param limit  The max count of the items.
+ @return An array of `YYKVStorageItem`, or nil if there's no more items / error occurs.
+    The next page starts after the key of the last item.
+ */
+- (nullable NSArray<YYKVStorageItem *> *)getItemsAfterKey:(nullable NSString *)key limit:(int)limit;
+
 #pragma mark - Get Storage Status
 ///=============================================================================
 /// @name Get Storage Status
@@ -306,7 +444,7 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  
  @param key  A specified key.
  
- @return `YES` if there's an item exists for the key, `NO` if not exists or an error occurs.
+ @return `YES` if there's an item exists for the key, `NO` if not exists, hard expired or an error occurs.
  */
 - (BOOL)itemExistsForKey:(NSString *)key;
 
@@ -322,6 +460,18 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  */
 - (int)getItemsSize;
 
+/**
+ Get the count of items which key has a specified prefix.
+ @return Item count, -1 when an error occurs.
+ */
+- (int)getItemsCountWithKeyPrefix:(NSString *)prefix;
+
+/**
+ Get the total value size of items which key has a specified prefix.
+ @return Total size in bytes, -1 when an error occurs.
+ */
+- (int)getItemsSizeWithKeyPrefix:(NSString *)prefix;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -10,8 +10,13 @@
 //
 
 #import "YYKVStorage.h"
-#import <UIKit/UIKit.h>
+#import "YYCacheMetricsPrivate.h"
+#import "YYCacheLockProfilePrivate.h"
+#import "YYCacheMediaTime.h"
 #import <time.h>
+#if __has_include(<UIKit/UIKit.h>)
+#import <UIKit/UIKit.h>
+#endif
 
 #if __has_include(<sqlite3.h>)
 #import <sqlite3.h>
@@ -51,11 +56,20 @@ static NSString *const kTrashDirectoryName = @"trash";
     modification_time   integer,
     last_access_time    integer,
     extended_data       blob,
+    access_count        integer,
+    priority            real,
+    soft_expire_time    integer,
+    hard_expire_time    integer,
     primary key(key)
  ); 
  create index if not exists last_access_time_idx on manifest(last_access_time);
+ create index if not exists priority_idx on manifest(priority);
+ create index if not exists hard_expire_time_idx on manifest(hard_expire_time);
+ 
+ `access_count` and `priority` are used by GDSF eviction, priority = L + access_count / size.
  */
 
+#if __has_include(<UIKit/UIKit.h>)
 /// Returns nil in App Extension.
 static UIApplication *_YYSharedApplication() {
     static BOOL isAppExtension = NO;
@@ -70,7 +84,12 @@ static UIApplication *_YYSharedApplication() {
     return isAppExtension ? nil : [UIApplication performSelector:@selector(sharedApplication)];
 #pragma clang diagnostic pop
 }
+#endif
+
 
+@interface YYKVStorageItem ()
+@property (nonatomic) double priority; ///< GDSF priority, only used by eviction
+@end
 
 @implementation YYKVStorageItem
 @end
@@ -87,11 +106,18 @@ static UIApplication *_YYSharedApplication() {
     CFMutableDictionaryRef _dbStmtCache;//使用预处理stmt对数据库进行优化,避免不必要的开销
     NSTimeInterval _dbLastOpenErrorTime;//上次打开数据库错误的时间
     NSUInteger _dbOpenErrorCount;//打开数据库错误的次数
+    double _dbInflation; // GDSF inflation value `L`, the priority of the last evicted item
+    NSMutableDictionary<NSString *, NSString *> *_dbPragmas; // set by `setPragma:value:`, applied again when the db is reopened
 }
 
 
 #pragma mark - db
 
+/// Seconds since 1970, or the time of `timeBlock`.
+- (int)_now {
+    return _timeBlock ? _timeBlock() : (int)time(NULL);
+}
+
 - (BOOL)_dbOpen {
     if (_db) return YES;
     
@@ -162,14 +188,54 @@ static UIApplication *_YYSharedApplication() {
 }
 
 - (BOOL)_dbInitialize {
-    NSString *sql = @"pragma journal_mode = wal; pragma synchronous = normal; create table if not exists manifest (key text, filename text, size integer, inline_data blob, modification_time integer, last_access_time integer, extended_data blob, primary key(key)); create index if not exists last_access_time_idx on manifest(last_access_time);";
-    return [self _dbExecute:sql];
+    NSString *sql = @"pragma journal_mode = wal; pragma synchronous = normal; create table if not exists manifest (key text, filename text, size integer, inline_data blob, modification_time integer, last_access_time integer, extended_data blob, access_count integer, priority real, soft_expire_time integer, hard_expire_time integer, primary key(key)); create index if not exists last_access_time_idx on manifest(last_access_time);";
+    if (![self _dbExecute:sql]) return NO;
+    if (![self _dbUpgrade]) return NO;
+    if (![self _dbExecute:@"create index if not exists priority_idx on manifest(priority); create index if not exists hard_expire_time_idx on manifest(hard_expire_time);"]) return NO;
+    for (NSString *name in _dbPragmas) {
+        if (![self _dbExecute:[NSString stringWithFormat:@"pragma %@ = %@;", name, _dbPragmas[name]]]) return NO;
+    }
+    _dbInflation = [self _dbGetMinPriority];
+    return YES;
+}
+
+/// Add the columns which do not exist in the manifest created by an older version.
+- (BOOL)_dbUpgrade {
+    sqlite3_stmt *stmt = NULL;
+    int result = sqlite3_prepare_v2(_db, "pragma table_info(manifest);", -1, &stmt, NULL);
+    if (result != SQLITE_OK) {
+        if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite stmt prepare error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+        return NO;
+    }
+    NSMutableSet *columns = [NSMutableSet new];
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        char *name = (char *)sqlite3_column_text(stmt, 1);
+        if (name) [columns addObject:[NSString stringWithUTF8String:name]];
+    }
+    sqlite3_finalize(stmt);
+    
+    NSDictionary *required = @{@"access_count" : @"integer default 0",
+                               @"priority" : @"real default 0",
+                               @"soft_expire_time" : @"integer default 0",
+                               @"hard_expire_time" : @"integer default 0"};
+    for (NSString *column in required) {
+        if ([columns containsObject:column]) continue;
+        NSString *sql = [NSString stringWithFormat:@"alter table manifest add column %@ %@;", column, required[column]];
+        if (![self _dbExecute:sql]) return NO;
+    }
+    return YES;
 }
 
 - (void)_dbCheckpoint {
     if (![self _dbCheck]) return;
     // Cause a checkpoint to occur, merge `sqlite-wal` file to `sqlite` file.
-    sqlite3_wal_checkpoint(_db, NULL);
+    if (_lockProfile) {
+        YYCacheLockOperation operation = YYCacheLockProfileSwitchOperation(_lockProfile, YYCacheLockOperationCheckpoint);
+        sqlite3_wal_checkpoint(_db, NULL);
+        YYCacheLockProfileSwitchOperation(_lockProfile, operation);
+    } else {
+        sqlite3_wal_checkpoint(_db, NULL);
+    }
 }
 
 - (BOOL)_dbExecute:(NSString *)sql {
@@ -220,12 +286,13 @@ static UIApplication *_YYSharedApplication() {
     }
 }
 
-- (BOOL)_dbSaveWithKey:(NSString *)key value:(NSData *)value fileName:(NSString *)fileName extendedData:(NSData *)extendedData {
-    NSString *sql = @"insert or replace into manifest (key, filename, size, inline_data, modification_time, last_access_time, extended_data) values (?1, ?2, ?3, ?4, ?5, ?6, ?7);";
+- (BOOL)_dbSaveWithKey:(NSString *)key value:(NSData *)value fileName:(NSString *)fileName extendedData:(NSData *)extendedData softExpireTime:(int)softExpireTime hardExpireTime:(int)hardExpireTime {
+    // keep the access count of the replaced item, the key is as popular as before
+    NSString *sql = @"insert or replace into manifest (key, filename, size, inline_data, modification_time, last_access_time, extended_data, access_count, priority, soft_expire_time, hard_expire_time) values (?1, ?2, ?3, ?4, ?5, ?6, ?7, coalesce((select access_count from manifest where key = ?1), 0) + 1, ?8 + (coalesce((select access_count from manifest where key = ?1), 0) + 1) * 1.0 / max(?3, 1), ?9, ?10);";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
     if (!stmt) return NO;
     
-    int timestamp = (int)time(NULL);
+    int timestamp = [self _now];
     sqlite3_bind_text(stmt, 1, key.UTF8String, -1, NULL);
     sqlite3_bind_text(stmt, 2, fileName.UTF8String, -1, NULL);
     sqlite3_bind_int(stmt, 3, (int)value.length);
@@ -237,8 +304,12 @@ static UIApplication *_YYSharedApplication() {
     sqlite3_bind_int(stmt, 5, timestamp);
     sqlite3_bind_int(stmt, 6, timestamp);
     sqlite3_bind_blob(stmt, 7, extendedData.bytes, (int)extendedData.length, 0);
+    sqlite3_bind_double(stmt, 8, _dbInflation);
+    sqlite3_bind_int(stmt, 9, softExpireTime);
+    sqlite3_bind_int(stmt, 10, hardExpireTime);
     
-    int result = sqlite3_step(stmt);
+    int result;
+    YYCacheMetricsMeasure(YYCacheMetricStorageSQLiteWrite, result = sqlite3_step(stmt));
     if (result != SQLITE_DONE) {
         if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite insert error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
         return NO;
@@ -247,12 +318,14 @@ static UIApplication *_YYSharedApplication() {
 }
 
 - (BOOL)_dbUpdateAccessTimeWithKey:(NSString *)key {
-    NSString *sql = @"update manifest set last_access_time = ?1 where key = ?2;";
+    NSString *sql = @"update manifest set last_access_time = ?1, access_count = access_count + 1, priority = ?3 + (access_count + 1) * 1.0 / max(size, 1) where key = ?2;";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
     if (!stmt) return NO;
-    sqlite3_bind_int(stmt, 1, (int)time(NULL));
+    sqlite3_bind_int(stmt, 1, [self _now]);
     sqlite3_bind_text(stmt, 2, key.UTF8String, -1, NULL);
-    int result = sqlite3_step(stmt);
+    sqlite3_bind_double(stmt, 3, _dbInflation);
+    int result;
+    YYCacheMetricsMeasure(YYCacheMetricStorageSQLiteWrite, result = sqlite3_step(stmt));
     if (result != SQLITE_DONE) {
         if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite update error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
         return NO;
@@ -262,8 +335,8 @@ static UIApplication *_YYSharedApplication() {
 
 - (BOOL)_dbUpdateAccessTimeWithKeys:(NSArray *)keys {
     if (![self _dbCheck]) return NO;
-    int t = (int)time(NULL);
-     NSString *sql = [NSString stringWithFormat:@"update manifest set last_access_time = %d where key in (%@);", t, [self _dbJoinedKeys:keys]];
+    int t = [self _now];
+    NSString *sql = [NSString stringWithFormat:@"update manifest set last_access_time = %d, access_count = access_count + 1, priority = %.17g + (access_count + 1) * 1.0 / max(size, 1) where key in (%@);", t, _dbInflation, [self _dbJoinedKeys:keys]];
     
     sqlite3_stmt *stmt = NULL;
     int result = sqlite3_prepare_v2(_db, sql.UTF8String, -1, &stmt, NULL);
@@ -329,6 +402,19 @@ static UIApplication *_YYSharedApplication() {
     return YES;
 }
 
+- (BOOL)_dbDeleteItemsWithExpireTimeEarlierThan:(int)time {
+    NSString *sql = @"delete from manifest where hard_expire_time > 0 and hard_expire_time <= ?1;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return NO;
+    sqlite3_bind_int(stmt, 1, time);
+    int result = sqlite3_step(stmt);
+    if (result != SQLITE_DONE) {
+        if (_errorLogsEnabled)  NSLog(@"%s line:%d sqlite delete error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+        return NO;
+    }
+    return YES;
+}
+
 - (BOOL)_dbDeleteItemsWithTimeEarlierThan:(int)time {
     NSString *sql = @"delete from manifest where last_access_time < ?1;";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
@@ -353,6 +439,9 @@ static UIApplication *_YYSharedApplication() {
     int last_access_time = sqlite3_column_int(stmt, i++);
     const void *extended_data = sqlite3_column_blob(stmt, i);
     int extended_data_bytes = sqlite3_column_bytes(stmt, i++);
+    int access_count = sqlite3_column_int(stmt, i++);
+    int soft_expire_time = sqlite3_column_int(stmt, i++);
+    int hard_expire_time = sqlite3_column_int(stmt, i++);
     
     YYKVStorageItem *item = [YYKVStorageItem new];
     if (key) item.key = [NSString stringWithUTF8String:key];
@@ -362,17 +451,21 @@ static UIApplication *_YYSharedApplication() {
     item.modTime = modification_time;
     item.accessTime = last_access_time;
     if (extended_data_bytes > 0 && extended_data) item.extendedData = [NSData dataWithBytes:extended_data length:extended_data_bytes];
+    item.accessCount = access_count;
+    item.softExpireTime = soft_expire_time;
+    item.hardExpireTime = hard_expire_time;
     return item;
 }
 
 - (YYKVStorageItem *)_dbGetItemWithKey:(NSString *)key excludeInlineData:(BOOL)excludeInlineData {
-    NSString *sql = excludeInlineData ? @"select key, filename, size, modification_time, last_access_time, extended_data from manifest where key = ?1;" : @"select key, filename, size, inline_data, modification_time, last_access_time, extended_data from manifest where key = ?1;";
+    NSString *sql = excludeInlineData ? @"select key, filename, size, modification_time, last_access_time, extended_data, access_count, soft_expire_time, hard_expire_time from manifest where key = ?1;" : @"select key, filename, size, inline_data, modification_time, last_access_time, extended_data, access_count, soft_expire_time, hard_expire_time from manifest where key = ?1;";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
     if (!stmt) return nil;
     sqlite3_bind_text(stmt, 1, key.UTF8String, -1, NULL);
     
     YYKVStorageItem *item = nil;
-    int result = sqlite3_step(stmt);
+    int result;
+    YYCacheMetricsMeasure(YYCacheMetricStorageSQLiteRead, result = sqlite3_step(stmt));
     if (result == SQLITE_ROW) {
         item = [self _dbGetItemFromStmt:stmt excludeInlineData:excludeInlineData];
     } else {
@@ -387,9 +480,9 @@ static UIApplication *_YYSharedApplication() {
     if (![self _dbCheck]) return nil;
     NSString *sql;
     if (excludeInlineData) {
-        sql = [NSString stringWithFormat:@"select key, filename, size, modification_time, last_access_time, extended_data from manifest where key in (%@);", [self _dbJoinedKeys:keys]];
+        sql = [NSString stringWithFormat:@"select key, filename, size, modification_time, last_access_time, extended_data, access_count, soft_expire_time, hard_expire_time from manifest where key in (%@);", [self _dbJoinedKeys:keys]];
     } else {
-        sql = [NSString stringWithFormat:@"select key, filename, size, inline_data, modification_time, last_access_time, extended_data from manifest where key in (%@)", [self _dbJoinedKeys:keys]];
+        sql = [NSString stringWithFormat:@"select key, filename, size, inline_data, modification_time, last_access_time, extended_data, access_count, soft_expire_time, hard_expire_time from manifest where key in (%@)", [self _dbJoinedKeys:keys]];
     }
     
     sqlite3_stmt *stmt = NULL;
@@ -401,6 +494,7 @@ static UIApplication *_YYSharedApplication() {
     
     [self _dbBindJoinedKeys:keys stmt:stmt fromIndex:1];
     NSMutableArray *items = [NSMutableArray new];
+    YYCacheMetricsBegin(start);
     do {
         result = sqlite3_step(stmt);
         if (result == SQLITE_ROW) {
@@ -414,17 +508,44 @@ static UIApplication *_YYSharedApplication() {
             break;
         }
     } while (1);
+    YYCacheMetricsEnd(YYCacheMetricStorageSQLiteRead, start);
     sqlite3_finalize(stmt);
     return items;
 }
 
+- (NSMutableArray *)_dbGetItemsAfterKey:(NSString *)key limit:(int)count {
+    NSString *sql = key ? @"select key, filename, size, inline_data, modification_time, last_access_time, extended_data, access_count, soft_expire_time, hard_expire_time from manifest where key > ?1 order by key asc limit ?2;" : @"select key, filename, size, inline_data, modification_time, last_access_time, extended_data, access_count, soft_expire_time, hard_expire_time from manifest order by key asc limit ?2;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return nil;
+    if (key) sqlite3_bind_text(stmt, 1, key.UTF8String, -1, NULL);
+    sqlite3_bind_int(stmt, 2, count);
+    
+    NSMutableArray *items = [NSMutableArray new];
+    do {
+        int result = sqlite3_step(stmt);
+        if (result == SQLITE_ROW) {
+            YYKVStorageItem *item = [self _dbGetItemFromStmt:stmt excludeInlineData:NO];
+            if (item) [items addObject:item];
+        } else if (result == SQLITE_DONE) {
+            break;
+        } else {
+            if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+            items = nil;
+            break;
+        }
+    } while (1);
+    return items;
+}
+
 - (NSData *)_dbGetValueWithKey:(NSString *)key {
-    NSString *sql = @"select inline_data from manifest where key = ?1;";
+    NSString *sql = @"select inline_data from manifest where key = ?1 and (hard_expire_time = 0 or hard_expire_time > ?2);";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
     if (!stmt) return nil;
     sqlite3_bind_text(stmt, 1, key.UTF8String, -1, NULL);
+    sqlite3_bind_int(stmt, 2, [self _now]);
     
-    int result = sqlite3_step(stmt);
+    int result;
+    YYCacheMetricsMeasure(YYCacheMetricStorageSQLiteRead, result = sqlite3_step(stmt));
     if (result == SQLITE_ROW) {
         const void *inline_data = sqlite3_column_blob(stmt, 0);
         int inline_data_bytes = sqlite3_column_bytes(stmt, 0);
@@ -457,6 +578,27 @@ static UIApplication *_YYSharedApplication() {
     return nil;
 }
 
+/// Same as `_dbGetFilenameWithKey:`, but returns nil for a hard expired item.
+- (NSString *)_dbGetUnexpiredFilenameWithKey:(NSString *)key {
+    NSString *sql = @"select filename from manifest where key = ?1 and (hard_expire_time = 0 or hard_expire_time > ?2);";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return nil;
+    sqlite3_bind_text(stmt, 1, key.UTF8String, -1, NULL);
+    sqlite3_bind_int(stmt, 2, [self _now]);
+    int result = sqlite3_step(stmt);
+    if (result == SQLITE_ROW) {
+        char *filename = (char *)sqlite3_column_text(stmt, 0);
+        if (filename && *filename != 0) {
+            return [NSString stringWithUTF8String:filename];
+        }
+    } else {
+        if (result != SQLITE_DONE) {
+            if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+        }
+    }
+    return nil;
+}
+
 - (NSMutableArray *)_dbGetFilenameWithKeys:(NSArray *)keys {
     if (![self _dbCheck]) return nil;
     NSString *sql = [NSString stringWithFormat:@"select filename from manifest where key in (%@);", [self _dbJoinedKeys:keys]];
@@ -541,6 +683,32 @@ static UIApplication *_YYSharedApplication() {
     return filenames;
 }
 
+- (NSMutableArray *)_dbGetFilenamesWithExpireTimeEarlierThan:(int)time {
+    NSString *sql = @"select filename from manifest where hard_expire_time > 0 and hard_expire_time <= ?1 and filename is not null;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return nil;
+    sqlite3_bind_int(stmt, 1, time);
+    
+    NSMutableArray *filenames = [NSMutableArray new];
+    do {
+        int result = sqlite3_step(stmt);
+        if (result == SQLITE_ROW) {
+            char *filename = (char *)sqlite3_column_text(stmt, 0);
+            if (filename && *filename != 0) {
+                NSString *name = [NSString stringWithUTF8String:filename];
+                if (name) [filenames addObject:name];
+            }
+        } else if (result == SQLITE_DONE) {
+            break;
+        } else {
+            if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+            filenames = nil;
+            break;
+        }
+    } while (1);
+    return filenames;
+}
+
 - (NSMutableArray *)_dbGetItemSizeInfoOrderByTimeAscWithLimit:(int)count {
     NSString *sql = @"select key, filename, size from manifest order by last_access_time asc limit ?1;";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
@@ -573,11 +741,58 @@ static UIApplication *_YYSharedApplication() {
     return items;
 }
 
+- (NSMutableArray *)_dbGetItemSizeInfoOrderByPriorityAscWithLimit:(int)count {
+    NSString *sql = @"select key, filename, size, priority from manifest order by priority asc limit ?1;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return nil;
+    sqlite3_bind_int(stmt, 1, count);
+    
+    NSMutableArray *items = [NSMutableArray new];
+    do {
+        int result = sqlite3_step(stmt);
+        if (result == SQLITE_ROW) {
+            char *key = (char *)sqlite3_column_text(stmt, 0);
+            char *filename = (char *)sqlite3_column_text(stmt, 1);
+            int size = sqlite3_column_int(stmt, 2);
+            double priority = sqlite3_column_double(stmt, 3);
+            NSString *keyStr = key ? [NSString stringWithUTF8String:key] : nil;
+            if (keyStr) {
+                YYKVStorageItem *item = [YYKVStorageItem new];
+                item.key = keyStr;
+                item.filename = filename ? [NSString stringWithUTF8String:filename] : nil;
+                item.size = size;
+                item.priority = priority;
+                [items addObject:item];
+            }
+        } else if (result == SQLITE_DONE) {
+            break;
+        } else {
+            if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+            items = nil;
+            break;
+        }
+    } while (1);
+    return items;
+}
+
+- (double)_dbGetMinPriority {
+    NSString *sql = @"select min(priority) from manifest;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return 0;
+    int result = sqlite3_step(stmt);
+    if (result != SQLITE_ROW) {
+        if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+        return 0;
+    }
+    return sqlite3_column_double(stmt, 0);
+}
+
 - (int)_dbGetItemCountWithKey:(NSString *)key {
-    NSString *sql = @"select count(key) from manifest where key = ?1;";
+    NSString *sql = @"select count(key) from manifest where key = ?1 and (hard_expire_time = 0 or hard_expire_time > ?2);";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
     if (!stmt) return -1;
     sqlite3_bind_text(stmt, 1, key.UTF8String, -1, NULL);
+    sqlite3_bind_int(stmt, 2, [self _now]);
     int result = sqlite3_step(stmt);
     if (result != SQLITE_ROW) {
         if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
@@ -611,18 +826,134 @@ static UIApplication *_YYSharedApplication() {
 }
 
 
+/// The keys with prefix are in range [prefix, end), returns nil if no such end.
+static NSString *_YYKVStorageKeyPrefixEnd(NSString *prefix) {
+    if (prefix.length == 0) return nil;
+    unichar last = [prefix characterAtIndex:prefix.length - 1];
+    if (last == 0xFFFF) return nil;
+    return [[prefix substringToIndex:prefix.length - 1] stringByAppendingFormat:@"%C", (unichar)(last + 1)];
+}
+
+- (BOOL)_dbDeleteItemsWithKeyPrefix:(NSString *)prefix {
+    NSString *end = _YYKVStorageKeyPrefixEnd(prefix);
+    if (!end) return NO;
+    NSString *sql = @"delete from manifest where key >= ?1 and key < ?2;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return NO;
+    sqlite3_bind_text(stmt, 1, prefix.UTF8String, -1, NULL);
+    sqlite3_bind_text(stmt, 2, end.UTF8String, -1, NULL);
+    int result = sqlite3_step(stmt);
+    if (result != SQLITE_DONE) {
+        if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite delete error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+        return NO;
+    }
+    return YES;
+}
+
+- (NSMutableArray *)_dbGetFilenamesWithKeyPrefix:(NSString *)prefix {
+    NSString *end = _YYKVStorageKeyPrefixEnd(prefix);
+    if (!end) return nil;
+    NSString *sql = @"select filename from manifest where key >= ?1 and key < ?2 and filename is not null;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return nil;
+    sqlite3_bind_text(stmt, 1, prefix.UTF8String, -1, NULL);
+    sqlite3_bind_text(stmt, 2, end.UTF8String, -1, NULL);
+    
+    NSMutableArray *filenames = [NSMutableArray new];
+    do {
+        int result = sqlite3_step(stmt);
+        if (result == SQLITE_ROW) {
+            char *filename = (char *)sqlite3_column_text(stmt, 0);
+            if (filename && *filename != 0) {
+                NSString *name = [NSString stringWithUTF8String:filename];
+                if (name) [filenames addObject:name];
+            }
+        } else if (result == SQLITE_DONE) {
+            break;
+        } else {
+            if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+            filenames = nil;
+            break;
+        }
+    } while (1);
+    return filenames;
+}
+
+- (NSMutableArray *)_dbGetItemSizeInfoWithKeyPrefix:(NSString *)prefix orderByPriority:(BOOL)byPriority limit:(int)count {
+    NSString *end = _YYKVStorageKeyPrefixEnd(prefix);
+    if (!end) return nil;
+    NSString *sql = byPriority ?
+    @"select key, filename, size, priority from manifest where key >= ?1 and key < ?2 order by priority asc limit ?3;" :
+    @"select key, filename, size, priority from manifest where key >= ?1 and key < ?2 order by last_access_time asc limit ?3;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return nil;
+    sqlite3_bind_text(stmt, 1, prefix.UTF8String, -1, NULL);
+    sqlite3_bind_text(stmt, 2, end.UTF8String, -1, NULL);
+    sqlite3_bind_int(stmt, 3, count);
+    
+    NSMutableArray *items = [NSMutableArray new];
+    do {
+        int result = sqlite3_step(stmt);
+        if (result == SQLITE_ROW) {
+            char *key = (char *)sqlite3_column_text(stmt, 0);
+            char *filename = (char *)sqlite3_column_text(stmt, 1);
+            int size = sqlite3_column_int(stmt, 2);
+            double priority = sqlite3_column_double(stmt, 3);
+            NSString *keyStr = key ? [NSString stringWithUTF8String:key] : nil;
+            if (keyStr) {
+                YYKVStorageItem *item = [YYKVStorageItem new];
+                item.key = keyStr;
+                item.filename = filename ? [NSString stringWithUTF8String:filename] : nil;
+                item.size = size;
+                item.priority = priority;
+                [items addObject:item];
+            }
+        } else if (result == SQLITE_DONE) {
+            break;
+        } else {
+            if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+            items = nil;
+            break;
+        }
+    } while (1);
+    return items;
+}
+
+/// Returns sum(size) if sum is YES, or count(*).
+- (int)_dbGetItemSizeOrCountWithKeyPrefix:(NSString *)prefix sum:(BOOL)sum {
+    NSString *end = _YYKVStorageKeyPrefixEnd(prefix);
+    if (!end) return -1;
+    NSString *sql = sum ?
+    @"select sum(size) from manifest where key >= ?1 and key < ?2;" :
+    @"select count(*) from manifest where key >= ?1 and key < ?2;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return -1;
+    sqlite3_bind_text(stmt, 1, prefix.UTF8String, -1, NULL);
+    sqlite3_bind_text(stmt, 2, end.UTF8String, -1, NULL);
+    int result = sqlite3_step(stmt);
+    if (result != SQLITE_ROW) {
+        if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+        return -1;
+    }
+    return sqlite3_column_int(stmt, 0);
+}
+
+
 #pragma mark - file  文件存储
 
 // 文件写入
 - (BOOL)_fileWriteWithName:(NSString *)filename data:(NSData *)data {
     NSString *path = [_dataPath stringByAppendingPathComponent:filename];
-    return [data writeToFile:path atomically:NO];
+    BOOL succeed;
+    YYCacheMetricsMeasure(YYCacheMetricStorageFileWrite, succeed = [data writeToFile:path atomically:NO]);
+    return succeed;
 }
 
 // 文件读取
 - (NSData *)_fileReadWithName:(NSString *)filename {
     NSString *path = [_dataPath stringByAppendingPathComponent:filename];
-    NSData *data = [NSData dataWithContentsOfFile:path];
+    NSData *data;
+    YYCacheMetricsMeasure(YYCacheMetricStorageFileRead, data = [NSData dataWithContentsOfFile:path]);
     return data;
 }
 
@@ -632,6 +963,13 @@ static UIApplication *_YYSharedApplication() {
     return [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
 }
 
+// 重命名文件, 替换已存在的文件
+- (BOOL)_fileMoveWithName:(NSString *)filename toName:(NSString *)newFilename {
+    NSString *path = [_dataPath stringByAppendingPathComponent:filename];
+    NSString *newPath = [_dataPath stringByAppendingPathComponent:newFilename];
+    return rename(path.fileSystemRepresentation, newPath.fileSystemRepresentation) == 0;
+}
+
 // 将所有缓存文件移到trash路径
 - (BOOL)_fileMoveAllToTrash {
     CFUUIDRef uuidRef = CFUUIDCreate(NULL);
@@ -663,6 +1001,25 @@ static UIApplication *_YYSharedApplication() {
 
 #pragma mark - private
 
+/// Get the next items to be evicted, in the order of `evictionPolicy`.
+- (NSMutableArray *)_getItemSizeInfoForEvictionWithLimit:(int)count {
+    if (_evictionPolicy == YYKVStorageEvictionPolicyGDSF) {
+        return [self _dbGetItemSizeInfoOrderByPriorityAscWithLimit:count];
+    }
+    return [self _dbGetItemSizeInfoOrderByTimeAscWithLimit:count];
+}
+
+- (NSMutableArray *)_getItemSizeInfoForEvictionWithKeyPrefix:(NSString *)prefix limit:(int)count {
+    return [self _dbGetItemSizeInfoWithKeyPrefix:prefix orderByPriority:_evictionPolicy == YYKVStorageEvictionPolicyGDSF limit:count];
+}
+
+/// Called when an item is evicted, inflate `L` to age the remaining items (GDSF).
+- (void)_didEvictItem:(YYKVStorageItem *)item {
+    if (_evictionPolicy == YYKVStorageEvictionPolicyGDSF && item.priority > _dbInflation) {
+        _dbInflation = item.priority;
+    }
+}
+
 /**
  Delete all files and empty in background.
  Make sure the db is closed.
@@ -731,16 +1088,40 @@ static UIApplication *_YYSharedApplication() {
     return self;
 }
 
+- (BOOL)setPragma:(NSString *)name value:(NSString *)value {
+    static NSCharacterSet *invalidName, *invalidValue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        invalidName = [[NSCharacterSet characterSetWithCharactersInString:@"abcdefghijklmnopqrstuvwxyz_"] invertedSet];
+        invalidValue = [[NSCharacterSet characterSetWithCharactersInString:@"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-"] invertedSet];
+    });
+    if (name.length == 0 || value.length == 0) return NO;
+    if ([name rangeOfCharacterFromSet:invalidName].location != NSNotFound ||
+        [value rangeOfCharacterFromSet:invalidValue].location != NSNotFound) {
+        if (_errorLogsEnabled) NSLog(@"%s line:%d invalid pragma: %@ = %@", __FUNCTION__, __LINE__, name, value);
+        return NO;
+    }
+    if (![self _dbCheck]) return NO;
+    if (![self _dbExecute:[NSString stringWithFormat:@"pragma %@ = %@;", name, value]]) return NO;
+    if (!_dbPragmas) _dbPragmas = [NSMutableDictionary new];
+    _dbPragmas[name] = value;
+    return YES;
+}
+
 - (void)dealloc {
+#if __has_include(<UIKit/UIKit.h>)
     UIBackgroundTaskIdentifier taskID = [_YYSharedApplication() beginBackgroundTaskWithExpirationHandler:^{}];
     [self _dbClose];
     if (taskID != UIBackgroundTaskInvalid) {
         [_YYSharedApplication() endBackgroundTask:taskID];
     }
+#else
+    [self _dbClose];
+#endif
 }
 
 - (BOOL)saveItem:(YYKVStorageItem *)item {
-    return [self saveItemWithKey:item.key value:item.value filename:item.filename extendedData:item.extendedData];
+    return [self saveItemWithKey:item.key value:item.value filename:item.filename extendedData:item.extendedData softExpireTime:item.softExpireTime hardExpireTime:item.hardExpireTime];
 }
 
 - (BOOL)saveItemWithKey:(NSString *)key value:(NSData *)value {
@@ -748,6 +1129,10 @@ static UIApplication *_YYSharedApplication() {
 }
 
 - (BOOL)saveItemWithKey:(NSString *)key value:(NSData *)value filename:(NSString *)filename extendedData:(NSData *)extendedData {
+    return [self saveItemWithKey:key value:value filename:filename extendedData:extendedData softExpireTime:0 hardExpireTime:0];
+}
+
+- (BOOL)saveItemWithKey:(NSString *)key value:(NSData *)value filename:(NSString *)filename extendedData:(NSData *)extendedData softExpireTime:(int)softExpireTime hardExpireTime:(int)hardExpireTime {
     if (key.length == 0 || value.length == 0) return NO;
     if (_type == YYKVStorageTypeFile && filename.length == 0) {
         return NO;
@@ -757,7 +1142,7 @@ static UIApplication *_YYSharedApplication() {
         if (![self _fileWriteWithName:filename data:value]) {
             return NO;
         }
-        if (![self _dbSaveWithKey:key value:value fileName:filename extendedData:extendedData]) {
+        if (![self _dbSaveWithKey:key value:value fileName:filename extendedData:extendedData softExpireTime:softExpireTime hardExpireTime:hardExpireTime]) {
             [self _fileDeleteWithName:filename];
             return NO;
         }
@@ -769,8 +1154,71 @@ static UIApplication *_YYSharedApplication() {
                 [self _fileDeleteWithName:filename];
             }
         }
-        return [self _dbSaveWithKey:key value:value fileName:nil extendedData:extendedData];
+        return [self _dbSaveWithKey:key value:value fileName:nil extendedData:extendedData softExpireTime:softExpireTime hardExpireTime:hardExpireTime];
+    }
+}
+
+- (BOOL)saveItems:(NSArray *)items {
+    if (items.count == 0) return NO;
+    // the last item of a key wins, validate all before writing anything
+    NSMutableArray *uniqueItems = [NSMutableArray new];
+    NSMutableSet *keys = [NSMutableSet new];
+    for (YYKVStorageItem *item in items.reverseObjectEnumerator) {
+        if (item.key.length == 0 || item.value.length == 0) return NO;
+        if (_type == YYKVStorageTypeFile && item.filename.length == 0) return NO;
+        if ([keys containsObject:item.key]) continue;
+        [keys addObject:item.key];
+        [uniqueItems addObject:item];
     }
+    if (![self _dbExecute:@"begin immediate transaction;"]) return NO;
+    
+    // the files are written with temporary names and replace the old ones after commit,
+    // the old files of the items saved inline are deleted after commit
+    BOOL suc = YES;
+    NSMutableArray *stagedNames = [NSMutableArray new];
+    NSMutableArray *stagedFilenames = [NSMutableArray new];
+    NSMutableArray *stagedKeys = [NSMutableArray new];
+    NSMutableArray *obsoleteFilenames = [NSMutableArray new];
+    for (YYKVStorageItem *item in uniqueItems.reverseObjectEnumerator) {
+        if (item.filename.length) {
+            NSString *stagedName = [NSString stringWithFormat:@"%@.saving%lu", item.filename, (unsigned long)stagedNames.count];
+            if (![self _fileWriteWithName:stagedName data:item.value]) {
+                suc = NO;
+                break;
+            }
+            [stagedNames addObject:stagedName];
+            [stagedFilenames addObject:item.filename];
+            [stagedKeys addObject:item.key];
+        } else if (_type != YYKVStorageTypeSQLite) {
+            NSString *filename = [self _dbGetFilenameWithKey:item.key];
+            if (filename) [obsoleteFilenames addObject:filename];
+        }
+        if (![self _dbSaveWithKey:item.key value:item.value fileName:item.filename extendedData:item.extendedData
+                   softExpireTime:item.softExpireTime hardExpireTime:item.hardExpireTime]) {
+            suc = NO;
+            break;
+        }
+    }
+    if (!suc || ![self _dbExecute:@"commit transaction;"]) {
+        [self _dbExecute:@"rollback transaction;"];
+        for (NSString *stagedName in stagedNames) {
+            [self _fileDeleteWithName:stagedName];
+        }
+        return NO;
+    }
+    
+    for (NSString *filename in obsoleteFilenames) {
+        [self _fileDeleteWithName:filename];
+    }
+    for (NSUInteger i = 0; i < stagedNames.count; i++) {
+        if (![self _fileMoveWithName:stagedNames[i] toName:stagedFilenames[i]]) {
+            // rare (such as the disk is gone), do not leave a row without its file
+            [self _fileDeleteWithName:stagedNames[i]];
+            [self _dbDeleteItemWithKey:stagedKeys[i]];
+            suc = NO;
+        }
+    }
+    return suc;
 }
 
 - (BOOL)removeItemForKey:(NSString *)key {
@@ -861,6 +1309,31 @@ static UIApplication *_YYSharedApplication() {
     return NO;
 }
 
+- (BOOL)removeItemsExpiredEarlierThanTime:(int)time {
+    if (time <= 0) return YES;
+    
+    switch (_type) {
+        case YYKVStorageTypeSQLite: {
+            if ([self _dbDeleteItemsWithExpireTimeEarlierThan:time]) {
+                [self _dbCheckpoint];
+                return YES;
+            }
+        } break;
+        case YYKVStorageTypeFile:
+        case YYKVStorageTypeMixed: {
+            NSArray *filenames = [self _dbGetFilenamesWithExpireTimeEarlierThan:time];
+            for (NSString *name in filenames) {
+                [self _fileDeleteWithName:name];
+            }
+            if ([self _dbDeleteItemsWithExpireTimeEarlierThan:time]) {
+                [self _dbCheckpoint];
+                return YES;
+            }
+        } break;
+    }
+    return NO;
+}
+
 - (BOOL)removeItemsToFitSize:(int)maxSize {
     if (maxSize == INT_MAX) return YES;
     if (maxSize <= 0) return [self removeAllItems];
@@ -873,13 +1346,14 @@ static UIApplication *_YYSharedApplication() {
     BOOL suc = NO;
     do {
         int perCount = 16;
-        items = [self _dbGetItemSizeInfoOrderByTimeAscWithLimit:perCount];
+        items = [self _getItemSizeInfoForEvictionWithLimit:perCount];
         for (YYKVStorageItem *item in items) {
             if (total > maxSize) {
                 if (item.filename) {
                     [self _fileDeleteWithName:item.filename];
                 }
                 suc = [self _dbDeleteItemWithKey:item.key];
+                if (suc) [self _didEvictItem:item];
                 total -= item.size;
             } else {
                 break;
@@ -903,13 +1377,103 @@ static UIApplication *_YYSharedApplication() {
     BOOL suc = NO;
     do {
         int perCount = 16;
-        items = [self _dbGetItemSizeInfoOrderByTimeAscWithLimit:perCount];
+        items = [self _getItemSizeInfoForEvictionWithLimit:perCount];
+        for (YYKVStorageItem *item in items) {
+            if (total > maxCount) {
+                if (item.filename) {
+                    [self _fileDeleteWithName:item.filename];
+                }
+                suc = [self _dbDeleteItemWithKey:item.key];
+                if (suc) [self _didEvictItem:item];
+                total--;
+            } else {
+                break;
+            }
+            if (!suc) break;
+        }
+    } while (total > maxCount && items.count > 0 && suc);
+    if (suc) [self _dbCheckpoint];
+    return suc;
+}
+
+- (BOOL)removeItemsWithKeyPrefix:(NSString *)prefix {
+    if (prefix.length == 0) return NO;
+    
+    switch (_type) {
+        case YYKVStorageTypeSQLite: {
+            if ([self _dbDeleteItemsWithKeyPrefix:prefix]) {
+                [self _dbCheckpoint];
+                return YES;
+            }
+        } break;
+        case YYKVStorageTypeFile:
+        case YYKVStorageTypeMixed: {
+            NSArray *filenames = [self _dbGetFilenamesWithKeyPrefix:prefix];
+            for (NSString *name in filenames) {
+                [self _fileDeleteWithName:name];
+            }
+            if ([self _dbDeleteItemsWithKeyPrefix:prefix]) {
+                [self _dbCheckpoint];
+                return YES;
+            }
+        } break;
+    }
+    return NO;
+}
+
+- (BOOL)removeItemsWithKeyPrefix:(NSString *)prefix toFitSize:(int)maxSize {
+    if (prefix.length == 0) return NO;
+    if (maxSize == INT_MAX) return YES;
+    if (maxSize <= 0) return [self removeItemsWithKeyPrefix:prefix];
+    
+    int total = [self _dbGetItemSizeOrCountWithKeyPrefix:prefix sum:YES];
+    if (total < 0) return NO;
+    if (total <= maxSize) return YES;
+    
+    NSArray *items = nil;
+    BOOL suc = NO;
+    do {
+        int perCount = 16;
+        items = [self _getItemSizeInfoForEvictionWithKeyPrefix:prefix limit:perCount];
+        for (YYKVStorageItem *item in items) {
+            if (total > maxSize) {
+                if (item.filename) {
+                    [self _fileDeleteWithName:item.filename];
+                }
+                suc = [self _dbDeleteItemWithKey:item.key];
+                if (suc) [self _didEvictItem:item];
+                total -= item.size;
+            } else {
+                break;
+            }
+            if (!suc) break;
+        }
+    } while (total > maxSize && items.count > 0 && suc);
+    if (suc) [self _dbCheckpoint];
+    return suc;
+}
+
+- (BOOL)removeItemsWithKeyPrefix:(NSString *)prefix toFitCount:(int)maxCount {
+    if (prefix.length == 0) return NO;
+    if (maxCount == INT_MAX) return YES;
+    if (maxCount <= 0) return [self removeItemsWithKeyPrefix:prefix];
+    
+    int total = [self _dbGetItemSizeOrCountWithKeyPrefix:prefix sum:NO];
+    if (total < 0) return NO;
+    if (total <= maxCount) return YES;
+    
+    NSArray *items = nil;
+    BOOL suc = NO;
+    do {
+        int perCount = 16;
+        items = [self _getItemSizeInfoForEvictionWithKeyPrefix:prefix limit:perCount];
         for (YYKVStorageItem *item in items) {
             if (total > maxCount) {
                 if (item.filename) {
                     [self _fileDeleteWithName:item.filename];
                 }
                 suc = [self _dbDeleteItemWithKey:item.key];
+                if (suc) [self _didEvictItem:item];
                 total--;
             } else {
                 break;
@@ -964,6 +1528,13 @@ static UIApplication *_YYSharedApplication() {
 - (YYKVStorageItem *)getItemForKey:(NSString *)key {
     if (key.length == 0) return nil;
     YYKVStorageItem *item = [self _dbGetItemWithKey:key excludeInlineData:NO];
+    if (item && item.hardExpireTime > 0 && item.hardExpireTime <= [self _now]) {
+        if (item.filename) {
+            [self _fileDeleteWithName:item.filename];
+        }
+        [self _dbDeleteItemWithKey:key];
+        item = nil;
+    }
     if (item) {
         [self _dbUpdateAccessTimeWithKey:key];
         if (item.filename) {
@@ -980,6 +1551,7 @@ static UIApplication *_YYSharedApplication() {
 - (YYKVStorageItem *)getItemInfoForKey:(NSString *)key {
     if (key.length == 0) return nil;
     YYKVStorageItem *item = [self _dbGetItemWithKey:key excludeInlineData:YES];
+    if (item && item.hardExpireTime > 0 && item.hardExpireTime <= [self _now]) item = nil;
     return item;
 }
 
@@ -988,7 +1560,7 @@ static UIApplication *_YYSharedApplication() {
     NSData *value = nil;
     switch (_type) {
         case YYKVStorageTypeFile: {
-            NSString *filename = [self _dbGetFilenameWithKey:key];
+            NSString *filename = [self _dbGetUnexpiredFilenameWithKey:key];
             if (filename) {
                 value = [self _fileReadWithName:filename];
                 if (!value) {
@@ -1001,7 +1573,7 @@ static UIApplication *_YYSharedApplication() {
             value = [self _dbGetValueWithKey:key];
         } break;
         case YYKVStorageTypeMixed: {
-            NSString *filename = [self _dbGetFilenameWithKey:key];
+            NSString *filename = [self _dbGetUnexpiredFilenameWithKey:key];
             if (filename) {
                 value = [self _fileReadWithName:filename];
                 if (!value) {
@@ -1022,6 +1594,17 @@ static UIApplication *_YYSharedApplication() {
 - (NSArray *)getItemForKeys:(NSArray *)keys {
     if (keys.count == 0) return nil;
     NSMutableArray *items = [self _dbGetItemWithKeys:keys excludeInlineData:NO];
+    int now = [self _now];
+    for (NSInteger i = 0, max = items.count; i < max; i++) {
+        YYKVStorageItem *item = items[i];
+        if (item.hardExpireTime > 0 && item.hardExpireTime <= now) {
+            if (item.filename) [self _fileDeleteWithName:item.filename];
+            if (item.key) [self _dbDeleteItemWithKey:item.key];
+            [items removeObjectAtIndex:i];
+            i--;
+            max--;
+        }
+    }
     if (_type != YYKVStorageTypeSQLite) {
         for (NSInteger i = 0, max = items.count; i < max; i++) {
             YYKVStorageItem *item = items[i];
@@ -1042,9 +1625,40 @@ static UIApplication *_YYSharedApplication() {
     return items.count ? items : nil;
 }
 
+- (NSArray *)getItemsAfterKey:(NSString *)key limit:(int)limit {
+    if (limit <= 0) return nil;
+    NSMutableArray *items = [NSMutableArray new];
+    int now = [self _now];
+    while (items.count == 0) {
+        NSMutableArray *page = [self _dbGetItemsAfterKey:key limit:limit];
+        if (page.count == 0) break;
+        for (YYKVStorageItem *item in page) {
+            if (item.hardExpireTime > 0 && item.hardExpireTime <= now) continue;
+            if (item.filename && _type != YYKVStorageTypeSQLite) {
+                item.value = [self _fileReadWithName:item.filename];
+                if (!item.value) continue;
+            }
+            [items addObject:item];
+        }
+        if (page.count < limit) break;
+        key = ((YYKVStorageItem *)page.lastObject).key; // the whole page is expired, try next page
+    }
+    return items.count ? items : nil;
+}
+
 - (NSArray *)getItemInfoForKeys:(NSArray *)keys {
     if (keys.count == 0) return nil;
-    return [self _dbGetItemWithKeys:keys excludeInlineData:YES];
+    NSMutableArray *items = [self _dbGetItemWithKeys:keys excludeInlineData:YES];
+    int now = [self _now];
+    for (NSInteger i = 0, max = items.count; i < max; i++) {
+        YYKVStorageItem *item = items[i];
+        if (item.hardExpireTime > 0 && item.hardExpireTime <= now) {
+            [items removeObjectAtIndex:i];
+            i--;
+            max--;
+        }
+    }
+    return items.count ? items : nil;
 }
 
 - (NSDictionary *)getItemValueForKeys:(NSArray *)keys {
@@ -1071,4 +1685,12 @@ static UIApplication *_YYSharedApplication() {
     return [self _dbGetTotalItemSize];
 }
 
+- (int)getItemsCountWithKeyPrefix:(NSString *)prefix {
+    return [self _dbGetItemSizeOrCountWithKeyPrefix:prefix sum:NO];
+}
+
+- (int)getItemsSizeWithKeyPrefix:(NSString *)prefix {
+    return [self _dbGetItemSizeOrCountWithKeyPrefix:prefix sum:YES];
+}
+
 @end
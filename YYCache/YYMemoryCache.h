@@ -11,6 +11,8 @@
 
 #import <Foundation/Foundation.h>
 
+@class YYCacheTraceRecorder, YYCacheLockStats;
+
 NS_ASSUME_NONNULL_BEGIN
 
 /**
@@ -90,8 +92,8 @@ NS_ASSUME_NONNULL_BEGIN
  自动修剪检查时间为秒,默认是5.0
  The auto trim check time interval in seconds. Default is 5.0.
  缓存保存一个内部定时器以检查缓存是否达到其限制,若达到限制,则开始驱逐对象
- @discussion The cache holds an internal timer to check whether the cache reaches 
- its limits, and if the limit is reached, it begins to evict objects.
+ @discussion The cache is checked by the shared `YYCacheTrimScheduler`, with the
+ other caches in one timer. If the limit is reached, it begins to evict objects.
  */
 @property NSTimeInterval autoTrimInterval;
 
@@ -124,6 +126,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nullable, copy) void(^didEnterBackgroundBlock)(YYMemoryCache *cache);
 
+/**
+ A block to be executed when an object is evicted by the `costLimit`, `countLimit`
+ or `ageLimit`, by a trim method, or by a memory warning or entering background.
+ The default value is nil.
+ 
+ @discussion The block is executed in a background queue, out of the cache's lock.
+ It's not executed for the objects removed by `removeObjectForKey:`, `removeAllObjects`
+ or the hard TTL. It can be used to move the evicted objects to a slower cache.
+ */
+@property (nullable, copy) void(^didEvictObjectBlock)(YYMemoryCache *cache, id key, id object, NSUInteger cost);
+
+/**
+ Like `didEvictObjectBlock`, with the remaining soft and hard TTL of the evicted
+ object in seconds (0 means no TTL). The default value is nil.
+ 
+ @discussion A slower cache can use the TTLs to keep the object's expiry. If both
+ blocks are set, both are executed.
+ */
+@property (nullable, copy) void(^didEvictObjectWithTTLBlock)(YYMemoryCache *cache, id key, id object, NSUInteger cost, NSTimeInterval softTTL, NSTimeInterval hardTTL);
+
 /**
  若是YES,键值对将会在主线程中被释放,否则在后台线程进行释放,默认是NO
  If `YES`, the key-value pair will be released on main thread, otherwise on
@@ -142,6 +164,28 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property BOOL releaseAsynchronously;
 
+/**
+ The recorder of the accesses (get, set and remove), to replay the real access
+ pattern and plan the limits. The default value is nil, which costs one check
+ per access. The size of an entry is the cost of the object.
+ See `YYCacheTraceRecorder` for more information.
+ */
+@property (nullable, strong) YYCacheTraceRecorder *traceRecorder;
+
+/**
+ Whether to profile the contention of the cache's lock, see `lockStats`.
+ The default value is NO. Enabling it resets the stats.
+ */
+@property BOOL lockProfilingEnabled;
+
+/**
+ The contention of the cache's lock since the profiling was enabled: acquisitions,
+ contended acquisitions, wait and hold time, in total and for get, set, remove, trim
+ and the other operations. All zero if it's never enabled.
+ See `YYCacheLockStats` for more information.
+ */
+- (YYCacheLockStats *)lockStats;
+
 
 #pragma mark - Access Methods
 ///=============================================================================
@@ -166,6 +210,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable id)objectForKey:(id)key;
 
+/**
+ Returns the value associated with a given key, and whether it's stale.
+ 
+ @discussion An object which is past its soft TTL is still returned (stale), and
+ `needsRefresh` is set to `YES`. An object which is past its hard TTL is removed 
+ and never returned.
+ 
+ @param key          An object identifying the value. If nil, just return nil.
+ @param needsRefresh Output whether the value is past its soft TTL, pass NULL to ignore.
+ @return The value associated with key, or nil if no value is associated with key.
+ */
+- (nullable id)objectForKey:(id)key needsRefresh:(nullable BOOL *)needsRefresh;
+
 /**
  缓存中设置key对应的值
  Sets the value of the specified key in the cache (0 cost).
@@ -189,6 +246,79 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setObject:(nullable id)object forKey:(id)key withCost:(NSUInteger)cost;
 
+/**
+ Sets the value of the specified key in the cache with cost, a soft and a hard TTL.
+ 
+ @param object  The object to store in the cache. If nil, it calls `removeObjectForKey`.
+ @param key     The key with which to associate the value. If nil, this method has no effect.
+ @param cost    The cost with which to associate the key-value pair.
+ @param softTTL The soft time-to-live in seconds, 0 means never stale. After it, the
+     object is still returned by `objectForKey:needsRefresh:` with `needsRefresh` set.
+ @param hardTTL The hard time-to-live in seconds, 0 means never expire. After it, the
+     object is treated as not exists, and it will be evicted later in background thread.
+ */
+- (void)setObject:(nullable id)object forKey:(id)key withCost:(NSUInteger)cost softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL;
+
+/**
+ Sets the value of the specified key in the cache only if the condition returns YES,
+ the check and the set are atomic.
+ 
+ @discussion The condition is evaluated in the cache's lock, so it should be fast
+ and must not access this cache. It can be used to discard a stale value read from
+ a slower cache, by checking a version which is changed before each write.
+ 
+ @param object    The object to store in the cache. If nil, this method has no effect.
+ @param key       The key with which to associate the value. If nil, this method has no effect.
+ @param cost      The cost with which to associate the key-value pair.
+ @param softTTL   The soft time-to-live in seconds, 0 means never stale.
+ @param hardTTL   The hard time-to-live in seconds, 0 means never expire.
+ @param condition A block which receives the current value of the key (nil if not 
+     in cache or past its hard TTL), and returns whether to set. Pass nil to always set.
+ @return Whether the value is set.
+ */
+- (BOOL)setObject:(id)object
+           forKey:(id)key
+         withCost:(NSUInteger)cost
+          softTTL:(NSTimeInterval)softTTL
+          hardTTL:(NSTimeInterval)hardTTL
+        condition:(nullable BOOL(^)(id _Nullable currentObject))condition;
+
+/**
+ Returns the values associated with the given keys, in one locked pass.
+ 
+ @param keys An array of keys.
+ @return A dictionary which key is the key and value is the value, the keys which 
+     are not in cache (or past the hard TTL) are not included.
+ */
+- (NSDictionary *)objectsForKeys:(NSArray *)keys;
+
+/**
+ Sets the values of the specified keys in the cache, in one locked pass.
+ 
+ @param objects  The objects to store in the cache.
+ @param keys     The keys with which to associate the values.
+ @param costs    The costs (NSUInteger) of the objects, pass nil for 0 cost.
+ @param softTTLs The soft time-to-live (NSTimeInterval) of the objects, pass nil for never stale.
+ @param hardTTLs The hard time-to-live (NSTimeInterval) of the objects, pass nil for never expire.
+ @discussion The count of all non-nil arrays should be same, otherwise this method has no effect.
+ */
+- (void)setObjects:(NSArray *)objects
+           forKeys:(NSArray *)keys
+         withCosts:(nullable NSArray<NSNumber *> *)costs
+          softTTLs:(nullable NSArray<NSNumber *> *)softTTLs
+          hardTTLs:(nullable NSArray<NSNumber *> *)hardTTLs;
+
+/**
+ Sets the values of the specified keys in the cache, in one locked pass, only for
+ the keys which the condition returns YES. See `setObject:forKey:withCost:softTTL:hardTTL:condition:`.
+ */
+- (void)setObjects:(NSArray *)objects
+           forKeys:(NSArray *)keys
+         withCosts:(nullable NSArray<NSNumber *> *)costs
+          softTTLs:(nullable NSArray<NSNumber *> *)softTTLs
+          hardTTLs:(nullable NSArray<NSNumber *> *)hardTTLs
+         condition:(nullable BOOL(^)(id key, id _Nullable currentObject))condition;
+
 /**
  Removes the value of the specified key in the cache.
  
@@ -201,6 +331,74 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)removeAllObjects;
 
+/**
+ Removes the values of the keys which pass the test, in one locked pass.
+ Removed objects are not passed to `didEvictObjectBlock`.
+ 
+ @param predicate A block evaluated in the cache's lock for each key, it should be
+     fast and must not access this cache. If nil, this method has no effect.
+ */
+- (void)removeObjectsForKeysPassingTest:(BOOL(^)(id key))predicate;
+
+/**
+ Returns the keys in the cache, ordered from the most recently used to the least
+ recently used.
+ 
+ @param limit The maximum number of keys to return.
+ @return An array of keys, the hot keys first.
+ */
+- (NSArray *)recentlyUsedKeysWithLimit:(NSUInteger)limit;
+
+
+#pragma mark - Snapshot
+///=============================================================================
+/// @name Snapshot
+///=============================================================================
+
+/**
+ Registers a fast codec which is used to write the objects of a class to snapshot.
+ 
+ @discussion A snapshot only contains the objects which have a codec registered 
+ for its class (or superclass), and the keys must be NSString. The codecs for 
+ NSData and NSString are registered by default. Registering a codec with an 
+ existing name or class replaces the old one.
+ 
+ @param name    The unique name of the codec, it's written to the snapshot file.
+ @param cls     The class of the objects.
+ @param encoder A block to encode an object to data. It should be fast.
+ @param decoder A block to decode an object from data. The data may be mapped 
+     from the snapshot file, copy the bytes if you need to hold them.
+ */
++ (void)registerSnapshotCodecWithName:(NSString *)name
+                             forClass:(Class)cls
+                              encoder:(NSData *(^)(id object))encoder
+                              decoder:(id _Nullable (^)(NSData *data))decoder;
+
+/**
+ Writes the keys, costs, TTLs, LRU order and encoded objects to a file.
+ 
+ @discussion The file is written sequentially and atomically. The objects without 
+ a registered codec are skipped. This method blocks the calling thread until the 
+ file write finished, but the cache is locked only while the entries are copied.
+ 
+ @param path The snapshot file path.
+ @return Whether succeed.
+ */
+- (BOOL)writeSnapshotToFile:(NSString *)path;
+
+/**
+ Restores the objects from a snapshot file in one streaming pass.
+ 
+ @discussion The file is mapped into memory, and the objects are inserted with the
+ LRU order of the snapshot, behind the objects already in cache. The keys which are
+ already in cache are not overwritten.
+ If the cache goes over the limit, the objects will be evicted later in background.
+ 
+ @param path The snapshot file path.
+ @return Whether succeed. Returns NO if the file does not exist or is broken.
+ */
+- (BOOL)restoreSnapshotFromFile:(NSString *)path;
+
 
 #pragma mark - Trim
 ///=============================================================================
@@ -10,16 +10,103 @@
 //
 
 #import "YYMemoryCache.h"
+#import "YYCacheTrimScheduler.h"
+#import "YYCacheTraceRecorder.h"
+#import "YYCacheMetricsPrivate.h"
+#import "YYCacheLockProfilePrivate.h"
+#import "YYCacheMediaTime.h"
+#if __has_include(<UIKit/UIKit.h>)
 #import <UIKit/UIKit.h>
+#endif
 #import <CoreFoundation/CoreFoundation.h>
-#import <QuartzCore/QuartzCore.h>
 #import <pthread.h>
 
+#ifndef __APPLE__
+#define pthread_main_np() ([NSThread isMainThread])
+#endif
+
+#define Lock(_op_) YYCacheLockProfileMutexLock(&self->_lock, &self->_lockProfile, YYCacheLockOperation##_op_)
+#define TryLock(_op_) YYCacheLockProfileMutexTryLock(&self->_lock, &self->_lockProfile, YYCacheLockOperation##_op_)
+#define Unlock() YYCacheLockProfileMutexUnlock(&self->_lock, &self->_lockProfile)
+
 
 static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     return dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0);
 }
 
+/*
+ Snapshot file (native byte order):
+ 
+ header:  "YYMS" | uint32 version | uint32 codec count | uint64 entry count
+ codecs:  uint16 name length | name (utf8)                    ...repeated
+ entries: uint32 key length | key (utf8) | uint64 cost | 
+          double soft ttl | double hard ttl |
+          uint16 codec index | uint32 value length | value    ...repeated
+ 
+ Entries are written from LRU to MRU. They are restored at tail from the MRU end,
+ so the entries used after launch stay more recently used than the snapshot.
+ */
+static const char kSnapshotMagic[4] = {'Y', 'Y', 'M', 'S'};
+static const uint32_t kSnapshotVersion = 1;
+
+/**
+ A value codec used by snapshot.
+ Typically, you should not use this class directly.
+ */
+@interface _YYMemoryCacheSnapshotCodec : NSObject {
+    @package
+    NSString *_name;
+    Class _cls;
+    NSData *(^_encoder)(id object);
+    id (^_decoder)(NSData *data);
+}
+@end
+
+@implementation _YYMemoryCacheSnapshotCodec
+@end
+
+static NSMutableArray *_snapshotCodecs; // ordered by register time
+static dispatch_semaphore_t _snapshotCodecsLock;
+
+static void _YYMemoryCacheSnapshotCodecsInit() {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _snapshotCodecsLock = dispatch_semaphore_create(1);
+        _snapshotCodecs = [NSMutableArray new];
+    });
+}
+
+/// Returns the codec for the class or its nearest registered superclass.
+static _YYMemoryCacheSnapshotCodec *_YYMemoryCacheSnapshotCodecForClass(Class cls) {
+    _YYMemoryCacheSnapshotCodecsInit();
+    _YYMemoryCacheSnapshotCodec *found = nil;
+    dispatch_semaphore_wait(_snapshotCodecsLock, DISPATCH_TIME_FOREVER);
+    for (Class c = cls; c && !found; c = [c superclass]) {
+        for (_YYMemoryCacheSnapshotCodec *codec in _snapshotCodecs) {
+            if (codec->_cls == c) {
+                found = codec;
+                break;
+            }
+        }
+    }
+    dispatch_semaphore_signal(_snapshotCodecsLock);
+    return found;
+}
+
+static _YYMemoryCacheSnapshotCodec *_YYMemoryCacheSnapshotCodecForName(NSString *name) {
+    _YYMemoryCacheSnapshotCodecsInit();
+    _YYMemoryCacheSnapshotCodec *found = nil;
+    dispatch_semaphore_wait(_snapshotCodecsLock, DISPATCH_TIME_FOREVER);
+    for (_YYMemoryCacheSnapshotCodec *codec in _snapshotCodecs) {
+        if ([codec->_name isEqualToString:name]) {
+            found = codec;
+            break;
+        }
+    }
+    dispatch_semaphore_signal(_snapshotCodecsLock);
+    return found;
+}
+
 /**
  A node in linked map.
  Typically, you should not use this class directly.
@@ -31,7 +118,10 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     id _key;
     id _value;
     NSUInteger _cost;
-    NSTimeInterval _time;
+    NSTimeInterval _time;       // media time, for LRU and age
+    NSTimeInterval _softExpire; // wall clock time (keeps running in sleep), 0 means never stale
+    NSTimeInterval _hardExpire; // wall clock time (keeps running in sleep), 0 means never expire
+    NSUInteger _expiringIndex;  // index in the expiring heap, valid if _hardExpire > 0
 }
 @end
 
@@ -39,6 +129,13 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
 @end
 
 
+/// Returns the value of a node in lock, nil if the node is past its hard TTL.
+static inline id _YYLinkedMapNodeCurrentValue(_YYLinkedMapNode *node, NSTimeInterval wallTime) {
+    if (!node) return nil;
+    if (node->_hardExpire > 0 && node->_hardExpire <= wallTime) return nil;
+    return node->_value;
+}
+
 /**
  A linked map used by YYMemoryCache.
  It's not thread-safe and does not validate the parameters.
@@ -50,6 +147,9 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     CFMutableDictionaryRef _dic; // do not set object directly
     NSUInteger _totalCost;
     NSUInteger _totalCount;
+    _YYLinkedMapNode * __unsafe_unretained *_expiring; // min-heap of the nodes with hard expire time
+    NSUInteger _expiringCount;
+    NSUInteger _expiringCapacity;
     _YYLinkedMapNode *_head; // MRU, do not change it directly
     _YYLinkedMapNode *_tail; // LRU, do not change it directly
     BOOL _releaseOnMainThread;
@@ -60,6 +160,10 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
 /// Node and node.key should not be nil.
 - (void)insertNodeAtHead:(_YYLinkedMapNode *)node;
 
+/// Insert a node at tail and update the total cost.
+/// Node and node.key should not be nil.
+- (void)insertNodeAtTail:(_YYLinkedMapNode *)node;
+
 /// Bring a inner node to header.
 /// Node should already inside the dic.
 - (void)bringNodeToHead:(_YYLinkedMapNode *)node;
@@ -74,8 +178,68 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
 /// Remove all node in background queue.
 - (void)removeAll;
 
+/// Remove all node and return them from LRU to MRU, the caller releases them.
+- (NSArray *)removeAllNodes;
+
+/// Change the hard expire time of a inner node.
+- (void)setHardExpire:(NSTimeInterval)hardExpire ofNode:(_YYLinkedMapNode *)node;
+
+/// The node which expires first, nil if no node has a hard expire time.
+- (_YYLinkedMapNode *)firstExpiringNode;
+
 @end
 
+
+static inline void _YYLinkedMapHeapSet(_YYLinkedMap *map, NSUInteger index, _YYLinkedMapNode *node) {
+    map->_expiring[index] = node;
+    node->_expiringIndex = index;
+}
+
+static void _YYLinkedMapHeapSiftUp(_YYLinkedMap *map, NSUInteger index) {
+    _YYLinkedMapNode *node = map->_expiring[index];
+    while (index > 0) {
+        NSUInteger parent = (index - 1) / 2;
+        if (map->_expiring[parent]->_hardExpire <= node->_hardExpire) break;
+        _YYLinkedMapHeapSet(map, index, map->_expiring[parent]);
+        index = parent;
+    }
+    _YYLinkedMapHeapSet(map, index, node);
+}
+
+static void _YYLinkedMapHeapSiftDown(_YYLinkedMap *map, NSUInteger index) {
+    _YYLinkedMapNode *node = map->_expiring[index];
+    NSUInteger count = map->_expiringCount;
+    while (YES) {
+        NSUInteger child = index * 2 + 1;
+        if (child >= count) break;
+        if (child + 1 < count && map->_expiring[child + 1]->_hardExpire < map->_expiring[child]->_hardExpire) child++;
+        if (node->_hardExpire <= map->_expiring[child]->_hardExpire) break;
+        _YYLinkedMapHeapSet(map, index, map->_expiring[child]);
+        index = child;
+    }
+    _YYLinkedMapHeapSet(map, index, node);
+}
+
+static void _YYLinkedMapHeapPush(_YYLinkedMap *map, _YYLinkedMapNode *node) {
+    if (map->_expiringCount == map->_expiringCapacity) {
+        map->_expiringCapacity = MAX(map->_expiringCapacity * 2, 16);
+        map->_expiring = (_YYLinkedMapNode * __unsafe_unretained *)realloc(map->_expiring, map->_expiringCapacity * sizeof(void *));
+    }
+    _YYLinkedMapHeapSet(map, map->_expiringCount, node);
+    map->_expiringCount++;
+    _YYLinkedMapHeapSiftUp(map, map->_expiringCount - 1);
+}
+
+static void _YYLinkedMapHeapRemove(_YYLinkedMap *map, _YYLinkedMapNode *node) {
+    NSUInteger index = node->_expiringIndex;
+    map->_expiringCount--;
+    if (index == map->_expiringCount) return;
+    _YYLinkedMapNode *last = map->_expiring[map->_expiringCount];
+    _YYLinkedMapHeapSet(map, index, last);
+    _YYLinkedMapHeapSiftUp(map, index);
+    _YYLinkedMapHeapSiftDown(map, last->_expiringIndex);
+}
+
 @implementation _YYLinkedMap
 
 - (instancetype)init {
@@ -88,12 +252,14 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
 
 - (void)dealloc {
     CFRelease(_dic);
+    free(_expiring);
 }
 
 - (void)insertNodeAtHead:(_YYLinkedMapNode *)node {
     CFDictionarySetValue(_dic, (__bridge const void *)(node->_key), (__bridge const void *)(node));
     _totalCost += node->_cost;
     _totalCount++;
+    if (node->_hardExpire > 0) _YYLinkedMapHeapPush(self, node);
     if (_head) {
         node->_next = _head;
         _head->_prev = node;
@@ -103,6 +269,20 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     }
 }
 
+- (void)insertNodeAtTail:(_YYLinkedMapNode *)node {
+    CFDictionarySetValue(_dic, (__bridge const void *)(node->_key), (__bridge const void *)(node));
+    _totalCost += node->_cost;
+    _totalCount++;
+    if (node->_hardExpire > 0) _YYLinkedMapHeapPush(self, node);
+    if (_tail) {
+        node->_prev = _tail;
+        _tail->_next = node;
+        _tail = node;
+    } else {
+        _head = _tail = node;
+    }
+}
+
 // 保证最近使用的node放在链表的最前面
 - (void)bringNodeToHead:(_YYLinkedMapNode *)node {
     if (_head == node) return;
@@ -124,6 +304,7 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     CFDictionaryRemoveValue(_dic, (__bridge const void *)(node->_key));
     _totalCost -= node->_cost;
     _totalCount--;
+    if (node->_hardExpire > 0) _YYLinkedMapHeapRemove(self, node);
     if (node->_next) node->_next->_prev = node->_prev;
     if (node->_prev) node->_prev->_next = node->_next;
     if (_head == node) _head = node->_next;
@@ -136,6 +317,7 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     CFDictionaryRemoveValue(_dic, (__bridge const void *)(_tail->_key));
     _totalCost -= _tail->_cost;
     _totalCount--;
+    if (_tail->_hardExpire > 0) _YYLinkedMapHeapRemove(self, _tail);
     if (_head == _tail) {//头==尾
         _head = _tail = nil;
     } else {//尾部指向前一个
@@ -148,6 +330,10 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
 - (void)removeAll {
     _totalCost = 0;
     _totalCount = 0;
+    _expiringCount = 0;
+    _expiringCapacity = 0;
+    free(_expiring);
+    _expiring = NULL;
     _head = nil;
     _tail = nil;
     if (CFDictionaryGetCount(_dic) > 0) {
@@ -169,133 +355,223 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     }
 }
 
+- (NSArray *)removeAllNodes {
+    NSMutableArray *nodes = [NSMutableArray arrayWithCapacity:_totalCount];
+    for (_YYLinkedMapNode *node = _tail; node; node = node->_prev) {
+        [nodes addObject:node];
+    }
+    for (_YYLinkedMapNode *node in nodes) {
+        node->_prev = nil;
+        node->_next = nil;
+    }
+    CFDictionaryRemoveAllValues(_dic); // the nodes are still held by the array
+    _totalCost = 0;
+    _totalCount = 0;
+    _expiringCount = 0;
+    _expiringCapacity = 0;
+    free(_expiring);
+    _expiring = NULL;
+    _head = nil;
+    _tail = nil;
+    return nodes;
+}
+
+- (void)setHardExpire:(NSTimeInterval)hardExpire ofNode:(_YYLinkedMapNode *)node {
+    NSTimeInterval old = node->_hardExpire;
+    node->_hardExpire = hardExpire;
+    if (old > 0 && hardExpire > 0) {
+        _YYLinkedMapHeapSiftUp(self, node->_expiringIndex);
+        _YYLinkedMapHeapSiftDown(self, node->_expiringIndex);
+    } else if (old > 0) {
+        _YYLinkedMapHeapRemove(self, node);
+    } else if (hardExpire > 0) {
+        _YYLinkedMapHeapPush(self, node);
+    }
+}
+
+- (_YYLinkedMapNode *)firstExpiringNode {
+    return _expiringCount ? _expiring[0] : nil;
+}
+
 @end
 
 
 
+@interface YYMemoryCache () <YYCacheTrimming>
+@end
+
 @implementation YYMemoryCache {
     pthread_mutex_t _lock;
+    YYCacheLockProfile _lockProfile;
     _YYLinkedMap *_lru;
     dispatch_queue_t _queue;
-}
-// 递归修剪(每5s修剪一次)
-- (void)_trimRecursively {
-    __weak typeof(self) _self = self;
-    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_autoTrimInterval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
-        __strong typeof(_self) self = _self;
-        if (!self) return;
-        [self _trimInBackground];
-        [self _trimRecursively];
-    });
+    NSTimeInterval _autoTrimInterval;
 }
 
 // 后台修剪
 - (void)_trimInBackground {
     //    _queue:串行队列
     dispatch_async(_queue, ^{
-        [self _trimToCost:self->_costLimit];
-        [self _trimToCount:self->_countLimit];
-        [self _trimToAge:self->_ageLimit];
+        [self trimToLimits];
+    });
+}
+
+// 由共享的修剪调度器定时调用(每5s)
+- (void)trimToLimits {
+    [self _trimToCost:_costLimit];
+    [self _trimToCount:_countLimit];
+    [self _trimToAge:_ageLimit];
+    [self _trimExpired];
+}
+
+- (double)trimPressure {
+    Lock(Other);
+    double costPressure = (double)_lru->_totalCost / MAX(_costLimit, 1);
+    double countPressure = (double)_lru->_totalCount / MAX(_countLimit, 1);
+    Unlock();
+    return MAX(costPressure, countPressure);
+}
+
+// 通知被淘汰的Node,并在后台释放
+/// Notify the nodes evicted by limits and release them in queue, called out of lock.
+- (void)_didEvictNodes:(NSArray *)nodes {
+    void (^block)(YYMemoryCache *cache, id key, id object, NSUInteger cost) = self.didEvictObjectBlock;
+    void (^ttlBlock)(YYMemoryCache *cache, id key, id object, NSUInteger cost, NSTimeInterval softTTL, NSTimeInterval hardTTL) = self.didEvictObjectWithTTLBlock;
+    NSTimeInterval now = ttlBlock ? CFAbsoluteTimeGetCurrent() : 0;
+    for (_YYLinkedMapNode *node in nodes) {
+        if (block) block(self, node->_key, node->_value, node->_cost);
+        if (ttlBlock) {
+            if (node->_hardExpire > 0 && node->_hardExpire <= now) continue; // expired, nothing to keep
+            NSTimeInterval softTTL = node->_softExpire > 0 ? MAX(node->_softExpire - now, 0.001) : 0;
+            NSTimeInterval hardTTL = node->_hardExpire > 0 ? node->_hardExpire - now : 0;
+            ttlBlock(self, node->_key, node->_value, node->_cost, softTTL, hardTTL);
+        }
+    }
+    dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
+    dispatch_async(queue, ^{//容器类对象若含有大量对象时,销毁的时候会消耗大量的性能,因此为了性能考虑,将大容量的容器类对象放到后台线程中释放.
+        [nodes count]; // release in queue
     });
 }
 
+/// Remove all objects as evicted, so the evict blocks can keep them in a slower cache.
+- (void)_evictAllObjects {
+    NSArray *nodes = nil;
+    Lock(Trim);
+    if (_didEvictObjectBlock || _didEvictObjectWithTTLBlock) {
+        nodes = [_lru removeAllNodes];
+    } else {
+        [_lru removeAll];
+    }
+    Unlock();
+    if (nodes.count) [self _didEvictNodes:nodes];
+}
+
 // 消耗修剪
 - (void)_trimToCost:(NSUInteger)costLimit {
-    BOOL finish = NO;
-    pthread_mutex_lock(&_lock);
     if (costLimit == 0) {
-        [_lru removeAll];
-        finish = YES;
-    } else if (_lru->_totalCost <= costLimit) {
+        [self _evictAllObjects];
+        return;
+    }
+    BOOL finish = NO;
+    Lock(Trim);
+    if (_lru->_totalCost <= costLimit) {
         finish = YES;
     }
-    pthread_mutex_unlock(&_lock);
+    Unlock();
     if (finish) return;
     
     NSMutableArray *holder = [NSMutableArray new];
     while (!finish) {
-        if (pthread_mutex_trylock(&_lock) == 0) {//判断未加锁,再加锁
+        if (TryLock(Trim) == 0) {//判断未加锁,再加锁
             if (_lru->_totalCost > costLimit) {//大于最大消耗限制
                 _YYLinkedMapNode *node = [_lru removeTailNode];
                 if (node) [holder addObject:node];//访问外部局部变量,捕获
             } else {
                 finish = YES;
             }
-            pthread_mutex_unlock(&_lock);
+            Unlock();
         } else {
             usleep(10 * 1000); //10 ms 进程挂起10ms
         }
     }
-    if (holder.count) { // 存在要移除的Node;
-        dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
-        dispatch_async(queue, ^{//容器类对象若含有大量对象时,销毁的时候会消耗大量的性能,因此为了性能考虑,将大容量的容器类对象放到后台线程中释放.
-            [holder count]; // release in queue
-        });
-    }
+    if (holder.count) [self _didEvictNodes:holder]; // 存在要移除的Node;
 }
 // 数量修剪
 - (void)_trimToCount:(NSUInteger)countLimit {
-    BOOL finish = NO;
-    pthread_mutex_lock(&_lock);
     if (countLimit == 0) {
-        [_lru removeAll];
-        finish = YES;
-    } else if (_lru->_totalCount <= countLimit) {
+        [self _evictAllObjects];
+        return;
+    }
+    BOOL finish = NO;
+    Lock(Trim);
+    if (_lru->_totalCount <= countLimit) {
         finish = YES;
     }
-    pthread_mutex_unlock(&_lock);
+    Unlock();
     if (finish) return;
     
     NSMutableArray *holder = [NSMutableArray new];
     while (!finish) {
-        if (pthread_mutex_trylock(&_lock) == 0) {
+        if (TryLock(Trim) == 0) {
             if (_lru->_totalCount > countLimit) {
                 _YYLinkedMapNode *node = [_lru removeTailNode];
                 if (node) [holder addObject:node];
             } else {
                 finish = YES;
             }
-            pthread_mutex_unlock(&_lock);
+            Unlock();
         } else {
             usleep(10 * 1000); //10 ms
         }
     }
-    if (holder.count) {
-        dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
-        dispatch_async(queue, ^{
-            [holder count]; // release in queue
-        });
-    }
+    if (holder.count) [self _didEvictNodes:holder];
 }
 
 //时间期限修剪
 - (void)_trimToAge:(NSTimeInterval)ageLimit {
+    if (ageLimit <= 0) {
+        [self _evictAllObjects];
+        return;
+    }
     BOOL finish = NO;
     NSTimeInterval now = CACurrentMediaTime();
-    pthread_mutex_lock(&_lock);
-    if (ageLimit <= 0) {
-        [_lru removeAll];
-        finish = YES;
-    } else if (!_lru->_tail || (now - _lru->_tail->_time) <= ageLimit) {
+    Lock(Trim);
+    if (!_lru->_tail || (now - _lru->_tail->_time) <= ageLimit) {
         finish = YES;
     }
-    pthread_mutex_unlock(&_lock);
+    Unlock();
     if (finish) return;
     
     NSMutableArray *holder = [NSMutableArray new];
     while (!finish) {
-        if (pthread_mutex_trylock(&_lock) == 0) {
+        if (TryLock(Trim) == 0) {
             if (_lru->_tail && (now - _lru->_tail->_time) > ageLimit) {
                 _YYLinkedMapNode *node = [_lru removeTailNode];
                 if (node) [holder addObject:node];
             } else {
                 finish = YES;
             }
-            pthread_mutex_unlock(&_lock);
+            Unlock();
         } else {
             usleep(10 * 1000); //10 ms
         }
     }
+    if (holder.count) [self _didEvictNodes:holder];
+}
+
+// 移除硬过期的对象, 只访问过期的节点
+- (void)_trimExpired {
+    NSTimeInterval now = CFAbsoluteTimeGetCurrent();
+    NSMutableArray *holder = nil;
+    Lock(Trim);
+    _YYLinkedMapNode *node = [_lru firstExpiringNode];
+    while (node && node->_hardExpire <= now) {
+        if (!holder) holder = [NSMutableArray new];
+        [_lru removeNode:node];
+        [holder addObject:node];
+        node = [_lru firstExpiringNode];
+    }
+    Unlock();
     if (holder.count) {
         dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
         dispatch_async(queue, ^{
@@ -309,7 +585,7 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
         self.didReceiveMemoryWarningBlock(self);
     }
     if (self.shouldRemoveAllObjectsOnMemoryWarning) {
-        [self removeAllObjects];
+        [self _evictAllObjects];
     }
 }
 
@@ -318,12 +594,26 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
         self.didEnterBackgroundBlock(self);
     }
     if (self.shouldRemoveAllObjectsWhenEnteringBackground) {
-        [self removeAllObjects];
+        [self _evictAllObjects];
     }
 }
 
 #pragma mark - public
 
++ (void)initialize {
+    if (self != [YYMemoryCache class]) return;
+    [self registerSnapshotCodecWithName:@"NSData" forClass:[NSData class] encoder:^NSData *(id object) {
+        return object;
+    } decoder:^id(NSData *data) {
+        return [NSData dataWithBytes:data.bytes length:data.length]; // do not hold the mapped file
+    }];
+    [self registerSnapshotCodecWithName:@"NSString" forClass:[NSString class] encoder:^NSData *(id object) {
+        return [(NSString *)object dataUsingEncoding:NSUTF8StringEncoding];
+    } decoder:^id(NSData *data) {
+        return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    }];
+}
+
 - (instancetype)init {
     self = super.init;
     pthread_mutex_init(&_lock, NULL);
@@ -338,87 +628,157 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     _autoTrimInterval = 5.0;
     _shouldRemoveAllObjectsOnMemoryWarning = YES;
     _shouldRemoveAllObjectsWhenEnteringBackground = YES;
+#if __has_include(<UIKit/UIKit.h>)
     //注册收到内存警告通知
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_appDidReceiveMemoryWarningNotification) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
     //注册进入后台的通知
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_appDidEnterBackgroundNotification) name:UIApplicationDidEnterBackgroundNotification object:nil];
+#endif
     
-    [self _trimRecursively];
+    [[YYCacheTrimScheduler sharedScheduler] registerCache:self];
     return self;
 }
 
 - (void)dealloc {
+#if __has_include(<UIKit/UIKit.h>)
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidEnterBackgroundNotification object:nil];
+#endif
     [_lru removeAll];
     pthread_mutex_destroy(&_lock);
 }
 // 总数量
 - (NSUInteger)totalCount {
-    pthread_mutex_lock(&_lock);
+    Lock(Other);
     NSUInteger count = _lru->_totalCount;
-    pthread_mutex_unlock(&_lock);
+    Unlock();
     return count;
 }
 
 // 总消耗
 - (NSUInteger)totalCost {
-    pthread_mutex_lock(&_lock);
+    Lock(Other);
     NSUInteger totalCost = _lru->_totalCost;
-    pthread_mutex_unlock(&_lock);
+    Unlock();
     return totalCost;
 }
 
 - (BOOL)releaseOnMainThread {
-    pthread_mutex_lock(&_lock);
+    Lock(Other);
     BOOL releaseOnMainThread = _lru->_releaseOnMainThread;
-    pthread_mutex_unlock(&_lock);
+    Unlock();
     return releaseOnMainThread;
 }
 
 // 主线程释放
 - (void)setReleaseOnMainThread:(BOOL)releaseOnMainThread {
-    pthread_mutex_lock(&_lock);
+    Lock(Other);
     _lru->_releaseOnMainThread = releaseOnMainThread;
-    pthread_mutex_unlock(&_lock);
+    Unlock();
 }
 
 // 异步释放
 - (BOOL)releaseAsynchronously {
-    pthread_mutex_lock(&_lock);
+    Lock(Other);
     BOOL releaseAsynchronously = _lru->_releaseAsynchronously;
-    pthread_mutex_unlock(&_lock);
+    Unlock();
     return releaseAsynchronously;
 }
 
 // 异步释放
 - (void)setReleaseAsynchronously:(BOOL)releaseAsynchronously {
-    pthread_mutex_lock(&_lock);
+    Lock(Other);
     _lru->_releaseAsynchronously = releaseAsynchronously;
+    Unlock();
+}
+
+- (NSTimeInterval)autoTrimInterval {
+    Lock(Other);
+    NSTimeInterval autoTrimInterval = _autoTrimInterval;
+    Unlock();
+    return autoTrimInterval;
+}
+
+- (void)setAutoTrimInterval:(NSTimeInterval)autoTrimInterval {
+    Lock(Other);
+    _autoTrimInterval = autoTrimInterval;
+    Unlock();
+    [[YYCacheTrimScheduler sharedScheduler] rescheduleCache:self];
+}
+
+- (BOOL)lockProfilingEnabled {
+    return YYCacheLockProfileIsEnabled(&_lockProfile);
+}
+
+// 不计入统计,直接加锁
+- (void)setLockProfilingEnabled:(BOOL)lockProfilingEnabled {
+    pthread_mutex_lock(&_lock);
+    YYCacheLockProfileSetEnabled(&_lockProfile, lockProfilingEnabled);
+    pthread_mutex_unlock(&_lock);
+}
+
+- (YYCacheLockStats *)lockStats {
+    pthread_mutex_lock(&_lock);
+    YYCacheLockStats *stats = [[YYCacheLockStats alloc] initWithProfile:&_lockProfile];
     pthread_mutex_unlock(&_lock);
+    return stats;
 }
 
 // 判断内存中是否包含该key
 - (BOOL)containsObjectForKey:(id)key {
     if (!key) return NO;
-    pthread_mutex_lock(&_lock);
-    BOOL contains = CFDictionaryContainsKey(_lru->_dic, (__bridge const void *)(key));
-    pthread_mutex_unlock(&_lock);
+    Lock(Get);
+    _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(key));
+    BOOL contains = node && (node->_hardExpire <= 0 || node->_hardExpire > CFAbsoluteTimeGetCurrent());
+    Unlock();
     return contains;
 }
 
 - (id)objectForKey:(id)key {
+    return [self objectForKey:key needsRefresh:NULL];
+}
+
+- (id)objectForKey:(id)key needsRefresh:(BOOL *)needsRefresh {
     if (!key) return nil;
-    pthread_mutex_lock(&_lock);
+    YYCacheMetricsBegin(start);
+    BOOL stale = NO;
+    NSUInteger cost = 0;
+    YYCacheMetricsMeasure(YYCacheMetricMemoryLockWait, Lock(Get));
     // 存储的值都包装成_YYLinkedMapNode
     _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(key));
     if (node) {
-        //更新存储对象的时间
-        node->_time = CACurrentMediaTime();
-        
-        [_lru bringNodeToHead:node];
+        NSTimeInterval now = CACurrentMediaTime();
+        NSTimeInterval wallTime = CFAbsoluteTimeGetCurrent();
+        if (node->_hardExpire > 0 && node->_hardExpire <= wallTime) {
+            // 硬过期,按不存在处理
+            [_lru removeNode:node];
+            if (_lru->_releaseAsynchronously) {
+                dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
+                dispatch_async(queue, ^{
+                    [node class]; //hold and release in queue
+                });
+            } else if (_lru->_releaseOnMainThread && !pthread_main_np()) {
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [node class]; //hold and release in queue
+                });
+            }
+            node = nil;
+        } else {
+            //更新存储对象的时间
+            node->_time = now;
+            stale = node->_softExpire > 0 && node->_softExpire <= wallTime;
+            cost = node->_cost;
+            [_lru bringNodeToHead:node];
+        }
     }
-    pthread_mutex_unlock(&_lock);
+    Unlock();
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        [recorder recordOperation:YYCacheTraceOperationGet tier:YYCacheTraceTierMemory key:key size:cost
+                           result:node ? YYCacheTraceResultHit : YYCacheTraceResultMiss];
+    }
+    if (needsRefresh) *needsRefresh = stale;
+    YYCacheMetricsEnd(YYCacheMetricMemoryGet, start);
     return node ? node->_value : nil;
 }
 
@@ -428,54 +788,199 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
 }
 
 - (void)setObject:(id)object forKey:(id)key withCost:(NSUInteger)cost {
+    [self setObject:object forKey:key withCost:cost softTTL:0 hardTTL:0];
+}
+
+- (void)setObject:(id)object forKey:(id)key withCost:(NSUInteger)cost softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL {
     if (!key) return;
     if (!object) {//清除value
         [self removeObjectForKey:key];
         return;
     }
-    pthread_mutex_lock(&_lock);
+    [self _setObject:object forKey:key withCost:cost softTTL:softTTL hardTTL:hardTTL condition:nil];
+}
+
+- (BOOL)setObject:(id)object forKey:(id)key withCost:(NSUInteger)cost softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL condition:(BOOL (^)(id currentObject))condition {
+    if (!key || !object) return NO;
+    return [self _setObject:object forKey:key withCost:cost softTTL:softTTL hardTTL:hardTTL condition:condition];
+}
+
+- (BOOL)_setObject:(id)object forKey:(id)key withCost:(NSUInteger)cost softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL condition:(BOOL (^)(id currentObject))condition {
+    YYCacheMetricsBegin(start);
+    YYCacheMetricsMeasure(YYCacheMetricMemoryLockWait, Lock(Set));
+    NSTimeInterval now = CACurrentMediaTime();
+    NSTimeInterval wallTime = CFAbsoluteTimeGetCurrent();
+    if (condition) {
+        _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(key));
+        if (!condition(_YYLinkedMapNodeCurrentValue(node, wallTime))) {
+            Unlock();
+            return NO;
+        }
+    }
+    [self _setObject:object forKey:key withCost:cost softTTL:softTTL hardTTL:hardTTL now:now wallTime:wallTime];
+    if (_lru->_totalCost > _costLimit) {
+        dispatch_async(_queue, ^{
+            [self trimToCost:_costLimit];
+        });
+    }
+    _YYLinkedMapNode *evicted = nil;
+    if (_lru->_totalCount > _countLimit) {
+        _YYLinkedMapNode *node = [_lru removeTailNode];
+        if (_didEvictObjectBlock || _didEvictObjectWithTTLBlock) {
+            evicted = node; // notify out of lock
+        } else if (_lru->_releaseAsynchronously) {
+            dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
+            dispatch_async(queue, ^{
+                [node class]; //hold and release in queue
+            });
+        } else if (_lru->_releaseOnMainThread && !pthread_main_np()) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [node class]; //hold and release in queue
+            });
+        }
+    }
+    Unlock();
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        [recorder recordOperation:YYCacheTraceOperationSet tier:YYCacheTraceTierMemory key:key size:cost result:YYCacheTraceResultNone];
+    }
+    if (evicted) {
+        dispatch_async(_queue, ^{
+            [self _didEvictNodes:@[evicted]];
+        });
+    }
+    YYCacheMetricsEnd(YYCacheMetricMemorySet, start);
+    return YES;
+}
+
+/// Insert or update a node, should be called in lock.
+/// `now` is the media time for LRU, `wallTime` is the wall clock time for TTL.
+- (void)_setObject:(id)object forKey:(id)key withCost:(NSUInteger)cost softTTL:(NSTimeInterval)softTTL hardTTL:(NSTimeInterval)hardTTL now:(NSTimeInterval)now wallTime:(NSTimeInterval)wallTime {
     // 获取
     _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(key));
-    NSTimeInterval now = CACurrentMediaTime();
+    NSTimeInterval softExpire = softTTL > 0 ? wallTime + softTTL : 0;
+    NSTimeInterval hardExpire = hardTTL > 0 ? wallTime + hardTTL : 0;
     if (node) {
         _lru->_totalCost -= node->_cost;
         _lru->_totalCost += cost;
         node->_cost = cost;
         node->_time = now;
+        node->_softExpire = softExpire;
+        [_lru setHardExpire:hardExpire ofNode:node];
         node->_value = object;
         [_lru bringNodeToHead:node];
     } else {
         node = [_YYLinkedMapNode new];
         node->_cost = cost;
         node->_time = now;
+        node->_softExpire = softExpire;
+        node->_hardExpire = hardExpire;
         node->_key = key;
         node->_value = object;
         [_lru insertNodeAtHead:node];
     }
+}
+
+- (NSDictionary *)objectsForKeys:(NSArray *)keys {
+    NSMutableDictionary *objects = [NSMutableDictionary new];
+    if (keys.count == 0) return objects;
+    NSMutableArray *holder = nil;
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    NSUInteger *costs = recorder ? calloc(keys.count, sizeof(NSUInteger)) : NULL; // recorded out of lock
+    YYCacheMetricsMeasure(YYCacheMetricMemoryLockWait, Lock(Get));
+    NSTimeInterval now = CACurrentMediaTime();
+    NSTimeInterval wallTime = CFAbsoluteTimeGetCurrent();
+    NSUInteger index = 0;
+    for (id key in keys) {
+        NSUInteger i = index++;
+        _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(key));
+        if (!node) continue;
+        if (node->_hardExpire > 0 && node->_hardExpire <= wallTime) {
+            [_lru removeNode:node];
+            if (!holder) holder = [NSMutableArray new];
+            [holder addObject:node];
+            continue;
+        }
+        node->_time = now;
+        [_lru bringNodeToHead:node];
+        objects[key] = node->_value;
+        if (costs) costs[i] = node->_cost;
+    }
+    Unlock();
+    if (recorder) {
+        index = 0;
+        for (id key in keys) {
+            NSUInteger i = index++;
+            BOOL hit = objects[key] != nil;
+            [recorder recordOperation:YYCacheTraceOperationGet tier:YYCacheTraceTierMemory key:key size:(hit && costs) ? costs[i] : 0
+                               result:hit ? YYCacheTraceResultHit : YYCacheTraceResultMiss];
+        }
+    }
+    if (costs) free(costs);
+    if (holder.count) {
+        dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
+        dispatch_async(queue, ^{
+            [holder count]; // release in queue
+        });
+    }
+    return objects;
+}
+
+- (void)setObjects:(NSArray *)objects forKeys:(NSArray *)keys withCosts:(NSArray<NSNumber *> *)costs softTTLs:(NSArray<NSNumber *> *)softTTLs hardTTLs:(NSArray<NSNumber *> *)hardTTLs {
+    [self setObjects:objects forKeys:keys withCosts:costs softTTLs:softTTLs hardTTLs:hardTTLs condition:nil];
+}
+
+- (void)setObjects:(NSArray *)objects forKeys:(NSArray *)keys withCosts:(NSArray<NSNumber *> *)costs softTTLs:(NSArray<NSNumber *> *)softTTLs hardTTLs:(NSArray<NSNumber *> *)hardTTLs condition:(BOOL (^)(id key, id currentObject))condition {
+    NSUInteger count = objects.count;
+    if (count == 0 || keys.count != count) return;
+    if ((costs && costs.count != count) || (softTTLs && softTTLs.count != count) || (hardTTLs && hardTTLs.count != count)) return;
+    
+    NSMutableArray *holder = nil;
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    NSMutableIndexSet *setIndexes = recorder ? [NSMutableIndexSet new] : nil; // recorded out of lock
+    YYCacheMetricsMeasure(YYCacheMetricMemoryLockWait, Lock(Set));
+    NSTimeInterval now = CACurrentMediaTime();
+    NSTimeInterval wallTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < count; i++) {
+        if (condition) {
+            _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(keys[i]));
+            if (!condition(keys[i], _YYLinkedMapNodeCurrentValue(node, wallTime))) continue;
+        }
+        NSUInteger cost = costs ? costs[i].unsignedIntegerValue : 0;
+        [self _setObject:objects[i] forKey:keys[i]
+                withCost:cost
+                 softTTL:softTTLs ? softTTLs[i].doubleValue : 0
+                 hardTTL:hardTTLs ? hardTTLs[i].doubleValue : 0
+                     now:now
+                wallTime:wallTime];
+        [setIndexes addIndex:i];
+    }
     if (_lru->_totalCost > _costLimit) {
         dispatch_async(_queue, ^{
             [self trimToCost:_costLimit];
         });
     }
-    if (_lru->_totalCount > _countLimit) {
+    while (_lru->_totalCount > _countLimit) {
         _YYLinkedMapNode *node = [_lru removeTailNode];
-        if (_lru->_releaseAsynchronously) {
-            dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
-            dispatch_async(queue, ^{
-                [node class]; //hold and release in queue
-            });
-        } else if (_lru->_releaseOnMainThread && !pthread_main_np()) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [node class]; //hold and release in queue
-            });
-        }
+        if (!node) break;
+        if (!holder) holder = [NSMutableArray new];
+        [holder addObject:node];
+    }
+    Unlock();
+    [setIndexes enumerateIndexesUsingBlock:^(NSUInteger i, BOOL *stop) {
+        NSUInteger cost = costs ? costs[i].unsignedIntegerValue : 0;
+        [recorder recordOperation:YYCacheTraceOperationSet tier:YYCacheTraceTierMemory key:keys[i] size:cost result:YYCacheTraceResultNone];
+    }];
+    if (holder.count) {
+        dispatch_async(_queue, ^{
+            [self _didEvictNodes:holder];
+        });
     }
-    pthread_mutex_unlock(&_lock);
 }
 
 - (void)removeObjectForKey:(id)key {
     if (!key) return;
-    pthread_mutex_lock(&_lock);
+    Lock(Remove);
     _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(key));
     if (node) {
         [_lru removeNode:node];
@@ -490,20 +995,258 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
             });
         }
     }
-    pthread_mutex_unlock(&_lock);
+    Unlock();
+    YYCacheTraceRecorder *recorder = self.traceRecorder;
+    if (recorder) {
+        [recorder recordOperation:YYCacheTraceOperationRemove tier:YYCacheTraceTierMemory key:key size:0 result:YYCacheTraceResultNone];
+    }
 }
 
 - (void)removeAllObjects {
-    pthread_mutex_lock(&_lock);
+    Lock(Remove);
     [_lru removeAll];
-    pthread_mutex_unlock(&_lock);
+    Unlock();
 }
 
-- (void)trimToCount:(NSUInteger)count {
-    if (count == 0) {
-        [self removeAllObjects];
-        return;
+- (void)removeObjectsForKeysPassingTest:(BOOL (^)(id key))predicate {
+    if (!predicate) return;
+    NSMutableArray *holder = [NSMutableArray new];
+    Lock(Remove);
+    _YYLinkedMapNode *node = _lru->_head;
+    while (node) {
+        _YYLinkedMapNode *next = node->_next;
+        if (predicate(node->_key)) {
+            [holder addObject:node];
+            [_lru removeNode:node];
+        }
+        node = next;
+    }
+    Unlock();
+    if (holder.count) {
+        dispatch_queue_t queue = _lru->_releaseOnMainThread ? dispatch_get_main_queue() : YYMemoryCacheGetReleaseQueue();
+        dispatch_async(queue, ^{
+            [holder count]; // release in queue
+        });
+    }
+}
+
+- (NSArray *)recentlyUsedKeysWithLimit:(NSUInteger)limit {
+    NSMutableArray *keys = [NSMutableArray new];
+    Lock(Other);
+    _YYLinkedMapNode *node = _lru->_head;
+    while (node && keys.count < limit) {
+        [keys addObject:node->_key];
+        node = node->_next;
     }
+    Unlock();
+    return keys;
+}
+
++ (void)registerSnapshotCodecWithName:(NSString *)name
+                             forClass:(Class)cls
+                              encoder:(NSData *(^)(id object))encoder
+                              decoder:(id (^)(NSData *data))decoder {
+    if (name.length == 0 || name.length > UINT16_MAX || !cls || !encoder || !decoder) return;
+    _YYMemoryCacheSnapshotCodec *codec = [_YYMemoryCacheSnapshotCodec new];
+    codec->_name = name.copy;
+    codec->_cls = cls;
+    codec->_encoder = [encoder copy];
+    codec->_decoder = [decoder copy];
+    
+    _YYMemoryCacheSnapshotCodecsInit();
+    dispatch_semaphore_wait(_snapshotCodecsLock, DISPATCH_TIME_FOREVER);
+    for (NSUInteger i = 0; i < _snapshotCodecs.count; i++) {
+        _YYMemoryCacheSnapshotCodec *old = _snapshotCodecs[i];
+        if ([old->_name isEqualToString:name] || old->_cls == cls) {
+            [_snapshotCodecs removeObjectAtIndex:i];
+            i--;
+        }
+    }
+    [_snapshotCodecs addObject:codec];
+    dispatch_semaphore_signal(_snapshotCodecsLock);
+}
+
+- (BOOL)writeSnapshotToFile:(NSString *)path {
+    if (path.length == 0) return NO;
+    
+    // copy the nodes in lock, encode them out of lock
+    NSMutableArray *nodes = [NSMutableArray new];
+    NSTimeInterval now = CFAbsoluteTimeGetCurrent();
+    Lock(Other);
+    _YYLinkedMapNode *node = _lru->_tail;
+    while (node) {
+        if (node->_hardExpire <= 0 || node->_hardExpire > now) {
+            _YYLinkedMapNode *copy = [_YYLinkedMapNode new];
+            copy->_key = node->_key;
+            copy->_value = node->_value;
+            copy->_cost = node->_cost;
+            copy->_softExpire = node->_softExpire;
+            copy->_hardExpire = node->_hardExpire;
+            [nodes addObject:copy];
+        }
+        node = node->_prev;
+    }
+    Unlock();
+    
+    // find the codecs first, so the codec table can be written before the entries
+    NSMutableArray *codecs = [NSMutableArray new];
+    NSMutableArray *nodeCodecs = [NSMutableArray new];
+    NSMutableArray *validNodes = [NSMutableArray new];
+    for (_YYLinkedMapNode *node in nodes) {
+        if (![node->_key isKindOfClass:[NSString class]]) continue;
+        _YYMemoryCacheSnapshotCodec *codec = _YYMemoryCacheSnapshotCodecForClass([node->_value class]);
+        if (!codec) continue;
+        if ([codecs indexOfObjectIdenticalTo:codec] == NSNotFound) {
+            if (codecs.count >= UINT16_MAX) continue;
+            [codecs addObject:codec];
+        }
+        [validNodes addObject:node];
+        [nodeCodecs addObject:codec];
+    }
+    nodes = nil;
+    
+    NSString *tmpPath = [path stringByAppendingString:@".tmp"];
+    FILE *file = fopen(tmpPath.fileSystemRepresentation, "wb");
+    if (!file) return NO;
+    
+    uint32_t version = kSnapshotVersion;
+    uint32_t codecCount = (uint32_t)codecs.count;
+    uint64_t entryCount = 0; // rewrite at the end
+    BOOL suc = fwrite(kSnapshotMagic, 1, 4, file) == 4 &&
+               fwrite(&version, sizeof(version), 1, file) == 1 &&
+               fwrite(&codecCount, sizeof(codecCount), 1, file) == 1 &&
+               fwrite(&entryCount, sizeof(entryCount), 1, file) == 1;
+    for (_YYMemoryCacheSnapshotCodec *codec in codecs) {
+        if (!suc) break;
+        NSData *name = [codec->_name dataUsingEncoding:NSUTF8StringEncoding];
+        uint16_t nameLength = (uint16_t)name.length;
+        suc = fwrite(&nameLength, sizeof(nameLength), 1, file) == 1 &&
+              fwrite(name.bytes, 1, nameLength, file) == nameLength;
+    }
+    
+    for (NSUInteger i = 0, max = validNodes.count; i < max && suc; i++) {
+        @autoreleasepool {
+            _YYLinkedMapNode *node = validNodes[i];
+            _YYMemoryCacheSnapshotCodec *codec = nodeCodecs[i];
+            NSData *key = [(NSString *)node->_key dataUsingEncoding:NSUTF8StringEncoding];
+            NSData *value = codec->_encoder(node->_value);
+            if (!key || !value || key.length > UINT32_MAX || value.length > UINT32_MAX) continue;
+            
+            uint32_t keyLength = (uint32_t)key.length;
+            uint64_t cost = node->_cost;
+            double softTTL = node->_softExpire > 0 ? MAX(node->_softExpire - now, 0.001) : 0;
+            double hardTTL = node->_hardExpire > 0 ? MAX(node->_hardExpire - now, 0.001) : 0;
+            uint16_t codecIndex = (uint16_t)[codecs indexOfObjectIdenticalTo:codec];
+            uint32_t valueLength = (uint32_t)value.length;
+            suc = fwrite(&keyLength, sizeof(keyLength), 1, file) == 1 &&
+                  fwrite(key.bytes, 1, keyLength, file) == keyLength &&
+                  fwrite(&cost, sizeof(cost), 1, file) == 1 &&
+                  fwrite(&softTTL, sizeof(softTTL), 1, file) == 1 &&
+                  fwrite(&hardTTL, sizeof(hardTTL), 1, file) == 1 &&
+                  fwrite(&codecIndex, sizeof(codecIndex), 1, file) == 1 &&
+                  fwrite(&valueLength, sizeof(valueLength), 1, file) == 1 &&
+                  fwrite(value.bytes, 1, valueLength, file) == valueLength;
+            if (suc) entryCount++;
+        }
+    }
+    if (suc) {
+        suc = fseek(file, 4 + sizeof(version) + sizeof(codecCount), SEEK_SET) == 0 &&
+              fwrite(&entryCount, sizeof(entryCount), 1, file) == 1;
+    }
+    if (fclose(file) != 0) suc = NO;
+    if (suc) {
+        suc = rename(tmpPath.fileSystemRepresentation, path.fileSystemRepresentation) == 0;
+    }
+    if (!suc) [[NSFileManager defaultManager] removeItemAtPath:tmpPath error:NULL];
+    return suc;
+}
+
+- (BOOL)restoreSnapshotFromFile:(NSString *)path {
+    if (path.length == 0) return NO;
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:NULL];
+    if (!data) return NO;
+    const uint8_t *bytes = data.bytes;
+    const uint8_t *end = bytes + data.length;
+    const uint8_t *p = bytes;
+    
+#define YYSnapshotRead(_dst_) \
+    if ((size_t)(end - p) < sizeof(_dst_)) return NO; \
+    memcpy(&(_dst_), p, sizeof(_dst_)); \
+    p += sizeof(_dst_);
+    
+    char magic[4];
+    uint32_t version, codecCount;
+    uint64_t entryCount;
+    YYSnapshotRead(magic);
+    YYSnapshotRead(version);
+    YYSnapshotRead(codecCount);
+    YYSnapshotRead(entryCount);
+    if (memcmp(magic, kSnapshotMagic, 4) != 0 || version != kSnapshotVersion) return NO;
+    
+    NSMutableArray *codecs = [NSMutableArray new]; // NSNull if not registered
+    for (uint32_t i = 0; i < codecCount; i++) {
+        uint16_t nameLength;
+        YYSnapshotRead(nameLength);
+        if ((size_t)(end - p) < nameLength) return NO;
+        NSString *name = [[NSString alloc] initWithBytes:p length:nameLength encoding:NSUTF8StringEncoding];
+        p += nameLength;
+        _YYMemoryCacheSnapshotCodec *codec = name ? _YYMemoryCacheSnapshotCodecForName(name) : nil;
+        [codecs addObject:codec ? codec : (id)[NSNull null]];
+    }
+    
+    // decode out of lock
+    NSMutableArray *nodes = [NSMutableArray new];
+    NSTimeInterval now = CACurrentMediaTime();
+    NSTimeInterval wallTime = CFAbsoluteTimeGetCurrent();
+    for (uint64_t i = 0; i < entryCount; i++) {
+        @autoreleasepool {
+            uint32_t keyLength, valueLength;
+            uint64_t cost;
+            double softTTL, hardTTL;
+            uint16_t codecIndex;
+            YYSnapshotRead(keyLength);
+            if ((size_t)(end - p) < keyLength) return NO;
+            NSString *key = [[NSString alloc] initWithBytes:p length:keyLength encoding:NSUTF8StringEncoding];
+            p += keyLength;
+            YYSnapshotRead(cost);
+            YYSnapshotRead(softTTL);
+            YYSnapshotRead(hardTTL);
+            YYSnapshotRead(codecIndex);
+            YYSnapshotRead(valueLength);
+            if ((size_t)(end - p) < valueLength || codecIndex >= codecs.count) return NO;
+            NSData *valueData = [data subdataWithRange:NSMakeRange(p - bytes, valueLength)];
+            p += valueLength;
+            
+            _YYMemoryCacheSnapshotCodec *codec = codecs[codecIndex];
+            if (!key || (id)codec == [NSNull null]) continue;
+            id value = codec->_decoder(valueData);
+            if (!value) continue;
+            _YYLinkedMapNode *node = [_YYLinkedMapNode new];
+            node->_key = key;
+            node->_value = value;
+            node->_cost = (NSUInteger)cost;
+            node->_time = now;
+            node->_softExpire = softTTL > 0 ? wallTime + softTTL : 0;
+            node->_hardExpire = hardTTL > 0 ? wallTime + hardTTL : 0;
+            [nodes addObject:node];
+        }
+    }
+#undef YYSnapshotRead
+    
+    // insert in one pass, the objects already in cache are newer than the snapshot,
+    // and below them in LRU order, so they are not evicted first
+    Lock(Other);
+    for (_YYLinkedMapNode *node in nodes.reverseObjectEnumerator) {
+        if (CFDictionaryContainsKey(_lru->_dic, (__bridge const void *)(node->_key))) continue;
+        [_lru insertNodeAtTail:node];
+    }
+    BOOL needTrim = _lru->_totalCost > _costLimit || _lru->_totalCount > _countLimit;
+    Unlock();
+    if (needTrim) [self _trimInBackground];
+    return YES;
+}
+
+- (void)trimToCount:(NSUInteger)count {
     [self _trimToCount:count];
 }
 